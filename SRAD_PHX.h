@@ -15,6 +15,42 @@
 #include <SerialTransfer.h>
 #include <Quaternion.h>
 
+#include "SRAD_PHX_Schema.h"
+#include "SRAD_PHX_Format.h"
+#include "SRAD_PHX_Log.h"
+#include "SRAD_PHX_Telemetry.h"
+#include "SRAD_PHX_Logger.h"
+#include "SRAD_PHX_Profile.h"
+#include "SRAD_PHX_Scheduler.h"
+#include "SRAD_PHX_Estimator.h"
+#include "SRAD_PHX_Apogee.h"
+#include "SRAD_PHX_Fifo.h"
+#include "SRAD_PHX_Bno.h"
+#include "SRAD_PHX_Isr.h"
+#include "SRAD_PHX_Pretrigger.h"
+#include "SRAD_PHX_RatePolicy.h"
+#include "SRAD_PHX_Calibration.h"
+#include "SRAD_PHX_Health.h"
+#include "SRAD_PHX_Link.h"
+#include "SRAD_PHX_Attitude.h"
+#include "SRAD_PHX_Clock.h"
+
+#ifndef PHX_GPS_MAX_BYTES
+#define PHX_GPS_MAX_BYTES 64                // UART bytes consumed per read_GPS call
+#endif
+#ifndef PHX_GPS_FIX_TIMEOUT_MS
+#define PHX_GPS_FIX_TIMEOUT_MS 2000         // fix older than this sets sensorStatus bit 4
+#endif
+
+// Snapshot of the last GPS sentence that carried a fix, published by read_GPS
+struct GpsFix {
+    float latitudeDegrees, longitudeDegrees;
+    float speed, angle, altitude;
+    uint8_t satellites;
+    bool fix;                                       // false once the snapshot is older than PHX_GPS_FIX_TIMEOUT_MS
+    uint32_t time_ms;                               // millis() when the snapshot was taken
+};
+
 struct FlightData {
     // data collected by sensors
     Vector3 lsm_gyro, lsm_acc;                      // Gyroscope/Accelerometer  (LSM6DS032 Chip)
@@ -23,23 +59,32 @@ struct FlightData {
     Quaternion bno_orientation;                     // Orientation (also BNO055)
     float lsm_temp, adxl_temp, bno_temp;            // Temperature (all chips that record)
     float bmp_temp, bmp_press, bmp_alt;             // Barometer Pressure/Altitude (BMP388 Chip)
+    float est_alt, est_vel, est_acc;                // Fused altitude AGL, vertical velocity/acceleration
+    uint8_t acc_source;                             // ACC_SOURCE feeding the estimator
+    Quaternion att_orientation;                     // body to world, gyro-propagated (SRAD_PHX_Attitude.h)
+    float att_tilt;                                 // degrees between the rocket axis and up
+    float att_acc_up;                               // vertical acceleration from acc_source, gravity removed
+    GpsFix gps;                                     // Position (Ultimate GPS)
 
     std::bitset<5> sensorStatus;
+    SensorHealth health[SENSOR_COUNT];              // per SENSOR_ID, published after every read
+    uint64_t sample_us[SENSOR_COUNT];               // per SENSOR_ID, when the published values were sampled
+    uint64_t time_us;                               // loop tick, 64-bit microseconds (SRAD_PHX_Clock.h)
     uint64_t totalTime_ms;
+    uint8_t state;                                  // STATES value, published by calculateState
+};
+
+// Every IMU sample from the latest FIFO drains, oldest first. FlightData
+// keeps only the newest of them; these let the estimator and the log see
+// the rest. Filled by the FIFO overloads of read_LSM and read_ADXL, or
+// by read_IMU from the data-ready queue.
+struct FlightSamples {
+    SampleBatch lsm, adxl;
 };
 
-// struct __attribute__((packed)) TransmitFlightData {
-//     // data collected by sensors
-//     Vector3 lsm_gyro, lsm_acc;                      // Gyroscope/Accelerometer  (LSM6DS032 Chip)
-//     Vector3 adxl_acc;                               // Acceleromter (AXDL375 Chip)
-//     Vector3 bno_gyro, bno_acc, bno_mag;             // Gyro/Accel/Magnetic Flux (BNO055 Chip)
-//     Quaternion bno_orientation;                     // Orientation (also BNO055)
-//     float lsm_temp, adxl_temp, bno_temp;            // Temperature (all chips that record)
-//     float bmp_temp, bmp_press, bmp_alt;             // Barometer Pressure/Altitude (BMP388 Chip)
-  
-//     std::bitset<5> sensorStatus;
-//     uint64_t totalTime_ms;
-// };
+// conversion between FlightData and the schema record (SRAD_PHX_Schema.h)
+void packFlightRecord(const FlightData &, FlightRecord &);
+void unpackFlightRecord(const FlightRecord &, FlightData &);
 
 enum STATES {
     PRE_NO_CAL = 0,
@@ -52,33 +97,77 @@ enum STATES {
 class FLIGHT {
     public:
         // initial constructor
+        // g is no longer stored, GPS data is published to o.gps by read_GPS
+        // h, if not "", is printed as a `#` line above the schema's column names
         FLIGHT(int a1, int a2, int l1, int l2, String h, Adafruit_GPS& g, FlightData& o) 
         : accel_liftoff_threshold(a1), accel_liftoff_time_threshold(a2), 
-        land_time_threshold(l1), land_altitude_threshold(l2), data_header(h), last_gps(g), output(o) {
+        land_time_threshold(l1), land_altitude_threshold(l2), output(o), data_header(h) {
+            (void)g;
+            output.gps.fix = false;
             STATE = STATES::PRE_NO_CAL;
-            runningTime_ms = 0;
-
-            // initialize arrays!
-            altReadings_ind = 0;
-            for(int i = 0; i < 10; i++) {
-                altReadings[i] = 0;
+            runningTime_ms = runningTime_us = 0;
+            deltaTime_us = 0;
+            alt_offset = 0;
+            baro_msl = 0;
+            baro_seq = baro_seq_used = 0;
+            g_lsm = g_adxl = PHX_GRAVITY;
+            acc_axial = 0;
+            est_last_us = 0;
+            bno_seq = bno_seq_used = 0;
+            lsm_att_seq = 0;
+            att_last_us = 0;
+            bno_trust_ms = bno_anchor_ms = 0;
+            bno_mount.w = 1;
+            bno_mount.x = bno_mount.y = bno_mount.z = 0;
+            batches = FlightSamples();
+            lsm_est_seq = adxl_est_seq = 0;
+            lsm_log_seq = adxl_log_seq = 0;
+            drdy_lsm_errors = drdy_adxl_errors = 0;
+            memset(bno_fetch, BNO_FETCH_ALL, sizeof(bno_fetch));
+            bno_reads = 0;
+            liftoff_since_us = land_since_us = UINT64_MAX;
+            loop_ticks = pretrigger_tick = 0;
+            pretrigger_heartbeat_ms = 0;
+            pretrigger_on = false;
+            for(int i = 0; i < 5; i++) {
+                rate_policy[i] = RatePolicy{ 1, 1, 0, REDUCE_LAST };
             }
+            csv_rate = bin_rate = rate_policy[0];
+            state_entered_ms = 0;
+            cal.setIdentity();
+            cal_start_ms = UINT64_MAX;
+            cal_active = false;
+            memset(sensor_init, 0, sizeof(sensor_init));
+            memset(csv_health, HEALTH_OK, sizeof(csv_health));
+            memset(bin_health, HEALTH_OK, sizeof(bin_health));
+            link_rx = LinkRxStats();
+            link_rx_since_ack = 0;
+            link_ack_flags = 0;
         }
         // constructor to automatically cast integer outputs from helpfer functions
         // FLIGHT(int stateVal) :  STATE(static_cast<STATES>(stateVal)) {}
 
         // high level functions
         void calculateState();
+        void updateEstimate();
+        void updateAttitude();
         uint8_t read_LSM(Adafruit_LSM6DSO32 &);
+        uint8_t read_LSM(LSM6DSO32Fifo &);  // batched, see SRAD_PHX_Fifo.h
         uint8_t read_BMP(Adafruit_BMP3XX &);
         uint8_t read_ADXL(Adafruit_ADXL375 &);
+        uint8_t read_ADXL(ADXL375Fifo &);
+        uint8_t read_IMU(DrdyAcquisition &); // LSM and ADXL from the ISR queue, see SRAD_PHX_Isr.h
         uint8_t read_BNO(Adafruit_BNO055 &);
+        uint8_t read_BNO(BNO055Burst &);    // one transaction, see setBnoFetch
         uint8_t read_GPS(Adafruit_GPS &);
         void incrementTime();
-        void writeSD(bool, File &);
+        void writeSD(bool, Print &);         // File or SectorLogger
+        void writeSDBinary(bool, Print &);
+        void writeSamplesBinary(Print &);   // FIFO samples not yet logged
         void writeSERIAL(bool, Stream &);  // Strema allows Teensy USB as well
         void writeDataToTeensy(Stream &);
         void readDataFromTeensy(Stream &);
+        bool nextLinkRecord();              // logging board: next queued record into `output`
         void writeDEBUG(bool, Stream &);
 
 
@@ -90,11 +179,50 @@ class FLIGHT {
         bool calibrate();
 
         void initTransferSerial(Stream &);
-        // FlightData decodeTransmission(TransmitFlightData);
-        // TransmitFlightData prepareToTransmit(FlightData);
+        void attachLogger(SectorLogger &);
+        void setBnoFetch(STATES, uint8_t);
+        bool enablePretrigger(FlightRecord *rows, uint16_t n, uint32_t heartbeat_ms = PHX_PRETRIGGER_HEARTBEAT_MS);
+        template <uint16_t N>
+        bool enablePretrigger(FlightRecord (&rows)[N], uint32_t heartbeat_ms = PHX_PRETRIGGER_HEARTBEAT_MS) {
+            return enablePretrigger(rows, N, heartbeat_ms);
+        }
+        void setRatePolicy(STATES, const RatePolicy &);
+        void useDefaultRatePolicy();
+        void setApogeeThresholds(float arm_vel, float descent_vel, uint8_t confirm) {
+            apogee.setThresholds(arm_vel, descent_vel, confirm);
+        }
+        RatePolicy currentRate() const;
+        const CalTable& calibration() const { return cal; }
+        bool calibrationApplied() const { return cal_active; }
+        void setSensorInit(SENSOR_ID, bool (*init)());
+        const HealthMonitor& sensorHealth() const { return health; }
         bool AltitudeCalibrate();
+        STATES getState() const { return STATE; }
+        const FlightSamples& samples() const { return batches; }
+        const PretriggerCursor& pretriggerCsv() const { return pre_csv; }
+        const PretriggerCursor& pretriggerBinary() const { return pre_bin; }
+        const TelemetryEncoder& telemetryTx() const { return tlm_tx; }
+        const TelemetryDecoder& telemetryRx() const { return tlm_rx; }
+        const LinkTxStats& linkTx() const { return link_tx.stat; }
+        const LinkRxStats& linkRx() const { return link_rx; }
 
     private:
+        void writeHeader(Print &);
+        void capturePretrigger(const FlightRecord &);
+        void drainPretrigger(PretriggerCursor &, Print &, bool binary);
+        bool writeRow(Print &, const FlightRecord &, bool binary, size_t reserve);
+        void announceRate(RatePolicy &, const RatePolicy &, Print &, bool binary);
+        void calibrateVector(uint8_t channel, Vector3 &);
+        void calibrateBatch(SampleBatch &, uint8_t acc_channel, int gyro_channel);
+        class HealthScope;
+        bool healthDue(SENSOR_ID);
+        void healthRecord(SENSOR_ID, bool ok, uint32_t latency_us);
+        void announceHealth(uint8_t announced[SENSOR_COUNT], Print &, bool binary);
+        uint8_t accHealth() const;
+        void noteStateChange();
+        uint64_t nowMicros() { return clock.extend(micros()); }
+        void sendLinkAck(uint8_t flags);
+
         int accel_liftoff_threshold;        // METERS PER SECOND^2
         int accel_liftoff_time_threshold;   // MILLISECONDS
         int land_time_threshold;            // MILLISECONDS
@@ -102,23 +230,75 @@ class FLIGHT {
 
         FlightData& output;
         String data_header;
-        Adafruit_GPS& last_gps;             // used for data collection, for some reason the GPS stores it
-        uint16_t deltaTime_ms;
-        uint64_t runningTime_ms;
+        MicrosClock clock;                  // micros() widened to 64 bits, see nowMicros
+        uint32_t deltaTime_us;              // between the last two incrementTime calls
+        uint64_t runningTime_us;
+        uint64_t runningTime_ms;            // runningTime_us / 1000
 
         // data processing variables
         float alt_offset;                   // DO NOT MODIFY
-        float prev_alt, v_vel, offset_alt_fixed_temp;
+        AltitudeEstimator estimator;        // works in MSL, published AGL
+        float baro_msl;                     // latest BMP altitude before any offset
+        uint32_t baro_seq, baro_seq_used;   // new baro sample when these differ
+        float g_lsm, g_adxl;                // axial reading of each accel at rest on the pad
+        float acc_axial;                    // specific force along the rocket axis from acc_source
+        AttitudePropagator attitude;        // see updateAttitude
+        Quaternion bno_mount;               // BNO055 frame to body, from the CAL_BNO_ACC alignment
+        uint32_t bno_seq, bno_seq_used;     // new BNO sample when these differ
+        uint32_t lsm_att_seq;               // next FIFO sample for the attitude
+        uint32_t att_last_us;
+        uint64_t bno_trust_ms;              // BNO fusion not trusted before this, after high g
+        uint64_t bno_anchor_ms;             // last re-anchor to the BNO
+        uint32_t est_last_us;
+        FlightSamples batches;
+        uint32_t lsm_est_seq, adxl_est_seq; // next FIFO sample for the estimator
+        uint32_t lsm_log_seq, adxl_log_seq; // next FIFO sample for writeSamplesBinary
+        uint32_t drdy_lsm_errors, drdy_adxl_errors;     // ISR read failures already reported
+        uint64_t liftoff_since_us, land_since_us;      // start of the current over-threshold/still run, UINT64_MAX if none
         Vector3 angular_offset;             // GPS has some orientation bias -- this corrects when calibrated.
         bool offset_calibrated;             // flag to tell us if we've configured this
+        uint8_t bno_fetch[5];               // BNO_FETCH mask per STATES value
+        uint32_t bno_reads;
+        uint32_t loop_ticks;                // incrementTime() calls
+
+        // pad rows wait here, see enablePretrigger
+        PretriggerRing pretrigger;          // over the sketch's buffer
+        PretriggerCursor pre_csv, pre_bin;  // writeSD, writeSDBinary
+        uint32_t pretrigger_tick;           // loop_ticks when the last row was captured
+        uint32_t pretrigger_heartbeat_ms;
+        bool pretrigger_on;
+
+        // rows per logged/sent row in each state, see setRatePolicy
+        RatePolicy rate_policy[5];
+        RowReducer log_rows, serial_rows;
+        RatePolicy csv_rate, bin_rate;      // last policy announced in each log
+        uint64_t state_entered_ms;
+
+        // pad bias and alignment, see calibrate()
+        CalTable cal;
+        CalEstimator cal_est;
+        uint64_t cal_start_ms;              // first calibrate() call, UINT64_MAX before
+        bool cal_active;                    // cal is solved and applied to every IMU read
+
+        // failure counts, latency and back-off of each sensor, see SRAD_PHX_Health.h
+        HealthMonitor health;
+        bool (*sensor_init[SENSOR_COUNT])();    // re-initializes a sensor before each retry, or null
+        uint8_t csv_health[SENSOR_COUNT], bin_health[SENSOR_COUNT];     // last SENSOR_HEALTH each log announced
         
-        float altReadings[10];
-        uint8_t altReadings_ind;
+        ApogeeDetector<PHX_APOGEE_WINDOW> apogee;   // fed MSL baro altitude by read_BMP
 
 
         bool calibrated = false;
         STATES STATE;
         SerialTransfer myTransfer;
+        TelemetryEncoder tlm_tx;            // writeDataToTeensy
+        TelemetryDecoder tlm_rx;            // readDataFromTeensy
+        LinkSender link_tx;                 // writeDataToTeensy, thinned by the logging board's acks
+        LinkQueue<PHX_LINK_QUEUE> link_queue;   // readDataFromTeensy to nextLinkRecord
+        LinkRxStats link_rx;
+        uint16_t link_rx_since_ack;         // frames received since the last LinkAck
+        uint8_t link_ack_flags;             // LINK_ACK_FLAGS of the last LinkAck
+        SectorLogger *logger = nullptr;     // told about state changes when attached
 };
 
 #endif
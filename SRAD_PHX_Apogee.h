@@ -0,0 +1,132 @@
+#ifndef SRAD_PHX_APOGEE_H
+#define SRAD_PHX_APOGEE_H
+
+#include <stdint.h>
+
+// Window and thresholds for FLIGHT's detector; override with -D.
+#ifndef PHX_APOGEE_WINDOW
+#define PHX_APOGEE_WINDOW 50                // baro samples in the slope fit
+#endif
+#ifndef PHX_APOGEE_ARM_VEL
+#define PHX_APOGEE_ARM_VEL 10.0f            // m/s climb needed before descent can trigger
+#endif
+#ifndef PHX_APOGEE_DESCENT_VEL
+#define PHX_APOGEE_DESCENT_VEL 2.0f         // m/s sink rate that counts as descending
+#endif
+#ifndef PHX_APOGEE_CONFIRM
+#define PHX_APOGEE_CONFIRM 5                // consecutive descending fits to trigger
+#endif
+
+/**
+ * @brief least-squares altitude slope over a sliding window, with hysteresis
+ *
+ * Keeps the window's sum and index-weighted sum of altitude as exact
+ * centimetre integers, so the slope of a WINDOW sample fit is updated in
+ * O(1) per sample and never drifts. The slope per sample is turned into
+ * m/s with the window's mean sample interval, taken from the samples'
+ * own timestamps, so it holds at whatever rate read_BMP runs. Descent is
+ * latched once the fit has climbed faster than the arm velocity and then
+ * sunk faster than the descent velocity for `confirm` samples in a row.
+ *
+ * @tparam WINDOW samples in the fit
+ */
+template <uint16_t WINDOW>
+class ApogeeDetector {
+    static_assert(WINDOW >= 3, "apogee window needs at least 3 samples");
+
+    public:
+        ApogeeDetector() { reset(); }
+
+        void reset() {
+            head = 0;
+            count = 0;
+            sum_y = 0;
+            sum_iy = 0;
+            vel = 0;
+            below = 0;
+            armed = false;
+            triggered = false;
+        }
+
+        void setThresholds(float arm_vel, float descent_vel, uint8_t confirm_samples) {
+            arm = arm_vel;
+            descent = descent_vel;
+            confirm = confirm_samples;
+        }
+
+        /**
+         * @brief adds one altitude sample and updates the fit and hysteresis
+         * @param alt_m altitude, m
+         * @param time_us when it was sampled; only differences within the window are used
+         */
+        void add(float alt_m, uint32_t time_us) {
+            int32_t y = (int32_t)(alt_m * 100.0f + (alt_m < 0 ? -0.5f : 0.5f));
+
+            if(count < WINDOW) {
+                sum_iy += (int64_t)count * y;
+                sum_y += y;
+                ring[count] = y;
+                stamp[count++] = time_us;
+                if(count < WINDOW) {
+                    return;
+                }
+            } else {
+                // drop the oldest (index 0), shift every index down by one, append at WINDOW - 1
+                int32_t old = ring[head];
+                sum_iy += (int64_t)(WINDOW - 1) * y - (sum_y - old);
+                sum_y += y - old;
+                ring[head] = y;
+                stamp[head] = time_us;
+                if(++head == WINDOW) {
+                    head = 0;
+                }
+            }
+
+            // the oldest sample is now at head, the newest just before it
+            const uint32_t span_us = time_us - stamp[head];
+            if(span_us == 0) {
+                return;                             // no time has passed; keep the last fit
+            }
+            const int64_t sum_i = (int64_t)WINDOW * (WINDOW - 1) / 2;
+            const float denom = (float)WINDOW * WINDOW * ((float)WINDOW * WINDOW - 1) / 12.0f;
+            const float per_s = (WINDOW - 1) * 1e6f / span_us;      // samples per second over the window
+            vel = (float)(WINDOW * sum_iy - sum_i * sum_y) / denom * (per_s / 100.0f);
+
+            if(vel > arm) {
+                armed = true;
+            }
+            if(armed && vel < -descent) {
+                if(below < confirm) {
+                    below++;
+                }
+                if(below >= confirm) {
+                    triggered = true;
+                }
+            } else {
+                below = 0;
+            }
+        }
+
+        bool full() const { return count == WINDOW; }
+        bool isArmed() const { return armed; }
+        bool descending() const { return triggered; }
+        float velocity() const { return vel; }      // m/s, 0 until the window is full
+
+    private:
+        int32_t ring[WINDOW];                       // centimetres, oldest at head once full
+        uint32_t stamp[WINDOW];                     // sample time of each ring entry, us
+        uint16_t head;
+        uint16_t count;
+        int64_t sum_y;                              // sum of y
+        int64_t sum_iy;                             // sum of i * y, i = 0 for the oldest sample
+        float vel;
+        uint8_t below;
+        bool armed;
+        bool triggered;
+
+        float arm = PHX_APOGEE_ARM_VEL;
+        float descent = PHX_APOGEE_DESCENT_VEL;
+        uint8_t confirm = PHX_APOGEE_CONFIRM;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+
+#include "SRAD_PHX_Attitude.h"
+
+Quaternion quatMultiply(const Quaternion &a, const Quaternion &b) {
+    Quaternion r;
+    r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    return r;
+}
+
+Quaternion quatFromMatrix(const float m[9]) {
+    Quaternion r;
+    const float trace = m[0] + m[4] + m[8];
+    if(trace > 0) {
+        float s = 2.0f * sqrtf(1.0f + trace);
+        r.w = 0.25f * s;
+        r.x = (m[7] - m[5]) / s;
+        r.y = (m[2] - m[6]) / s;
+        r.z = (m[3] - m[1]) / s;
+    } else if(m[0] > m[4] && m[0] > m[8]) {
+        float s = 2.0f * sqrtf(1.0f + m[0] - m[4] - m[8]);
+        r.w = (m[7] - m[5]) / s;
+        r.x = 0.25f * s;
+        r.y = (m[1] + m[3]) / s;
+        r.z = (m[2] + m[6]) / s;
+    } else if(m[4] > m[8]) {
+        float s = 2.0f * sqrtf(1.0f + m[4] - m[0] - m[8]);
+        r.w = (m[2] - m[6]) / s;
+        r.x = (m[1] + m[3]) / s;
+        r.y = 0.25f * s;
+        r.z = (m[5] + m[7]) / s;
+    } else {
+        float s = 2.0f * sqrtf(1.0f + m[8] - m[0] - m[4]);
+        r.w = (m[3] - m[1]) / s;
+        r.x = (m[2] + m[6]) / s;
+        r.y = (m[5] + m[7]) / s;
+        r.z = 0.25f * s;
+    }
+    return r;
+}
+
+void AttitudePropagator::reset() {
+    q.w = 1;
+    q.x = q.y = q.z = 0;
+    ok = false;
+}
+
+/**
+ * @brief rotates by one gyro sample
+ * @param gyro body rates, rad/s
+ */
+void AttitudePropagator::propagate(const float gyro[3], float dt_s) {
+    // exp of the half-angle vector h: cos|h| and sin|h|/|h| to fourth order
+    const float hx = 0.5f * dt_s * gyro[0], hy = 0.5f * dt_s * gyro[1], hz = 0.5f * dt_s * gyro[2];
+    const float h2 = hx * hx + hy * hy + hz * hz;
+    const float c = 1.0f - h2 * (0.5f - h2 * (1.0f / 24));
+    const float s = 1.0f - h2 * ((1.0f / 6) - h2 * (1.0f / 120));
+    const float dx = s * hx, dy = s * hy, dz = s * hz;
+
+    const float w = q.w * c - q.x * dx - q.y * dy - q.z * dz;
+    const float x = q.w * dx + q.x * c + q.y * dz - q.z * dy;
+    const float y = q.w * dy - q.x * dz + q.y * c + q.z * dx;
+    const float z = q.w * dz + q.x * dy - q.y * dx + q.z * c;
+
+    // |q| stays within float rounding of 1, where one Newton step is exact enough
+    const float k = 1.5f - 0.5f * (w * w + x * x + y * y + z * z);
+    q.w = w * k;
+    q.x = x * k;
+    q.y = y * k;
+    q.z = z * k;
+}
+
+/**
+ * @brief moves `gain` of the way to an absolute orientation (normalized lerp)
+ */
+void AttitudePropagator::anchor(const Quaternion &target, float gain) {
+    if(!ok || gain >= 1.0f) {
+        q = target;
+    } else {
+        // q and -q are the same rotation; blend towards the nearer one
+        const float sign = q.w * target.w + q.x * target.x + q.y * target.y + q.z * target.z < 0 ? -gain : gain;
+        q.w += (sign * target.w - gain * q.w);
+        q.x += (sign * target.x - gain * q.x);
+        q.y += (sign * target.y - gain * q.y);
+        q.z += (sign * target.z - gain * q.z);
+    }
+    const float n = sqrtf(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    q.w /= n;
+    q.x /= n;
+    q.y /= n;
+    q.z /= n;
+    ok = true;
+}
+
+/**
+ * @brief sets tilt from a still accelerometer, heading zero
+ * @param acc specific force in the body frame, pointing up at rest
+ * @return false if it is too small or points down the rocket axis
+ */
+bool AttitudePropagator::level(const float acc[3]) {
+    const float n = sqrtf(acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2]);
+    if(n < 1.0f) {
+        return false;
+    }
+    // smallest rotation taking the measured up onto world z
+    const float ax = acc[0] / n, ay = acc[1] / n, az = acc[2] / n;
+    if(az < -0.99f) {
+        return false;
+    }
+    Quaternion target;
+    target.w = 1.0f + az;
+    target.x = ay;
+    target.y = -ax;
+    target.z = 0;
+    ok = false;
+    anchor(target, 1.0f);
+    return true;
+}
+
+float AttitudePropagator::tilt() const {
+    float c = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+    return acosf(c > 1.0f ? 1.0f : c < -1.0f ? -1.0f : c);
+}
+
+float AttitudePropagator::up(const float v[3]) const {
+    return 2.0f * (q.x * q.z - q.w * q.y) * v[0]
+         + 2.0f * (q.y * q.z + q.w * q.x) * v[1]
+         + (1.0f - 2.0f * (q.x * q.x + q.y * q.y)) * v[2];
+}
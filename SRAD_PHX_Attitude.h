@@ -0,0 +1,58 @@
+#ifndef SRAD_PHX_ATTITUDE_H
+#define SRAD_PHX_ATTITUDE_H
+
+// Orientation between BNO055 fusion outputs, from the LSM6DSO32 gyro at
+// its full rate. The BNO's fusion falls apart under boost, so FLIGHT
+// only re-anchors to it when it can be trusted and otherwise integrates.
+
+#include <stdint.h>
+
+#include <Quaternion.h>
+
+// Attitude tuning; override with -D.
+#ifndef PHX_ATT_BNO_GAIN
+#define PHX_ATT_BNO_GAIN 1.0f               // share of the way to a trusted BNO sample, 1 = take it as is
+#endif
+#ifndef PHX_ATT_BNO_MAX_ACC
+#define PHX_ATT_BNO_MAX_ACC 29.4f           // m/s^2 (3 g); above this the BNO fusion is not trusted
+#endif
+#ifndef PHX_ATT_BNO_HOLDOFF_MS
+#define PHX_ATT_BNO_HOLDOFF_MS 2000         // and not for this long after, while it settles
+#endif
+#ifndef PHX_ATT_LEVEL_MS
+#define PHX_ATT_LEVEL_MS 1000               // on the pad with no BNO for this long, level from gravity
+#endif
+
+/**
+ * @brief body-to-world quaternion propagated from body rates
+ *
+ * `v_world = q v_body q*`, world z up, the rocket axis is body z. Each
+ * step multiplies by the rotation of one gyro sample, from a fourth-order
+ * series instead of sin/cos, and renormalizes with one Newton step of
+ * 1/sqrt instead of a sqrt and a divide. About 60 float operations.
+ */
+class AttitudePropagator {
+    public:
+        AttitudePropagator() { reset(); }
+
+        void reset();
+        void propagate(const float gyro[3], float dt_s);
+        void anchor(const Quaternion &body_to_world, float gain);
+        bool level(const float acc[3]);
+
+        bool valid() const { return ok; }
+        const Quaternion& orientation() const { return q; }
+        float tilt() const;                 // rad between the rocket axis and up
+        float up(const float v[3]) const;   // world-up component of a body-frame vector
+
+    private:
+        Quaternion q;
+        bool ok;                            // anchored or levelled at least once
+};
+
+// a * b, b applied first
+Quaternion quatMultiply(const Quaternion &a, const Quaternion &b);
+// unit quaternion of a row-major rotation matrix
+Quaternion quatFromMatrix(const float m[9]);
+
+#endif
@@ -0,0 +1,124 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "SRAD_PHX_Bno.h"
+
+struct BnoBlock {
+    uint8_t bit, reg, len;
+};
+
+// in register order
+static const BnoBlock BLOCKS[] = {
+    { BNO_FETCH_ACC,  BNO055_ACC_DATA, 6 },
+    { BNO_FETCH_MAG,  BNO055_MAG_DATA, 6 },
+    { BNO_FETCH_GYRO, BNO055_GYR_DATA, 6 },
+    { BNO_FETCH_QUAT, BNO055_QUA_DATA, 8 },
+    { BNO_FETCH_TEMP, BNO055_TEMP,     1 },
+};
+#define BNO_BLOCK_COUNT (sizeof(BLOCKS) / sizeof(BLOCKS[0]))
+#define BNO_BURST_MAX (BNO055_TEMP + 1 - BNO055_ACC_DATA)
+
+static int16_t le16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static void vector(const uint8_t *p, float *out, int n, float per_lsb) {
+    for(int i = 0; i < n; i++) {
+        out[i] = le16(p + 2 * i) * per_lsb;
+    }
+}
+
+// Finds the register span covering every requested block.
+static bool span(uint8_t fetch, uint8_t &first, uint8_t &end) {
+    first = 0xFF;
+    end = 0;
+    for(size_t i = 0; i < BNO_BLOCK_COUNT; i++) {
+        if(fetch & BLOCKS[i].bit) {
+            if(first == 0xFF) first = BLOCKS[i].reg;
+            end = BLOCKS[i].reg + BLOCKS[i].len;
+        }
+    }
+    return first != 0xFF;
+}
+
+/**
+ * @brief bytes one read() with `fetch` transfers
+ */
+uint8_t BNO055Burst::burstLength(uint8_t fetch) {
+    uint8_t first, end;
+    return span(fetch, first, end) ? end - first : 0;
+}
+
+/**
+ * @brief puts the chip in NDOF fusion mode with the default units
+ */
+bool BNO055Burst::begin() {
+    uint8_t id;
+    if(!bus.readRegs(BNO055_CHIP_ID, &id, 1) || id != BNO055_CHIP_ID_VALUE) {
+        return false;
+    }
+    if(!bus.writeReg(BNO055_OPR_MODE, 0x00)) {      // CONFIG
+        return false;
+    }
+    delay(25);
+    if(!bus.writeReg(BNO055_PWR_MODE, 0x00) || !bus.writeReg(BNO055_PAGE_ID, 0x00)) {
+        return false;
+    }
+    if(!bus.writeReg(BNO055_OPR_MODE, 0x0C)) {      // NDOF
+        return false;
+    }
+    delay(20);
+    return true;
+}
+
+/**
+ * @brief reads the vectors in `fetch` with one transaction
+ * @return false if the transfer failed
+ */
+bool BNO055Burst::read(BnoSample &s, uint8_t fetch) {
+    uint8_t first, end;
+    s.fetched = 0;
+    for(int i = 0; i < 3; i++) {
+        s.acc[i] = s.mag[i] = s.gyro[i] = NAN;
+    }
+    for(int i = 0; i < 4; i++) {
+        s.quat[i] = NAN;
+    }
+    s.temp = NAN;
+    if(!span(fetch, first, end)) {
+        return true;
+    }
+
+    uint8_t buf[BNO_BURST_MAX];
+    if(!bus.readRegs(first, buf, end - first)) {
+        return false;
+    }
+
+    if(fetch & BNO_FETCH_ACC) {
+        vector(buf + (BNO055_ACC_DATA - first), s.acc, 3, 1 / 100.0f);
+    }
+    if(fetch & BNO_FETCH_MAG) {
+        vector(buf + (BNO055_MAG_DATA - first), s.mag, 3, 1 / 16.0f);
+    }
+    if(fetch & BNO_FETCH_GYRO) {
+        vector(buf + (BNO055_GYR_DATA - first), s.gyro, 3, 0.017453293f / 16.0f);
+    }
+    if(fetch & BNO_FETCH_QUAT) {
+        vector(buf + (BNO055_QUA_DATA - first), s.quat, 4, 1 / 16384.0f);
+    }
+    if(fetch & BNO_FETCH_TEMP) {
+        s.temp = (int8_t)buf[BNO055_TEMP - first];
+    }
+    s.fetched = fetch & BNO_FETCH_ALL;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SRAD_PHX_BNO_H
+#define SRAD_PHX_BNO_H
+
+// BNO055 reads as one burst over the contiguous data registers instead of
+// a getEvent()/getQuat()/getTemp() transaction per vector. Which vectors
+// are fetched is a bit mask, so a flight phase can skip the ones it does
+// not need and shorten the burst.
+
+#include <stdint.h>
+
+#include "SRAD_PHX_Fifo.h"                  // RegisterBus
+
+#ifndef PHX_BNO_TEMP_DIVIDER
+#define PHX_BNO_TEMP_DIVIDER 50             // temperature joins every Nth burst
+#endif
+
+#define BNO055_CHIP_ID_VALUE 0xA0
+
+enum BNO055_REG : uint8_t {
+    BNO055_CHIP_ID = 0x00,
+    BNO055_PAGE_ID = 0x07,
+    BNO055_ACC_DATA = 0x08,                 // x, y, z int16, 100 LSB per m/s^2
+    BNO055_MAG_DATA = 0x0E,                 // 16 LSB per uT
+    BNO055_GYR_DATA = 0x14,                 // 16 LSB per dps
+    BNO055_QUA_DATA = 0x20,                 // w, x, y, z int16, 2^14 LSB per unit
+    BNO055_TEMP = 0x34,                     // int8, 1 LSB per degree C
+    BNO055_OPR_MODE = 0x3D,
+    BNO055_PWR_MODE = 0x3E,
+};
+
+enum BNO_FETCH : uint8_t {
+    BNO_FETCH_ACC = 1 << 0,
+    BNO_FETCH_MAG = 1 << 1,
+    BNO_FETCH_GYRO = 1 << 2,
+    BNO_FETCH_QUAT = 1 << 3,
+    BNO_FETCH_TEMP = 1 << 4,
+    BNO_FETCH_ALL = 0x1F,
+};
+
+struct BnoSample {
+    float acc[3];                           // m/s^2
+    float mag[3];                           // uT
+    float gyro[3];                          // rad/s
+    float quat[4];                          // w, x, y, z
+    float temp;                             // degrees C
+    uint8_t fetched;                        // BNO_FETCH bits read; the rest are NAN
+};
+
+/**
+ * @brief BNO055 data registers in a single transaction
+ *
+ * The burst runs from the first to the last register of the requested
+ * vectors, so registers in between (e.g. Euler angles) are read and
+ * ignored rather than costing another transaction.
+ */
+class BNO055Burst {
+    public:
+        BNO055Burst(RegisterBus &b) : bus(b) {}
+
+        bool begin();
+        bool read(BnoSample &, uint8_t fetch = BNO_FETCH_ALL);
+
+        static uint8_t burstLength(uint8_t fetch);
+
+    private:
+        RegisterBus &bus;
+};
+
+#endif
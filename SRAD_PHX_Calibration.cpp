@@ -0,0 +1,200 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "SRAD_PHX_Calibration.h"
+#include "SRAD_PHX_Estimator.h"
+
+void CalTable::setIdentity() {
+    memset(this, 0, sizeof(*this));
+    for(int c = 0; c < CAL_CHANNELS; c++) {
+        m[0][c] = m[4][c] = m[8][c] = 1.0f;
+    }
+}
+
+bool CalTable::isIdentity(uint8_t c) const {
+    for(int k = 0; k < 9; k++) {
+        if(m[k][c] != (k % 4 == 0 ? 1.0f : 0.0f)) {
+            return false;
+        }
+    }
+    return offset[0][c] == 0 && offset[1][c] == 0 && offset[2][c] == 0;
+}
+
+void calApplyScalar(const CalTable &cal, uint8_t c, float *v, uint16_t stride, uint16_t n) {
+    const float m0 = cal.m[0][c], m1 = cal.m[1][c], m2 = cal.m[2][c];
+    const float m3 = cal.m[3][c], m4 = cal.m[4][c], m5 = cal.m[5][c];
+    const float m6 = cal.m[6][c], m7 = cal.m[7][c], m8 = cal.m[8][c];
+    const float o0 = cal.offset[0][c], o1 = cal.offset[1][c], o2 = cal.offset[2][c];
+
+    for(uint16_t i = 0; i < n; i++, v += stride) {
+        const float x = v[0], y = v[1], z = v[2];
+        v[0] = ((m0 * x + m1 * y) + m2 * z) + o0;
+        v[1] = ((m3 * x + m4 * y) + m5 * z) + o1;
+        v[2] = ((m6 * x + m7 * y) + m8 * z) + o2;
+    }
+}
+
+#if defined(__GNUC__)
+
+typedef float calv4 __attribute__((vector_size(16)));
+
+static inline calv4 splat(float f) {
+    return calv4{ f, f, f, f };
+}
+
+/**
+ * Four vectors per step: their x, y and z are gathered into three
+ * registers, multiplied by the broadcast coefficients and scattered back.
+ * The remainder goes through the scalar loop.
+ */
+void calApplySimd(const CalTable &cal, uint8_t c, float *v, uint16_t stride, uint16_t n) {
+    const calv4 m0 = splat(cal.m[0][c]), m1 = splat(cal.m[1][c]), m2 = splat(cal.m[2][c]);
+    const calv4 m3 = splat(cal.m[3][c]), m4 = splat(cal.m[4][c]), m5 = splat(cal.m[5][c]);
+    const calv4 m6 = splat(cal.m[6][c]), m7 = splat(cal.m[7][c]), m8 = splat(cal.m[8][c]);
+    const calv4 o0 = splat(cal.offset[0][c]), o1 = splat(cal.offset[1][c]), o2 = splat(cal.offset[2][c]);
+
+    uint16_t i = 0;
+    for(; i + 4 <= n; i += 4, v += 4 * stride) {
+        float *a = v, *b = v + stride, *d = v + 2 * stride, *e = v + 3 * stride;
+        const calv4 x = { a[0], b[0], d[0], e[0] };
+        const calv4 y = { a[1], b[1], d[1], e[1] };
+        const calv4 z = { a[2], b[2], d[2], e[2] };
+        const calv4 rx = ((m0 * x + m1 * y) + m2 * z) + o0;
+        const calv4 ry = ((m3 * x + m4 * y) + m5 * z) + o1;
+        const calv4 rz = ((m6 * x + m7 * y) + m8 * z) + o2;
+        a[0] = rx[0]; b[0] = rx[1]; d[0] = rx[2]; e[0] = rx[3];
+        a[1] = ry[0]; b[1] = ry[1]; d[1] = ry[2]; e[1] = ry[3];
+        a[2] = rz[0]; b[2] = rz[1]; d[2] = rz[2]; e[2] = rz[3];
+    }
+    calApplyScalar(cal, c, v, stride, n - i);
+}
+
+#else
+
+void calApplySimd(const CalTable &cal, uint8_t c, float *v, uint16_t stride, uint16_t n) {
+    calApplyScalar(cal, c, v, stride, n);
+}
+
+#endif
+
+void CalEstimator::reset() {
+    memset(sum, 0, sizeof(sum));
+    memset(n, 0, sizeof(n));
+    ticks = 0;
+}
+
+void CalEstimator::add(uint8_t c, float x, float y, float z) {
+    if(isnan(x) || isnan(y) || isnan(z) || n[c] == UINT16_MAX) {
+        return;
+    }
+    sum[c][0] += x;
+    sum[c][1] += y;
+    sum[c][2] += z;
+    n[c]++;
+}
+
+// smallest rotation taking unit vector a onto unit vector b, row-major
+static bool alignRotation(const float a[3], const float b[3], float r[9]) {
+    const float v[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+    const float cosine = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    if(cosine < -0.99f) {
+        return false;                       // upside down: no unique smallest rotation
+    }
+    const float k = 1.0f / (1.0f + cosine);
+    r[0] = 1 - k * (v[1] * v[1] + v[2] * v[2]);
+    r[1] = -v[2] + k * v[0] * v[1];
+    r[2] = v[1] + k * v[0] * v[2];
+    r[3] = v[2] + k * v[0] * v[1];
+    r[4] = 1 - k * (v[0] * v[0] + v[2] * v[2]);
+    r[5] = -v[0] + k * v[1] * v[2];
+    r[6] = -v[1] + k * v[0] * v[2];
+    r[7] = v[0] + k * v[1] * v[2];
+    r[8] = 1 - k * (v[0] * v[0] + v[1] * v[1]);
+    return true;
+}
+
+static const uint8_t GYROS[2] = { CAL_LSM_GYRO, CAL_BNO_GYRO };
+static const uint8_t ACCELS[3] = { CAL_LSM_ACC, CAL_ADXL_ACC, CAL_BNO_ACC };   // reference order
+
+void CalEstimator::solve(CalTable &out) const {
+    out.setIdentity();
+    const uint16_t need = ticks / 2 > 0 ? ticks / 2 : 1;
+    float mean[CAL_CHANNELS][3];
+    for(int c = 0; c < CAL_CHANNELS; c++) {
+        for(int a = 0; a < 3; a++) {
+            mean[c][a] = n[c] ? (float)(sum[c][a] / n[c]) : 0;
+        }
+    }
+
+    for(uint8_t c : GYROS) {
+        if(n[c] >= need) {
+            for(int a = 0; a < 3; a++) {
+                out.offset[a][c] = -mean[c][a];
+            }
+        }
+    }
+
+    int ref = -1;
+    for(uint8_t c : ACCELS) {
+        if(n[c] >= need && ref < 0) {
+            ref = c;
+        }
+    }
+    if(ref < 0) {
+        return;
+    }
+    float up[3];
+    float len = sqrtf(mean[ref][0] * mean[ref][0] + mean[ref][1] * mean[ref][1] + mean[ref][2] * mean[ref][2]);
+    if(len < 1.0f) {
+        return;
+    }
+    for(int a = 0; a < 3; a++) {
+        up[a] = mean[ref][a] / len;
+    }
+
+    for(uint8_t c : ACCELS) {
+        if(n[c] < need) {
+            continue;
+        }
+        const float *g = mean[c];
+        float glen = sqrtf(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+        if(glen < 1.0f) {
+            continue;
+        }
+        float r[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+        if(c != ref) {
+            const float dir[3] = { g[0] / glen, g[1] / glen, g[2] / glen };
+            if(!alignRotation(dir, up, r)) {
+                continue;
+            }
+        }
+        // rotated mean, then the offset that leaves exactly 1 g along `up`
+        for(int row = 0; row < 3; row++) {
+            float rg = r[3 * row] * g[0] + r[3 * row + 1] * g[1] + r[3 * row + 2] * g[2];
+            for(int col = 0; col < 3; col++) {
+                out.m[3 * row + col][c] = r[3 * row + col];
+            }
+            out.offset[row][c] = up[row] * PHX_GRAVITY - rg;
+        }
+        if(c == CAL_BNO_ACC) {
+            for(int k = 0; k < 9; k++) {
+                out.m[k][CAL_BNO_GYRO] = r[k];
+            }
+            // the bias was measured in the chip's frame; rotate it with the axes
+            float b[3] = { out.offset[0][CAL_BNO_GYRO], out.offset[1][CAL_BNO_GYRO], out.offset[2][CAL_BNO_GYRO] };
+            for(int row = 0; row < 3; row++) {
+                out.offset[row][CAL_BNO_GYRO] = r[3 * row] * b[0] + r[3 * row + 1] * b[1] + r[3 * row + 2] * b[2];
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef SRAD_PHX_CALIBRATION_H
+#define SRAD_PHX_CALIBRATION_H
+
+// Per-sensor bias and mounting alignment, estimated on the pad in
+// PRE_NO_CAL and applied to every IMU read after. No Arduino dependency.
+
+#include <stdint.h>
+
+// Pad calibration; override with -D.
+#ifndef PHX_CAL_SAMPLES
+#define PHX_CAL_SAMPLES 200                 // still ticks averaged, 2 s at PHX_RATE_STATE_HZ
+#endif
+#ifndef PHX_CAL_MAX_MS
+#define PHX_CAL_MAX_MS 10000                // never still this long: leave PRE_NO_CAL uncalibrated
+#endif
+#ifndef PHX_CAL_STILL_GYRO
+#define PHX_CAL_STILL_GYRO 0.05f            // rad/s; more than this restarts the average
+#endif
+#ifndef PHX_CAL_STILL_ACC
+#define PHX_CAL_STILL_ACC 1.5f              // m/s^2 from 1 g; more than this restarts the average
+#endif
+
+// 4-wide kernel through GCC vector extensions where the target has float
+// SIMD (SSE on the host, NEON); the Teensy's M7 has none and uses the
+// scalar loop. -DPHX_CAL_SIMD=0 forces the scalar loop.
+#ifndef PHX_CAL_SIMD
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define PHX_CAL_SIMD 1
+#else
+#define PHX_CAL_SIMD 0
+#endif
+#endif
+
+enum CAL_CHANNEL : uint8_t {
+    CAL_LSM_ACC = 0,
+    CAL_LSM_GYRO,
+    CAL_ADXL_ACC,
+    CAL_BNO_ACC,
+    CAL_BNO_GYRO,
+    CAL_CHANNELS
+};
+
+/**
+ * @brief corrected = m * raw + offset, for each CAL_CHANNEL
+ *
+ * Structure of arrays: one row per coefficient, one column per channel,
+ * so the whole table is 240 bytes and a channel's 12 coefficients are
+ * read with a fixed stride.
+ */
+struct CalTable {
+    float m[9][CAL_CHANNELS];               // row-major 3x3, m[3 * row + col][channel]
+    float offset[3][CAL_CHANNELS];
+
+    void setIdentity();
+    bool isIdentity(uint8_t channel) const;
+};
+
+/**
+ * @brief applies one channel of `cal` to `n` vectors in place
+ *
+ * `v` points at the first vector's x; y and z follow it, and each vector
+ * starts `stride` floats after the previous one, so packed vectors
+ * (stride 3) and SampleBatch acc/gyro (stride 7) are corrected where they
+ * lie. Both versions evaluate ((m0 x + m1 y) + m2 z) + o in the same
+ * order, so they give the same bits (NaN payloads aside); phx_cal checks
+ * that on the host.
+ */
+void calApplyScalar(const CalTable &cal, uint8_t channel, float *v, uint16_t stride, uint16_t n);
+void calApplySimd(const CalTable &cal, uint8_t channel, float *v, uint16_t stride, uint16_t n);
+
+inline void calApply(const CalTable &cal, uint8_t channel, float *v, uint16_t stride, uint16_t n) {
+#if PHX_CAL_SIMD
+    calApplySimd(cal, channel, v, stride, n);
+#else
+    calApplyScalar(cal, channel, v, stride, n);
+#endif
+}
+
+/**
+ * @brief averages each channel while the rocket sits still and solves a CalTable
+ *
+ * Gyros: the mean is the bias. Accelerometers: the first of LSM, ADXL,
+ * BNO with enough samples is the reference and defines the rocket frame.
+ * Each other accelerometer gets the smallest rotation that turns its mean
+ * onto the reference's, and every accelerometer an offset that puts its
+ * mean at exactly 1 g along the reference. The BNO gyro shares the BNO
+ * accelerometer's rotation. Only tilt is observable from gravity; a
+ * rotation about the gravity vector is not corrected.
+ */
+class CalEstimator {
+    public:
+        CalEstimator() { reset(); }
+
+        void reset();
+        void add(uint8_t channel, float x, float y, float z);
+        void tick() { ticks++; }            // one still tick, whichever channels it added
+        uint16_t stillTicks() const { return ticks; }
+        uint16_t count(uint8_t channel) const { return n[channel]; }
+        void solve(CalTable &out) const;
+
+    private:
+        double sum[CAL_CHANNELS][3];
+        uint16_t n[CAL_CHANNELS];
+        uint16_t ticks;
+};
+
+#endif
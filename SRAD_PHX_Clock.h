@@ -0,0 +1,40 @@
+#ifndef SRAD_PHX_CLOCK_H
+#define SRAD_PHX_CLOCK_H
+
+// 64-bit microsecond time base. micros() is 32 bits and wraps every
+// 71.6 minutes, which a rocket can spend on the pad; the flight loop
+// extends it by counting the wraps. No Arduino dependency: the caller
+// passes the micros() reading in.
+
+#include <stdint.h>
+
+/**
+ * @brief widens a free-running 32-bit microsecond counter to 64 bits
+ *
+ * Correct as long as extend() is called at least once per wrap, which
+ * every loop iteration does. Not for use from interrupts: an ISR keeps
+ * its 32-bit stamp and the loop widens it with widen().
+ */
+class MicrosClock {
+    public:
+        MicrosClock() : high(0), last(0) {}
+
+        uint64_t extend(uint32_t now32) {
+            if(now32 < last) {
+                high += 1ULL << 32;
+            }
+            last = now32;
+            return high | now32;
+        }
+
+        // a 32-bit stamp taken at most half a wrap before or after the last extend()
+        uint64_t widen(uint32_t stamp32) const {
+            return (high | last) + (int64_t)(int32_t)(stamp32 - last);
+        }
+
+    private:
+        uint64_t high;                      // wraps counted so far, in the upper word
+        uint32_t last;                      // last reading
+};
+
+#endif
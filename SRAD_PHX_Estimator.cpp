@@ -0,0 +1,72 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Estimator.h"
+
+/**
+ * @brief restarts the filter at `alt` with zero velocity
+ *
+ * The first baro sample after reset is taken as-is.
+ */
+void AltitudeEstimator::reset(float alt) {
+    h = alt;
+    v = 0;
+    a = 0;
+    p00 = 100.0f;
+    p01 = 0;
+    p11 = 100.0f;
+    initialized = false;
+}
+
+/**
+ * @brief advances the state by `dt_s` under vertical acceleration `acc`
+ * @param acc vertical acceleration with gravity removed, m/s^2
+ * @param acc_sigma 1 sigma error of `acc`, used as process noise
+ */
+void AltitudeEstimator::predict(float acc, float dt_s, float acc_sigma) {
+    a = acc;
+    if(dt_s <= 0) {
+        return;
+    }
+    float dt2 = dt_s * dt_s;
+    h += v * dt_s + 0.5f * acc * dt2;
+    v += acc * dt_s;
+
+    // P = F P F' + G G' q, F = [1 dt; 0 1], G = [dt^2/2; dt]
+    float q = acc_sigma * acc_sigma;
+    float n00 = p00 + 2 * dt_s * p01 + dt2 * p11 + 0.25f * dt2 * dt2 * q;
+    float n01 = p01 + dt_s * p11 + 0.5f * dt2 * dt_s * q;
+    float n11 = p11 + dt2 * q;
+    p00 = n00;
+    p01 = n01;
+    p11 = n11;
+}
+
+/**
+ * @brief folds in one baro altitude measurement
+ */
+void AltitudeEstimator::correct(float alt, float alt_sigma) {
+    if(!initialized) {
+        h = alt;
+        initialized = true;
+        return;
+    }
+    float s = p00 + alt_sigma * alt_sigma;
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    float y = alt - h;
+    h += k0 * y;
+    v += k1 * y;
+
+    float n11 = p11 - k1 * p01;
+    p01 = (1 - k0) * p01;
+    p00 = (1 - k0) * p00;
+    p11 = n11;
+}
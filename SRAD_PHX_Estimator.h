@@ -0,0 +1,67 @@
+#ifndef SRAD_PHX_ESTIMATOR_H
+#define SRAD_PHX_ESTIMATOR_H
+
+#include <stdint.h>
+
+// Filter tuning; override with -D.
+#ifndef PHX_EST_BARO_SIGMA
+#define PHX_EST_BARO_SIGMA 0.5f             // BMP388 altitude noise, metres
+#endif
+#ifndef PHX_EST_LSM_SIGMA
+#define PHX_EST_LSM_SIGMA 0.5f              // process noise with the LSM as input, m/s^2
+#endif
+#ifndef PHX_EST_ADXL_SIGMA
+#define PHX_EST_ADXL_SIGMA 2.0f             // ADXL375 is ~4x noisier
+#endif
+#ifndef PHX_EST_NO_ACC_SIGMA
+#define PHX_EST_NO_ACC_SIGMA 20.0f          // baro only: constant velocity model
+#endif
+#ifndef PHX_LSM_SATURATION
+#define PHX_LSM_SATURATION 300.0f           // m/s^2, LSM6DSO32 full scale is 32 g (313.8)
+#endif
+#ifndef PHX_ASCENT_BARO_VEL
+#define PHX_ASCENT_BARO_VEL 15.0f           // m/s, liftoff without accelerometers
+#endif
+#ifndef PHX_LANDED_VEL
+#define PHX_LANDED_VEL 2.0f                 // m/s, slower than this counts as still
+#endif
+#ifndef PHX_EST_MAX_DT_S
+#define PHX_EST_MAX_DT_S 0.5f               // longer gaps are treated as this long
+#endif
+
+#define PHX_GRAVITY 9.80665f
+
+// accelerometer feeding the estimator, logged as acc_source
+enum ACC_SOURCE : uint8_t {
+    ACC_NONE = 0,                           // both failed, baro only
+    ACC_LSM = 1,
+    ACC_ADXL = 2,                           // LSM failed or saturated
+};
+
+/**
+ * @brief two-state (altitude, vertical velocity) Kalman filter
+ *
+ * Vertical acceleration drives the prediction and baro altitude
+ * corrects it. Both steps are a handful of float operations on a
+ * fixed 2x2 covariance, so cost per tick is constant.
+ */
+class AltitudeEstimator {
+    public:
+        AltitudeEstimator() { reset(0); }
+
+        void reset(float alt);
+        void predict(float acc, float dt_s, float acc_sigma);
+        void correct(float alt, float alt_sigma);
+
+        bool ready() const { return initialized; }
+        float altitude() const { return h; }
+        float velocity() const { return v; }
+        float acceleration() const { return a; }
+
+    private:
+        float h, v, a;
+        float p00, p01, p11;                // covariance, symmetric
+        bool initialized;
+};
+
+#endif
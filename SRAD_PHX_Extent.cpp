@@ -0,0 +1,214 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+
+#include "SRAD_PHX_Extent.h"
+
+static_assert(sizeof(ExtentSuper) <= PHX_EXTENT_SECTOR, "ExtentSuper must fit in one sector");
+static_assert(sizeof(ExtentBlockHeader) == 16, "ExtentBlockHeader layout changed");
+
+// one nibble at a time: 64 bytes of table instead of 1 KB, about 3 us per sector on a Teensy 4
+static const uint32_t CRC32_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t phxCrc32(const uint8_t *data, size_t len, uint32_t crc) {
+    crc = ~crc;
+    while(len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 15];
+        crc = (crc >> 4) ^ CRC32_NIBBLE[crc & 15];
+    }
+    return ~crc;
+}
+
+bool extentBlockValid(const uint8_t *sector, uint32_t seq, ExtentBlockHeader &hdr) {
+    memcpy(&hdr, sector, sizeof(hdr));
+    if(hdr.magic != PHX_EXTENT_BLOCK_MAGIC || hdr.seq != seq || hdr.used > PHX_EXTENT_PAYLOAD) {
+        return false;
+    }
+    uint32_t crc;
+    memcpy(&crc, sector + PHX_EXTENT_SECTOR - sizeof(crc), sizeof(crc));
+    return crc == phxCrc32(sector, PHX_EXTENT_SECTOR - sizeof(crc));
+}
+
+static bool readSuper(BlockDevice &dev, uint32_t lba, uint32_t first_lba, uint32_t sectors,
+                      uint8_t *scratch, ExtentSuper &sb) {
+    if(!dev.readSector(lba, scratch)) {
+        return false;
+    }
+    memcpy(&sb, scratch, sizeof(sb));
+    return memcmp(sb.magic, PHX_EXTENT_MAGIC, PHX_EXTENT_MAGIC_LEN) == 0
+        && sb.version == PHX_EXTENT_VERSION
+        && sb.crc == phxCrc32(scratch, offsetof(ExtentSuper, crc))
+        && sb.first_lba == first_lba && sb.sectors == sectors
+        && sb.next <= sectors - PHX_EXTENT_SUPERS;
+}
+
+/**
+ * @brief finds the last valid block after a power loss
+ *
+ * Takes the newer of the two superblocks, so a torn superblock write
+ * falls back to the previous one, then reads forward from its `next`
+ * until a block is torn, stale (another session or index) or past the
+ * end of the extent. The scan is as long as the log grew since the last
+ * superblock update.
+ */
+bool recoverExtent(BlockDevice &dev, uint32_t first_lba, uint32_t sectors, ExtentRecovery &rec, uint8_t *scratch) {
+    if(sectors <= PHX_EXTENT_SUPERS) {
+        return false;
+    }
+    ExtentSuper a, b;
+    const bool a_ok = readSuper(dev, first_lba, first_lba, sectors, scratch, a);
+    const bool b_ok = readSuper(dev, first_lba + 1, first_lba, sectors, scratch, b);
+    if(!a_ok && !b_ok) {
+        return false;
+    }
+    const ExtentSuper &sb = !b_ok || (a_ok && a.generation > b.generation) ? a : b;
+
+    rec.generation = sb.generation;
+    rec.session = sb.session;
+    rec.session_start = sb.session_start;
+    rec.super_next = sb.next;
+    rec.end = sb.next;
+    rec.scanned = 0;
+    const uint32_t capacity = sectors - PHX_EXTENT_SUPERS;
+    ExtentBlockHeader hdr;
+    while(rec.end < capacity) {
+        rec.scanned++;
+        if(!dev.readSector(first_lba + PHX_EXTENT_SUPERS + rec.end, scratch)
+           || !extentBlockValid(scratch, rec.end, hdr) || hdr.session != sb.session) {
+            break;
+        }
+        rec.end++;
+    }
+    return true;
+}
+
+ExtentJournal::ExtentJournal()
+: dev(nullptr), first_lba(0), sectors(0), session_id(0), session_start(0), next_block(0),
+  synced(0), generation(0), sector(), stat() {}
+
+/**
+ * @brief opens the extent, continuing after whatever log it already holds
+ * @param first_lba first sector of the preallocated extent
+ * @param sectors extent length, at least PHX_EXTENT_SUPERS + 1
+ * @param nonce session id if the extent has no valid superblock, e.g. the RTC
+ *
+ * After a reset mid-flight the log picks up at the recovered end under a
+ * new session, so nothing already written is overwritten. An extent with
+ * no valid superblock is formatted. The nonce keeps blocks left on the
+ * card by an earlier, deleted log from passing as this one's.
+ */
+bool ExtentJournal::begin(BlockDevice &d, uint32_t lba, uint32_t n, uint32_t nonce) {
+    dev = &d;
+    first_lba = lba;
+    sectors = n;
+    if(capacity() == 0) {
+        dev = nullptr;
+        return false;
+    }
+
+    ExtentRecovery rec;
+    if(recoverExtent(d, lba, n, rec, sector)) {
+        session_id = rec.session + 1;
+        next_block = rec.end;
+        generation = rec.generation;
+        stat.recovered = rec.end - rec.super_next;
+    } else {
+        session_id = nonce;
+        next_block = 0;
+        generation = 0;
+    }
+    if(session_id == 0) {
+        session_id = 1;
+    }
+    session_start = next_block;
+    // a new extent gets both copies, so a superblock of an earlier one cannot outrank it
+    if(generation == 0 && !writeSuper()) {
+        return false;
+    }
+    return writeSuper();
+}
+
+bool ExtentJournal::writeSuper() {
+    ExtentSuper sb;
+    memcpy(sb.magic, PHX_EXTENT_MAGIC, PHX_EXTENT_MAGIC_LEN);
+    sb.version = PHX_EXTENT_VERSION;
+    sb.reserved = 0;
+    sb.generation = ++generation;
+    sb.first_lba = first_lba;
+    sb.sectors = sectors;
+    sb.session = session_id;
+    sb.session_start = session_start;
+    sb.next = next_block;
+    sb.crc = phxCrc32((const uint8_t *)&sb, offsetof(ExtentSuper, crc));
+
+    memset(sector, 0, sizeof(sector));
+    memcpy(sector, &sb, sizeof(sb));
+    // alternate copies: a torn write leaves the other one, one generation older
+    if(!dev->writeSector(first_lba + (generation & 1), sector)) {
+        stat.write_errors++;
+        return false;
+    }
+    stat.super_writes++;
+    synced = next_block;
+    return true;
+}
+
+/**
+ * @brief stamps the header and CRC into `block` and writes it as the next sector
+ * @param block one sector; the payload starts after the ExtentBlockHeader
+ * @param used payload bytes, PHX_EXTENT_PAYLOAD for all but the last block
+ * @return false if the card refused it or the extent is full
+ *
+ * A refused sector is not skipped: the next append goes to the same
+ * index, so the log never has a hole for recovery to stop at.
+ */
+bool ExtentJournal::append(uint8_t *block, uint16_t used) {
+    if(!dev) {
+        return false;
+    }
+    if(next_block >= capacity()) {
+        stat.full_drops++;
+        return false;
+    }
+    ExtentBlockHeader hdr;
+    hdr.magic = PHX_EXTENT_BLOCK_MAGIC;
+    hdr.seq = next_block;
+    hdr.session = session_id;
+    hdr.used = used;
+    hdr.reserved = 0;
+    memcpy(block, &hdr, sizeof(hdr));
+    const uint32_t crc = phxCrc32(block, PHX_EXTENT_SECTOR - sizeof(crc));
+    memcpy(block + PHX_EXTENT_SECTOR - sizeof(crc), &crc, sizeof(crc));
+
+    if(!dev->writeSector(first_lba + PHX_EXTENT_SUPERS + next_block, block)) {
+        stat.write_errors++;
+        return false;
+    }
+    next_block++;
+    stat.blocks_written++;
+    return true;
+}
+
+/**
+ * @brief records the log's length in the superblock, if it grew since the last call
+ *
+ * One sector write. Recovery works without it; it only shortens the scan.
+ */
+bool ExtentJournal::sync() {
+    if(!dev || next_block == synced) {
+        return true;
+    }
+    return writeSuper();
+}
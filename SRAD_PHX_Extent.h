@@ -0,0 +1,134 @@
+#ifndef SRAD_PHX_EXTENT_H
+#define SRAD_PHX_EXTENT_H
+
+// Raw-sector log in one preallocated, contiguous extent of the card.
+// Appending to a FAT file makes the filesystem find and link a cluster
+// every few kilobytes, and a brownout in the middle of that can take the
+// tail of the file with it. Here the sketch preallocates the file once
+// at boot and the log writes its sectors in order, with no filesystem
+// update in between. No Arduino dependency.
+//
+// Extent layout (all integers little-endian):
+//   sector 0, 1        ExtentSuper, two copies written alternately
+//   sector 2 + i       data block i: ExtentBlockHeader, payload, CRC-32
+//
+// The payloads, in block order, are exactly the bytes a File would have
+// been given, so a recovered log decodes like any other.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PHX_EXTENT_SECTOR       512
+#define PHX_EXTENT_MAGIC        "PHXEXT"
+#define PHX_EXTENT_MAGIC_LEN    6
+#define PHX_EXTENT_VERSION      1
+#define PHX_EXTENT_BLOCK_MAGIC  0x4B4C4250  // "PBLK"
+#define PHX_EXTENT_SUPERS       2           // sectors before the first data block
+
+struct __attribute__((packed)) ExtentSuper {
+    char magic[PHX_EXTENT_MAGIC_LEN];       // PHX_EXTENT_MAGIC, not null terminated
+    uint8_t version;                        // PHX_EXTENT_VERSION
+    uint8_t reserved;
+    uint32_t generation;                    // bumped on every write; the newer valid copy wins
+    uint32_t first_lba;                     // where the extent was when this was written
+    uint32_t sectors;                       // extent length, superblocks included
+    uint32_t session;                       // id every block of the current session carries
+    uint32_t session_start;                 // first block of the current session
+    uint32_t next;                          // every block before this one is known written
+    uint32_t crc;                           // CRC-32 of everything above
+};
+
+struct __attribute__((packed)) ExtentBlockHeader {
+    uint32_t magic;                         // PHX_EXTENT_BLOCK_MAGIC
+    uint32_t seq;                           // block index in the extent
+    uint32_t session;                       // ExtentSuper::session when it was written
+    uint16_t used;                          // payload bytes, less than PHX_EXTENT_PAYLOAD only in the last block
+    uint16_t reserved;
+};
+
+#define PHX_EXTENT_PAYLOAD (PHX_EXTENT_SECTOR - sizeof(ExtentBlockHeader) - sizeof(uint32_t))
+
+/**
+ * @brief sector access to the card, or to an image of it
+ *
+ * The same calls as SdFat's block devices, so on a Teensy the adapter is
+ * two lines around `SD.sdfs.card()`.
+ */
+class BlockDevice {
+    public:
+        virtual ~BlockDevice() {}
+        virtual bool readSector(uint32_t lba, uint8_t *dst) = 0;
+        virtual bool writeSector(uint32_t lba, const uint8_t *src) = 0;
+};
+
+/**
+ * @brief where the log ends, as found by recoverExtent()
+ */
+struct ExtentRecovery {
+    uint32_t generation;                    // of the superblock it started from
+    uint32_t session;
+    uint32_t session_start;
+    uint32_t super_next;                    // the superblock's `next`
+    uint32_t end;                           // first block that is not part of the log
+    uint32_t scanned;                       // blocks read past super_next to find it
+};
+
+struct ExtentStats {
+    uint32_t blocks_written;                // data sectors the card accepted
+    uint32_t super_writes;                  // superblock updates
+    uint32_t write_errors;                  // sectors the card refused, retried at the same index
+    uint32_t full_drops;                    // blocks dropped because the extent was full
+    uint32_t recovered;                     // blocks begin() found past the superblock
+};
+
+/**
+ * @brief appends CRC-checked sectors to an extent and keeps its superblock
+ *
+ * Every append is exactly one sector write, so its worst case is the
+ * card's worst single-sector write; nothing allocates and nothing reads.
+ * The superblock only moves when sync() is called, which SectorLogger
+ * does at its flush interval and never while realtime. A power loss
+ * costs at most the sector being written: recoverExtent() starts at the
+ * superblock and walks forward while blocks have the session, the index
+ * and a good CRC.
+ */
+class ExtentJournal {
+    public:
+        ExtentJournal();
+
+        bool begin(BlockDevice &, uint32_t first_lba, uint32_t sectors, uint32_t nonce);
+        bool append(uint8_t *block, uint16_t used);
+        bool sync();
+
+        uint32_t next() const { return next_block; }
+        uint32_t capacity() const { return sectors > PHX_EXTENT_SUPERS ? sectors - PHX_EXTENT_SUPERS : 0; }
+        uint32_t session() const { return session_id; }
+        const ExtentStats& stats() const { return stat; }
+
+    private:
+        bool writeSuper();
+
+        BlockDevice *dev;
+        uint32_t first_lba;
+        uint32_t sectors;
+        uint32_t session_id;
+        uint32_t session_start;
+        uint32_t next_block;
+        uint32_t synced;                    // next_block as of the last superblock
+        uint32_t generation;
+        uint8_t sector[PHX_EXTENT_SECTOR];  // superblock and recovery scratch
+
+        ExtentStats stat;
+};
+
+// CRC-32 (IEEE 802.3, as zlib), continuing from `crc`
+uint32_t phxCrc32(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+// True if `sector` is a data block with a good CRC for index `seq`; fills `hdr`.
+bool extentBlockValid(const uint8_t *sector, uint32_t seq, ExtentBlockHeader &hdr);
+
+// Finds the end of the log. False if neither superblock is valid for
+// this extent. `scratch` is one sector.
+bool recoverExtent(BlockDevice &, uint32_t first_lba, uint32_t sectors, ExtentRecovery &, uint8_t *scratch);
+
+#endif
@@ -0,0 +1,211 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+
+#include "SRAD_PHX_Fifo.h"
+
+#define LSM6DSO32_BURST_WORDS 36            // stack buffer, 252 bytes
+
+bool WireBus::readRegs(uint8_t reg, uint8_t *buf, size_t n) {
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    if(wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if(wire.requestFrom(addr, (uint8_t)n) != n) {
+        return false;
+    }
+    for(size_t i = 0; i < n; i++) {
+        buf[i] = wire.read();
+    }
+    return true;
+}
+
+bool WireBus::writeReg(uint8_t reg, uint8_t value) {
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    wire.write(value);
+    return wire.endTransmission() == 0;
+}
+
+static int16_t le16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+// Starts a new drain: the previous samples are numbered, then forgotten.
+static void beginBatch(SampleBatch &b) {
+    b.first_seq += b.count;
+    b.count = 0;
+}
+
+// Spaces the batch one period apart, ending at the read.
+static void stampBatch(SampleBatch &b, uint32_t now_us, uint32_t period_us) {
+    for(uint16_t i = 0; i < b.count; i++) {
+        b.sample[i].time_us = now_us - (uint32_t)(b.count - 1 - i) * period_us;
+    }
+}
+
+/**
+ * @brief picks the lowest data rate code at or above `hz`
+ */
+static uint8_t lsmRateCode(uint16_t hz, uint32_t &period_us) {
+    static const uint16_t RATES[] = { 104, 208, 416, 833, 1666, 3332, 6667 };
+    uint8_t i = 0;
+    while(i < 6 && RATES[i] < hz) {
+        i++;
+    }
+    period_us = 1000000UL / RATES[i];
+    return 4 + i;                           // 0x4 is 104 Hz
+}
+
+bool LSM6DSO32Fifo::begin(uint16_t odr_hz) {
+    uint8_t id;
+    if(!bus.readRegs(LSM6DSO32_WHO_AM_I, &id, 1) || id != LSM6DSO32_WHO_AM_I_VALUE) {
+        return false;
+    }
+    uint8_t odr = lsmRateCode(odr_hz, period_us);
+    temp = NAN;
+    return bus.writeReg(LSM6DSO32_CTRL3_C, 0x44)                // BDU, IF_INC
+        && bus.writeReg(LSM6DSO32_CTRL1_XL, odr << 4 | 0x04)    // FS_XL = 01, +/-32 g
+        && bus.writeReg(LSM6DSO32_CTRL2_G, odr << 4 | 0x0C)     // FS_G = 11, +/-2000 dps
+        && bus.writeReg(LSM6DSO32_FIFO_CTRL4, 0x00)             // bypass empties the FIFO
+        && bus.writeReg(LSM6DSO32_FIFO_CTRL3, odr << 4 | odr)
+        && bus.writeReg(LSM6DSO32_FIFO_CTRL4, 0x20 | 0x06);     // temperature 12.5 Hz, continuous
+}
+
+/**
+ * @brief empties the FIFO into `b`
+ * @return false if a bus transfer failed
+ *
+ * Gyro and accelerometer words are written at the same rate; a sample
+ * is completed by each accelerometer word with the gyro word before it.
+ * Once the batch is full no further bursts are started, so unread words
+ * stay in the FIFO for the next drain.
+ */
+bool LSM6DSO32Fifo::drain(SampleBatch &b, uint32_t now_us) {
+    beginBatch(b);
+
+    uint8_t status[2];
+    b.bursts++;
+    if(!bus.readRegs(LSM6DSO32_FIFO_STATUS1, status, 2)) {
+        return false;
+    }
+    uint16_t words = status[0] | (status[1] & 0x03) << 8;
+    if(status[1] & 0x40) {
+        b.overruns++;
+    }
+
+    size_t per_burst = bus.maxRead() / LSM6DSO32_FIFO_WORD;
+    if(per_burst > LSM6DSO32_BURST_WORDS) per_burst = LSM6DSO32_BURST_WORDS;
+    if(per_burst < 1) per_burst = 1;
+
+    uint8_t buf[LSM6DSO32_BURST_WORDS * LSM6DSO32_FIFO_WORD];
+    while(words && b.count < PHX_SAMPLE_BATCH_MAX) {
+        size_t n = words < per_burst ? words : per_burst;
+        b.bursts++;
+        if(!bus.readRegs(LSM6DSO32_FIFO_DATA_OUT_TAG, buf, n * LSM6DSO32_FIFO_WORD)) {
+            return false;
+        }
+        words -= n;
+
+        for(size_t w = 0; w < n; w++) {
+            const uint8_t *p = buf + w * LSM6DSO32_FIFO_WORD;
+            switch(p[0] >> 3) {
+                case LSM6DSO32_TAG_GYRO:
+                    for(int i = 0; i < 3; i++) {
+                        gyro[i] = le16(p + 1 + 2 * i) * LSM6DSO32_GYRO_RADS_PER_LSB;
+                    }
+                    break;
+                case LSM6DSO32_TAG_ACC:
+                    if(b.count == PHX_SAMPLE_BATCH_MAX) {
+                        b.dropped++;
+                        break;
+                    }
+                    for(int i = 0; i < 3; i++) {
+                        b.sample[b.count].acc[i] = le16(p + 1 + 2 * i) * LSM6DSO32_ACC_MS2_PER_LSB;
+                        b.sample[b.count].gyro[i] = gyro[i];
+                    }
+                    b.count++;
+                    break;
+                case LSM6DSO32_TAG_TEMP:
+                    temp = le16(p + 1) / 256.0f + 25.0f;
+                    break;
+            }
+        }
+    }
+
+    stampBatch(b, now_us, period_us);
+    return true;
+}
+
+bool ADXL375Fifo::begin(uint16_t odr_hz) {
+    uint8_t id;
+    if(!bus.readRegs(ADXL375_DEVID, &id, 1) || id != ADXL375_DEVID_VALUE) {
+        return false;
+    }
+    uint8_t rate = 0x0A;                    // 100 Hz, doubling per step to 3200 Hz
+    uint16_t hz = 100;
+    while(rate < 0x0F && hz < odr_hz) {
+        rate++;
+        hz *= 2;
+    }
+    period_us = 1000000UL / hz;
+    return bus.writeReg(ADXL375_POWER_CTL, 0x00)
+        && bus.writeReg(ADXL375_BW_RATE, rate)
+        && bus.writeReg(ADXL375_DATA_FORMAT, 0x0B)
+        && bus.writeReg(ADXL375_FIFO_CTL, 0x00)                 // bypass empties the FIFO
+        && bus.writeReg(ADXL375_FIFO_CTL, 0x80)                 // stream
+        && bus.writeReg(ADXL375_POWER_CTL, 0x08);               // measure
+}
+
+/**
+ * @brief empties the FIFO into `b`
+ * @return false if a bus transfer failed
+ *
+ * A full FIFO may have overwritten samples, so only then is INT_SOURCE
+ * read to count the overrun.
+ */
+bool ADXL375Fifo::drain(SampleBatch &b, uint32_t now_us) {
+    beginBatch(b);
+
+    uint8_t entries;
+    b.bursts++;
+    if(!bus.readRegs(ADXL375_FIFO_STATUS, &entries, 1)) {
+        return false;
+    }
+    entries &= 0x3F;
+    if(entries >= ADXL375_FIFO_DEPTH) {
+        uint8_t source;
+        b.bursts++;
+        if(!bus.readRegs(ADXL375_INT_SOURCE, &source, 1)) {
+            return false;
+        }
+        if(source & 0x01) {
+            b.overruns++;
+        }
+    }
+
+    while(entries-- && b.count < PHX_SAMPLE_BATCH_MAX) {
+        uint8_t raw[6];
+        b.bursts++;
+        if(!bus.readRegs(ADXL375_DATAX0, raw, 6)) {
+            return false;
+        }
+        ImuSample &s = b.sample[b.count++];
+        for(int i = 0; i < 3; i++) {
+            s.acc[i] = le16(raw + 2 * i) * ADXL375_ACC_MS2_PER_LSB;
+            s.gyro[i] = NAN;
+        }
+    }
+
+    stampBatch(b, now_us, period_us);
+    return true;
+}
@@ -0,0 +1,162 @@
+#ifndef SRAD_PHX_FIFO_H
+#define SRAD_PHX_FIFO_H
+
+// Batched acquisition from the on-chip FIFOs of the LSM6DSO32 and the
+// ADXL375. The drivers talk to the chips through RegisterBus, so the
+// same code runs against Wire on the board and against register-level
+// stand-ins on Linux (extras/sil/sil_regdev.h).
+//
+// Each drain() empties the FIFO into a SampleBatch, oldest first. A
+// sample's time is reconstructed from the read time and the output data
+// rate: the newest sample is taken as produced at the read, each older
+// one a period before it.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Wire.h>
+
+#ifndef PHX_SAMPLE_BATCH_MAX
+#define PHX_SAMPLE_BATCH_MAX 32             // samples kept per sensor per drain
+#endif
+#ifndef PHX_WIRE_MAX_READ
+#define PHX_WIRE_MAX_READ 32                // bytes per Wire.requestFrom on this core
+#endif
+
+#define LSM6DSO32_WHO_AM_I_VALUE 0x6C
+#define LSM6DSO32_FIFO_WORD 7               // tag byte + 3 x int16
+#define LSM6DSO32_ACC_MS2_PER_LSB (0.000976f * 9.80665f)   // +/-32 g
+#define LSM6DSO32_GYRO_RADS_PER_LSB (0.070f * 0.017453293f) // +/-2000 dps
+
+#define ADXL375_DEVID_VALUE 0xE5
+#define ADXL375_FIFO_DEPTH 32
+#define ADXL375_ACC_MS2_PER_LSB (0.049f * 9.80665f)
+
+enum LSM6DSO32_REG : uint8_t {
+    LSM6DSO32_FIFO_CTRL3 = 0x09,            // BDR_GY[7:4] BDR_XL[3:0]
+    LSM6DSO32_FIFO_CTRL4 = 0x0A,            // ODR_T_BATCH[5:4] FIFO_MODE[2:0]
+    LSM6DSO32_WHO_AM_I = 0x0F,
+    LSM6DSO32_CTRL1_XL = 0x10,
+    LSM6DSO32_CTRL2_G = 0x11,
+    LSM6DSO32_CTRL3_C = 0x12,
+    LSM6DSO32_FIFO_STATUS1 = 0x3A,          // DIFF_FIFO[7:0]
+    LSM6DSO32_FIFO_STATUS2 = 0x3B,          // FIFO_OVR_IA bit 6, DIFF_FIFO[9:8]
+    LSM6DSO32_FIFO_DATA_OUT_TAG = 0x78,     // reads past 0x7E roll back here
+};
+
+enum LSM6DSO32_TAG : uint8_t {
+    LSM6DSO32_TAG_GYRO = 0x01,
+    LSM6DSO32_TAG_ACC = 0x02,
+    LSM6DSO32_TAG_TEMP = 0x03,
+};
+
+enum ADXL375_REG : uint8_t {
+    ADXL375_DEVID = 0x00,
+    ADXL375_BW_RATE = 0x2C,
+    ADXL375_POWER_CTL = 0x2D,
+    ADXL375_INT_SOURCE = 0x30,              // OVERRUN bit 0
+    ADXL375_DATA_FORMAT = 0x31,
+    ADXL375_DATAX0 = 0x32,                  // 6 bytes; reading them pops one FIFO entry
+    ADXL375_FIFO_CTL = 0x38,
+    ADXL375_FIFO_STATUS = 0x39,             // ENTRIES[5:0]
+};
+
+/**
+ * @brief register access to one chip
+ *
+ * readRegs() is one bus transaction starting at `reg`; the chip's own
+ * auto-increment decides which registers follow.
+ */
+class RegisterBus {
+    public:
+        virtual ~RegisterBus() {}
+        virtual bool readRegs(uint8_t reg, uint8_t *buf, size_t n) = 0;
+        virtual bool writeReg(uint8_t reg, uint8_t value) = 0;
+        virtual size_t maxRead() const { return 255; }
+};
+
+/**
+ * @brief RegisterBus on an I2C port
+ */
+class WireBus : public RegisterBus {
+    public:
+        WireBus(TwoWire &w, uint8_t address) : wire(w), addr(address) {}
+
+        bool readRegs(uint8_t reg, uint8_t *buf, size_t n) override;
+        bool writeReg(uint8_t reg, uint8_t value) override;
+        size_t maxRead() const override { return PHX_WIRE_MAX_READ; }
+
+    private:
+        TwoWire &wire;
+        uint8_t addr;
+};
+
+struct ImuSample {
+    uint32_t time_us;                       // reconstructed, micros() time base
+    float acc[3];                           // m/s^2
+    float gyro[3];                          // rad/s, NAN for the ADXL375
+};
+
+/**
+ * @brief the samples of one drain, oldest first
+ *
+ * `first_seq` numbers the first sample in a count that runs over the
+ * whole flight, so a consumer that remembers the next number it wants
+ * skips samples it already saw when the batch was not refilled.
+ */
+struct SampleBatch {
+    ImuSample sample[PHX_SAMPLE_BATCH_MAX];
+    uint16_t count;
+    uint32_t first_seq;
+    uint32_t overruns;                      // FIFO overflowed before a drain (events)
+    uint32_t dropped;                       // samples read that did not fit the batch
+    uint32_t bursts;                        // bus transactions spent draining
+};
+
+/**
+ * @brief LSM6DSO32 accelerometer and gyro through its FIFO
+ *
+ * begin() sets +/-32 g and +/-2000 dps, batches both at the output data
+ * rate and the temperature at 12.5 Hz, in continuous mode. drain() reads
+ * the FIFO word count, then as many whole words per transaction as the
+ * bus allows.
+ */
+class LSM6DSO32Fifo {
+    public:
+        LSM6DSO32Fifo(RegisterBus &b) : bus(b) {}
+
+        bool begin(uint16_t odr_hz = 833);
+        bool drain(SampleBatch &, uint32_t now_us);
+
+        uint32_t period() const { return period_us; }
+        float temperature() const { return temp; }
+
+    private:
+        RegisterBus &bus;
+        uint32_t period_us = 0;
+        float gyro[3] = {0, 0, 0};          // latest gyro word, paired with the next accel word
+        float temp = 0;
+};
+
+/**
+ * @brief ADXL375 accelerometer through its FIFO
+ *
+ * The ADXL375 pops one entry per read of its data registers, so after
+ * the entry count each sample is its own 6-byte burst. It has no
+ * temperature sensor.
+ */
+class ADXL375Fifo {
+    public:
+        ADXL375Fifo(RegisterBus &b) : bus(b) {}
+
+        bool begin(uint16_t odr_hz = 800);
+        bool drain(SampleBatch &, uint32_t now_us);
+
+        uint32_t period() const { return period_us; }
+
+    private:
+        RegisterBus &bus;
+        uint32_t period_us = 0;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+
+#include "SRAD_PHX_Format.h"
+
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint32_t POW10[PHX_FORMAT_MAX_DIGITS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+ * @brief writes the last `width` digits of `v` right to left ending at `end`
+ */
+static void digitsBackward(char *end, uint32_t v, uint8_t width) {
+    while(width >= 2) {
+        uint32_t q = v / 100;
+        const char *d = &DIGIT_PAIRS[(v - q * 100) * 2];
+        *--end = d[1];
+        *--end = d[0];
+        v = q;
+        width -= 2;
+    }
+    if(width) {
+        *--end = '0' + v % 10;
+    }
+}
+
+static uint8_t digitCount(uint32_t v) {
+    uint8_t n = 1;
+    while(n < 10 && v >= POW10[n]) {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief decimal text of `v`, two digits per division
+ */
+size_t phxFormatU32(char *out, uint32_t v) {
+    uint8_t n = digitCount(v);
+    digitsBackward(out + n, v, n);
+    return n;
+}
+
+size_t phxFormatU64(char *out, uint64_t v) {
+    if(v <= 0xFFFFFFFFu) {
+        return phxFormatU32(out, (uint32_t)v);
+    }
+    // split into a high part and a zero-padded low 9 digits
+    uint64_t high = v / 1000000000u;
+    uint32_t low = (uint32_t)(v - high * 1000000000u);
+    size_t n = phxFormatU64(out, high);
+    digitsBackward(out + n + 9, low, 9);
+    return n + 9;
+}
+
+/**
+ * @brief fixed-point text of `v` with `digits` decimals
+ *
+ * Same text as Arduino's Print::printFloat for the same arguments
+ * (including "nan", "inf" and "ovf"), but the fraction is scaled and
+ * rounded once in fixed point instead of peeled off one double
+ * multiply per digit. The only differences are values that sit
+ * exactly halfway in binary (e.g. 1.484375 to 5 places), which are
+ * always rounded up here; printFloat's double error sends them
+ * either way.
+ */
+size_t phxFormatFloat(char *out, float v, uint8_t digits) {
+    if(isnan(v)) { memcpy(out, "nan", 3); return 3; }
+    if(isinf(v)) { memcpy(out, "inf", 3); return 3; }
+    if(v > 4294967040.0f || v < -4294967040.0f) { memcpy(out, "ovf", 3); return 3; }
+    if(digits > PHX_FORMAT_MAX_DIGITS) {
+        digits = PHX_FORMAT_MAX_DIGITS;
+    }
+
+    char *p = out;
+    if(v < 0) {
+        *p++ = '-';
+        v = -v;
+    }
+
+    // the fraction of a float is exact after removing the integer part, and
+    // exact again as 0.32 fixed point for any value print would show digits of;
+    // scaling it is then one integer multiply
+    uint32_t int_part = (uint32_t)v;
+    uint64_t fixed = (uint64_t)((v - (float)int_part) * 4294967296.0f);
+    uint64_t scaled = fixed * POW10[digits];
+    uint32_t frac = (uint32_t)(scaled >> 32);
+    if((uint32_t)scaled >= 0x80000000u) {   // round half up
+        frac++;
+    }
+    if(frac >= POW10[digits]) {
+        frac -= POW10[digits];
+        int_part++;
+    }
+
+    p += phxFormatU32(p, int_part);
+    if(digits) {
+        *p++ = '.';
+        digitsBackward(p + digits, frac, digits);
+        p += digits;
+    }
+    return p - out;
+}
@@ -0,0 +1,82 @@
+#ifndef SRAD_PHX_FORMAT_H
+#define SRAD_PHX_FORMAT_H
+
+// Integer/fixed-point number formatting into a caller's buffer. Used to
+// render whole rows before a single write(); no Arduino dependency, so
+// the host decoder produces the same text.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef PHX_CSV_LINE_MAX
+#define PHX_CSV_LINE_MAX 1024               // one writeSD/writeSERIAL row
+#endif
+#ifndef PHX_DEBUG_LINE_MAX
+#define PHX_DEBUG_LINE_MAX 2048             // one writeDEBUG block
+#endif
+
+#define PHX_FORMAT_MAX_DIGITS 9             // more precision is clamped
+#define PHX_FORMAT_FLOAT_MAX (1 + 10 + 1 + PHX_FORMAT_MAX_DIGITS)
+#define PHX_FORMAT_U64_MAX 20
+
+// Each writes at most the _MAX above, without a terminator, and returns the length.
+size_t phxFormatU32(char *out, uint32_t v);
+size_t phxFormatU64(char *out, uint64_t v);
+size_t phxFormatFloat(char *out, float v, uint8_t digits);
+
+/**
+ * @brief fixed-capacity text line with Print-style print()/println()
+ *
+ * Satisfies the `Out` interface of the schema printers, so
+ * `printCsvRow(line, rec)` renders a row without a single virtual call.
+ * Text that does not fit is dropped and `overflowed()` is set.
+ */
+template <size_t N>
+class LineBuffer {
+    public:
+        LineBuffer() : len(0), overflow(false) {}
+
+        void clear() { len = 0; overflow = false; }
+
+        void print(const char *s) { append(s, strlen(s)); }
+        void print(char c) { append(&c, 1); }
+        void print(double v, int digits = 2) { print((float)v, digits); }
+        void print(float v, int digits = 2) {
+            if(room(PHX_FORMAT_FLOAT_MAX)) len += phxFormatFloat(buf + len, v, digits);
+        }
+        void print(unsigned v) {
+            if(room(10)) len += phxFormatU32(buf + len, v);
+        }
+        void print(unsigned long v) { print((unsigned long long)v); }
+        void print(unsigned long long v) {
+            if(room(PHX_FORMAT_U64_MAX)) len += phxFormatU64(buf + len, v);
+        }
+        void println() { append("\r\n", 2); }
+
+        const char *data() const { return buf; }
+        const uint8_t *bytes() const { return (const uint8_t *)buf; }
+        size_t length() const { return len; }
+        bool overflowed() const { return overflow; }
+
+    private:
+        bool room(size_t n) {
+            if(len + n > N) {
+                overflow = true;
+                return false;
+            }
+            return true;
+        }
+        void append(const char *s, size_t n) {
+            if(room(n)) {
+                memcpy(buf + len, s, n);
+                len += n;
+            }
+        }
+
+        char buf[N];
+        size_t len;
+        bool overflow;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+
+#include "SRAD_PHX_Health.h"
+
+void HealthMonitor::reset() {
+    memset(h, 0, sizeof(h));
+    no_backoff = 1 << SENSOR_GPS;           // a lost fix is not a bus problem; the UART read never blocks
+}
+
+void HealthMonitor::setBackoff(uint8_t sensor, bool allowed) {
+    if(allowed) {
+        no_backoff &= ~(1 << sensor);
+    } else {
+        no_backoff |= 1 << sensor;
+    }
+}
+
+/**
+ * @brief false while `sensor` is backed off and its retry time has not come
+ */
+bool HealthMonitor::due(uint8_t sensor, uint32_t now_ms) {
+    SensorHealth &s = h[sensor];
+    if(s.state != HEALTH_BACKOFF) {
+        return true;
+    }
+    if((int32_t)(now_ms - s.retry_ms) >= 0) {
+        if(s.retries < UINT16_MAX) {
+            s.retries++;
+        }
+        return true;
+    }
+    s.skipped++;
+    return false;
+}
+
+/**
+ * @brief counts one attempt and moves the sensor between SENSOR_HEALTH states
+ * @return true if the state changed
+ */
+bool HealthMonitor::record(uint8_t sensor, bool ok, uint32_t latency_us, uint32_t now_ms) {
+    SensorHealth &s = h[sensor];
+    const uint8_t before = s.state;
+    const bool slow = latency_us > PHX_HEALTH_SLOW_US;
+
+    s.reads++;
+    s.last_us = latency_us;
+    s.max_us = latency_us > s.max_us ? (latency_us > UINT16_MAX ? UINT16_MAX : latency_us) : s.max_us;
+    s.mean_us += ((float)latency_us - s.mean_us) * 0.125f;
+    if(!ok) {
+        s.errors++;
+    }
+    if(slow) {
+        s.slow++;
+    }
+    // a slow read still returned data: it can degrade the sensor, never back it off
+    s.history = s.history << 1 | (!ok || slow ? 1 : 0);
+    if(ok) {
+        s.consecutive = 0;
+    } else if(s.consecutive < UINT16_MAX) {
+        s.consecutive++;
+    }
+
+    if(!ok && s.consecutive >= PHX_HEALTH_FAIL_AFTER && !(no_backoff & (1 << sensor))) {
+        if(!s.backoff_ms) {
+            s.backoff_ms = PHX_HEALTH_BACKOFF_MIN_MS;
+        } else if(s.backoff_ms < PHX_HEALTH_BACKOFF_MAX_MS) {
+            s.backoff_ms = s.backoff_ms * 2 < PHX_HEALTH_BACKOFF_MAX_MS ? s.backoff_ms * 2 : PHX_HEALTH_BACKOFF_MAX_MS;
+        }
+        s.retry_ms = now_ms + s.backoff_ms;
+        s.state = HEALTH_BACKOFF;
+    } else {
+        s.backoff_ms = 0;
+        s.state = s.consecutive || slow || __builtin_popcount(s.history) >= PHX_HEALTH_DEGRADED_READS
+                ? HEALTH_DEGRADED : HEALTH_OK;
+    }
+    return s.state != before;
+}
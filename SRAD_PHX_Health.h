@@ -0,0 +1,93 @@
+#ifndef SRAD_PHX_HEALTH_H
+#define SRAD_PHX_HEALTH_H
+
+// Per-sensor failure, latency and back-off bookkeeping behind the read_*
+// functions. A sensor that keeps failing stops being read every tick and
+// is retried on a doubling interval instead, so a hung bus device cannot
+// eat the loop. One that is only slow is marked degraded. No Arduino
+// dependency.
+
+#include <stdint.h>
+
+// Health tracking; override with -D.
+#ifndef PHX_HEALTH_FAIL_AFTER
+#define PHX_HEALTH_FAIL_AFTER 5             // failed reads in a row before a sensor is backed off
+#endif
+#ifndef PHX_HEALTH_BACKOFF_MIN_MS
+#define PHX_HEALTH_BACKOFF_MIN_MS 20        // first retry interval
+#endif
+#ifndef PHX_HEALTH_BACKOFF_MAX_MS
+#define PHX_HEALTH_BACKOFF_MAX_MS 2000      // the interval stops doubling here
+#endif
+#ifndef PHX_HEALTH_SLOW_US
+#define PHX_HEALTH_SLOW_US 2000             // a read longer than this degrades the sensor; its data is kept
+#endif
+#ifndef PHX_HEALTH_DEGRADED_READS
+#define PHX_HEALTH_DEGRADED_READS 2         // bad reads among the last 32 that mark a sensor degraded
+#endif
+
+// sensorStatus bit of each sensor
+enum SENSOR_ID : uint8_t {
+    SENSOR_LSM = 0,
+    SENSOR_BMP,
+    SENSOR_ADXL,
+    SENSOR_BNO,
+    SENSOR_GPS,
+    SENSOR_COUNT
+};
+
+enum SENSOR_HEALTH : uint8_t {
+    HEALTH_OK = 0,                          // no recent bad reads
+    HEALTH_DEGRADED = 1,                    // failing or slow now, or PHX_HEALTH_DEGRADED_READS of the last 32
+    HEALTH_BACKOFF = 2,                     // PHX_HEALTH_FAIL_AFTER in a row: read only on retries
+};
+
+/**
+ * @brief one sensor's counters, as published in FlightData::health
+ */
+struct SensorHealth {
+    uint32_t reads;                         // attempts, retries included
+    uint32_t errors;                        // attempts that failed
+    uint32_t slow;                          // attempts over PHX_HEALTH_SLOW_US
+    uint32_t skipped;                       // reads not attempted while backed off
+    uint32_t history;                       // one bit per attempt, newest in bit 0, set if bad
+    uint32_t last_us;                       // latency of the last attempt
+    float mean_us;                          // latency, 1/8 moving average
+    uint16_t max_us;                        // worst latency, saturates at 65535
+    uint16_t consecutive;                   // failed attempts in a row
+    uint16_t retries;                       // attempts made at the end of a back-off
+    uint16_t backoff_ms;                    // current retry interval, 0 when not backed off
+    uint32_t retry_ms;                      // millis() of the next retry
+    uint8_t state;                          // SENSOR_HEALTH
+};
+
+/**
+ * @brief decides which sensors are read this tick and keeps their SensorHealth
+ *
+ * Each read_* asks due() first and reports the outcome and latency to
+ * record() after. A sensor with PHX_HEALTH_FAIL_AFTER failed attempts in
+ * a row goes to HEALTH_BACKOFF; due() is then false until the retry time,
+ * and each failed retry doubles the interval up to
+ * PHX_HEALTH_BACKOFF_MAX_MS. The first good attempt ends the back-off.
+ * A slow attempt returned data, so it only degrades the sensor.
+ * Sensors excluded with setBackoff() are tracked but always due.
+ */
+class HealthMonitor {
+    public:
+        HealthMonitor() { reset(); }
+
+        void reset();
+        void setBackoff(uint8_t sensor, bool allowed);
+        bool due(uint8_t sensor, uint32_t now_ms);
+        bool record(uint8_t sensor, bool ok, uint32_t latency_us, uint32_t now_ms);
+
+        bool retrying(uint8_t sensor) const { return h[sensor].state == HEALTH_BACKOFF; }
+        uint8_t state(uint8_t sensor) const { return h[sensor].state; }
+        const SensorHealth& operator[](uint8_t sensor) const { return h[sensor]; }
+
+    private:
+        SensorHealth h[SENSOR_COUNT];
+        uint8_t no_backoff;                 // bit per SENSOR_ID
+};
+
+#endif
@@ -0,0 +1,227 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <Arduino.h>
+
+#include "SRAD_PHX_Isr.h"
+
+#define LSM_BURST 14                        // OUT_TEMP_L .. OUTZ_H_A
+#define ADXL_BURST 6
+
+DrdyAcquisition *DrdyAcquisition::active = nullptr;
+
+static int16_t le16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief configures both chips and attaches the data-ready interrupts
+ * @return false if either chip did not answer
+ *
+ * The LSM6DSO32 pulses INT1 for every accelerometer sample; the gyro
+ * runs at the same rate and is read with it. The ADXL375 holds INT1
+ * high until its data registers are read, see rearm().
+ */
+bool DrdyAcquisition::begin(uint8_t lsm_int, uint8_t adxl_int, uint16_t lsm_hz, uint16_t adxl_hz) {
+    uint8_t id;
+    if(!lsm_bus.readRegs(LSM6DSO32_WHO_AM_I, &id, 1) || id != LSM6DSO32_WHO_AM_I_VALUE) {
+        return false;
+    }
+    uint8_t odr = 4;                        // 104 Hz, doubling per step to 6667 Hz
+    for(uint32_t hz = 104; odr < 10 && hz < lsm_hz; hz *= 2) {
+        odr++;
+    }
+    bool ok = lsm_bus.writeReg(LSM6DSO32_CTRL3_C, 0x44)        // BDU, IF_INC
+        && lsm_bus.writeReg(LSM6DSO32_FIFO_CTRL4, 0x00)          // FIFO bypass
+        && lsm_bus.writeReg(LSM6DSO32_COUNTER_BDR_REG1, 0x80)    // dataready_pulsed
+        && lsm_bus.writeReg(LSM6DSO32_CTRL1_XL, odr << 4 | 0x04) // +/-32 g
+        && lsm_bus.writeReg(LSM6DSO32_CTRL2_G, odr << 4 | 0x0C)  // +/-2000 dps
+        && lsm_bus.writeReg(LSM6DSO32_INT1_CTRL, 0x01);          // INT1_DRDY_XL
+    if(!ok) {
+        return false;
+    }
+
+    if(!adxl_bus.readRegs(ADXL375_DEVID, &id, 1) || id != ADXL375_DEVID_VALUE) {
+        return false;
+    }
+    uint8_t rate = 0x0A;                    // 100 Hz, doubling per step to 3200 Hz
+    for(uint32_t hz = 100; rate < 0x0F && hz < adxl_hz; hz *= 2) {
+        rate++;
+    }
+    ok = adxl_bus.writeReg(ADXL375_POWER_CTL, 0x00)
+        && adxl_bus.writeReg(ADXL375_BW_RATE, rate)
+        && adxl_bus.writeReg(ADXL375_DATA_FORMAT, 0x0B)
+        && adxl_bus.writeReg(ADXL375_FIFO_CTL, 0x00)             // bypass
+        && adxl_bus.writeReg(ADXL375_INT_MAP, 0x00)              // everything on INT1
+        && adxl_bus.writeReg(ADXL375_INT_ENABLE, 0x80)           // DATA_READY
+        && adxl_bus.writeReg(ADXL375_POWER_CTL, 0x08);           // measure
+    if(!ok) {
+        return false;
+    }
+
+    lsm_pin = lsm_int;
+    adxl_pin = adxl_int;
+    bus_holds = 0;
+    pending = 0;
+    active = this;
+    pinMode(lsm_pin, INPUT);
+    pinMode(adxl_pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(lsm_pin), lsmIsr, RISING);
+    attachInterrupt(digitalPinToInterrupt(adxl_pin), adxlIsr, RISING);
+    rearm();
+    return true;
+}
+
+void DrdyAcquisition::end() {
+    if(active != this) {
+        return;
+    }
+    detachInterrupt(digitalPinToInterrupt(lsm_pin));
+    detachInterrupt(digitalPinToInterrupt(adxl_pin));
+    active = nullptr;
+}
+
+/**
+ * @brief services a data-ready line that is already high
+ *
+ * The ADXL375's DATA_READY is a level: if its edge arrived while
+ * interrupts were off (or before attachInterrupt), the line stays high
+ * and no further edge comes. Call from the loop now and then; it reads
+ * the pending sample with interrupts masked so it cannot race the ISR.
+ */
+void DrdyAcquisition::rearm() {
+    if(active != this) {
+        return;
+    }
+    noInterrupts();
+    if(digitalRead(adxl_pin) == HIGH) {
+        adxlReady();
+    }
+    interrupts();
+}
+
+/**
+ * @brief ISR body: one LSM6DSO32 sample into the queue, or pending if the loop holds the bus
+ */
+void DrdyAcquisition::lsmReady() {
+    const uint32_t t = micros();
+    if(bus_holds) {
+        defer(RAW_LSM, t);
+        return;
+    }
+    readLsm(t);
+}
+
+/**
+ * @brief ISR body: one ADXL375 sample into the queue, or pending if the loop holds the bus
+ */
+void DrdyAcquisition::adxlReady() {
+    const uint32_t t = micros();
+    if(bus_holds) {
+        defer(RAW_ADXL, t);
+        return;
+    }
+    readAdxl(t);
+}
+
+/**
+ * @brief keeps the interrupt time; the sample is read when the bus is released
+ *
+ * The chip keeps only its newest sample, so a second interrupt from the
+ * same chip before the release replaces the first.
+ */
+void DrdyAcquisition::defer(uint8_t source, uint32_t time_us) {
+    if(pending & source) {
+        held_drops = held_drops + 1;
+    }
+    pending_us[source] = time_us;
+    pending = pending | source;
+}
+
+/**
+ * @brief the loop is starting a transaction on the shared bus
+ */
+void DrdyAcquisition::holdBus() {
+    if(active) {
+        active->bus_holds = active->bus_holds + 1;
+    }
+}
+
+/**
+ * @brief the loop's transaction is over; reads whatever went pending meanwhile
+ *
+ * The pending reads run with interrupts masked, like rearm(), so they
+ * neither race an ISR on the bus nor push onto the queue alongside one.
+ */
+void DrdyAcquisition::releaseBus() {
+    DrdyAcquisition *a = active;
+    if(!a || !a->bus_holds) {
+        return;
+    }
+    noInterrupts();
+    a->bus_holds = a->bus_holds - 1;
+    if(!a->bus_holds) {
+        if(a->pending & RAW_LSM) {
+            a->readLsm(a->pending_us[RAW_LSM]);
+        }
+        if(a->pending & RAW_ADXL) {
+            a->readAdxl(a->pending_us[RAW_ADXL]);
+        }
+        a->pending = 0;
+    }
+    interrupts();
+}
+
+void DrdyAcquisition::readLsm(uint32_t time_us) {
+    RawSample s;
+    s.time_us = time_us;
+    s.source = RAW_LSM;
+
+    uint8_t raw[LSM_BURST];
+    if(!lsm_bus.readRegs(LSM6DSO32_OUT_TEMP_L, raw, LSM_BURST)) {
+        lsm_errors = lsm_errors + 1;
+        return;
+    }
+    s.temp = le16(raw);
+    for(int i = 0; i < 6; i++) {
+        s.v[i] = le16(raw + 2 + 2 * i);
+    }
+    queue.push(s);
+}
+
+void DrdyAcquisition::readAdxl(uint32_t time_us) {
+    RawSample s;
+    s.time_us = time_us;
+    s.source = RAW_ADXL;
+    s.temp = 0;
+
+    uint8_t raw[ADXL_BURST];
+    if(!adxl_bus.readRegs(ADXL375_DATAX0, raw, ADXL_BURST)) {
+        adxl_errors = adxl_errors + 1;
+        return;
+    }
+    for(int i = 0; i < 3; i++) {
+        s.v[i] = le16(raw + 2 * i);
+        s.v[3 + i] = 0;
+    }
+    queue.push(s);
+}
+
+void DrdyAcquisition::lsmIsr() {
+    if(active) {
+        active->lsmReady();
+    }
+}
+
+void DrdyAcquisition::adxlIsr() {
+    if(active) {
+        active->adxlReady();
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef SRAD_PHX_ISR_H
+#define SRAD_PHX_ISR_H
+
+// Interrupt-driven LSM6DSO32/ADXL375 acquisition. Each chip's data-ready
+// pin triggers an ISR that stamps micros(), reads the output registers
+// and pushes the raw sample onto an SpscQueue; the loop drains the queue
+// with FLIGHT::read_IMU, which fills the same SampleBatches as the
+// FIFO drivers. Sample times therefore carry the interrupt latency
+// only, not the jitter of whatever the loop was doing.
+//
+// The ISRs share the I2C bus with the loop's read_BMP and read_BNO. While
+// the loop holds the bus (DrdyBusGuard) an ISR only stamps its sample and
+// leaves it pending; releasing the bus reads it, so no ISR transaction
+// ever lands inside one of the loop's.
+//
+// Both ISRs, rearm() and the release all push into the one queue, which
+// has a single producer. That holds because the two pin interrupts share
+// one priority (on a Teensy, the GPIO interrupt), so neither preempts the
+// other, and the loop-side pushes run with interrupts masked.
+
+#include <stdint.h>
+
+#include "SRAD_PHX_Fifo.h"                  // RegisterBus, register addresses and scales
+#include "SRAD_PHX_Queue.h"
+
+#ifndef PHX_ISR_QUEUE_LEN
+#define PHX_ISR_QUEUE_LEN 256               // raw samples, power of two
+#endif
+
+#define LSM6DSO32_INT1_CTRL 0x0D
+#define LSM6DSO32_COUNTER_BDR_REG1 0x0B
+#define LSM6DSO32_OUT_TEMP_L 0x20           // temperature, gyro x, y, z, accel x, y, z
+#define ADXL375_INT_ENABLE 0x2E
+#define ADXL375_INT_MAP 0x2F
+
+enum RAW_SOURCE : uint8_t {
+    RAW_LSM = 1,                            // same values as ACC_SOURCE
+    RAW_ADXL = 2,
+};
+
+struct RawSample {
+    uint32_t time_us;                       // micros() at interrupt entry
+    uint8_t source;                         // RAW_SOURCE
+    int16_t v[6];                           // LSM: gyro x, y, z, accel x, y, z; ADXL: accel x, y, z
+    int16_t temp;                           // LSM only, 1/256 degC from 25 degC
+};
+
+typedef SpscQueue<RawSample, PHX_ISR_QUEUE_LEN> RawSampleQueue;
+
+/**
+ * @brief data-ready interrupts of the LSM6DSO32 and ADXL375 into one queue
+ *
+ * begin() sets each chip's data rate and routes its data-ready signal
+ * to INT1, then attaches the ISRs. Only one instance can be attached.
+ * lsmReady()/adxlReady() are the ISR bodies; they are public so a host
+ * thread can stand in for the interrupt.
+ */
+class DrdyAcquisition {
+    public:
+        DrdyAcquisition(RegisterBus &lsm, RegisterBus &adxl) : lsm_bus(lsm), adxl_bus(adxl) {}
+
+        bool begin(uint8_t lsm_int, uint8_t adxl_int, uint16_t lsm_hz = 833, uint16_t adxl_hz = 800);
+        void end();
+        void rearm();
+
+        void lsmReady();
+        void adxlReady();
+
+        static void holdBus();
+        static void releaseBus();
+
+        RawSampleQueue queue;
+        volatile uint32_t lsm_errors = 0;   // ISR reads that failed
+        volatile uint32_t adxl_errors = 0;
+        volatile uint32_t held_drops = 0;   // samples overwritten while the loop held the bus
+
+    private:
+        static void lsmIsr();
+        static void adxlIsr();
+        static DrdyAcquisition *active;
+
+        void readLsm(uint32_t time_us);
+        void readAdxl(uint32_t time_us);
+        void defer(uint8_t source, uint32_t time_us);
+
+        RegisterBus &lsm_bus;
+        RegisterBus &adxl_bus;
+        uint8_t lsm_pin = 0xFF, adxl_pin = 0xFF;
+
+        volatile uint8_t bus_holds = 0;     // nested holdBus() calls from the loop
+        volatile uint8_t pending = 0;       // RAW_SOURCE bits waiting for the bus
+        volatile uint32_t pending_us[3];    // their interrupt times, by RAW_SOURCE
+};
+
+/**
+ * @brief holds the attached DrdyAcquisition's bus for the guard's lifetime
+ *
+ * Put one around every transaction the loop makes on the bus the
+ * data-ready chips use. Costs nothing when no acquisition is attached.
+ */
+class DrdyBusGuard {
+    public:
+        DrdyBusGuard() { DrdyAcquisition::holdBus(); }
+        ~DrdyBusGuard() { DrdyAcquisition::releaseBus(); }
+        DrdyBusGuard(const DrdyBusGuard &) = delete;
+        DrdyBusGuard& operator=(const DrdyBusGuard &) = delete;
+};
+
+#endif
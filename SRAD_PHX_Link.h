@@ -0,0 +1,166 @@
+#ifndef SRAD_PHX_LINK_H
+#define SRAD_PHX_LINK_H
+
+// Flow control for the two-board split. The flight board acquires,
+// estimates and streams telemetry frames (SRAD_PHX_Telemetry.h) with
+// writeDataToTeensy; the logging board queues the decoded records with
+// readDataFromTeensy and formats them with its own writeSD/writeSDBinary.
+// The logging board answers with a LinkAck every PHX_LINK_ACK_EVERY frames,
+// and at once when its queue crosses a watermark or it lost the delta
+// chain. No Arduino dependency.
+//
+// Both directions share one SerialTransfer; the packet id tells them apart.
+
+#include <stdint.h>
+
+#include "SRAD_PHX_Schema.h"
+
+// Link flow control; override with -D.
+#ifndef PHX_LINK_QUEUE
+#define PHX_LINK_QUEUE 64                   // records the logging board holds for its writers
+#endif
+#ifndef PHX_LINK_ACK_EVERY
+#define PHX_LINK_ACK_EVERY 10               // frames between acks
+#endif
+#ifndef PHX_LINK_LOW_WATER
+#define PHX_LINK_LOW_WATER (PHX_LINK_QUEUE / 4)         // free slots below which the sender is asked to thin
+#endif
+#ifndef PHX_LINK_HIGH_WATER
+#define PHX_LINK_HIGH_WATER (3 * PHX_LINK_QUEUE / 4)    // free slots above which thinning is undone
+#endif
+#ifndef PHX_LINK_MAX_STRIDE
+#define PHX_LINK_MAX_STRIDE 8               // the sender never thins to fewer than 1 record in this many
+#endif
+#ifndef PHX_LINK_FRAMING
+#define PHX_LINK_FRAMING 8                  // SerialTransfer bytes around a payload, worst case
+#endif
+
+enum LINK_PACKET : uint8_t {
+    LINK_FRAME = 0,                         // TelemetryEncoder frame, flight board to logging board
+    LINK_ACK = 1,                           // LinkAck, logging board to flight board
+};
+
+enum LINK_ACK_FLAGS : uint8_t {
+    LINK_ACK_BUSY = 0x01,                   // queue below PHX_LINK_LOW_WATER: send fewer records
+    LINK_ACK_RESYNC = 0x02,                 // a delta arrived with no chain: send a keyframe now
+};
+
+/**
+ * @brief the logging board's view of the link, sent back to the flight board
+ */
+struct __attribute__((packed)) LinkAck {
+    uint16_t seq;                           // last frame sequence received
+    uint16_t room;                          // free LinkQueue slots
+    uint8_t flags;                          // LINK_ACK_FLAGS
+    uint32_t applied;                       // TelemetryRxStats of the receiver
+    uint32_t lost;
+    uint32_t dropped;
+    uint32_t overflow;                      // records decoded but dropped, queue full
+};
+
+struct LinkTxStats {
+    uint32_t sent;                          // frames written to the port
+    uint32_t thinned;                       // records skipped under LINK_ACK_BUSY
+    uint32_t blocked;                       // records skipped because the port's buffer was full
+    uint32_t acks;
+    uint32_t resyncs;                       // keyframes sent early on LINK_ACK_RESYNC
+    uint16_t stride;                        // records per frame sent, 1 unless thinned
+    uint16_t in_flight;                     // frames sent after the last acked one
+    LinkAck peer;                           // the last ack received
+};
+
+struct LinkRxStats {
+    uint32_t queued;                        // records put in the LinkQueue
+    uint32_t overflow;                      // records dropped, queue full
+    uint32_t acks;                          // acks sent
+    uint16_t high_water;                    // most records ever waiting
+};
+
+/**
+ * @brief sender side: how many records to skip per frame, from the acks
+ *
+ * Skipped records are never encoded, so the next frame is still a delta
+ * against the last one sent and the receiver sees no gap in the sequence,
+ * only a wider spacing in totalTime_ms.
+ */
+class LinkSender {
+    public:
+        LinkSender() { reset(); }
+
+        void reset() {
+            stat = LinkTxStats();
+            stat.stride = 1;
+            phase = 0;
+        }
+
+        // true if this record is to be sent
+        bool due() {
+            if(phase++ % stat.stride) {
+                stat.thinned++;
+                return false;
+            }
+            return true;
+        }
+
+        // returns true if the receiver wants a keyframe
+        bool onAck(const LinkAck &a, uint16_t next_seq) {
+            stat.acks++;
+            stat.peer = a;
+            stat.in_flight = (uint16_t)(next_seq - 1 - a.seq);
+            if(a.flags & LINK_ACK_BUSY) {
+                stat.stride = stat.stride * 2 < PHX_LINK_MAX_STRIDE ? stat.stride * 2 : PHX_LINK_MAX_STRIDE;
+            } else if(a.room >= PHX_LINK_HIGH_WATER && stat.stride > 1) {
+                stat.stride /= 2;
+            }
+            if(a.flags & LINK_ACK_RESYNC) {
+                stat.resyncs++;
+                return true;
+            }
+            return false;
+        }
+
+        LinkTxStats stat;
+
+    private:
+        uint32_t phase;
+};
+
+/**
+ * @brief receiver side: decoded records waiting for the logging board's writers
+ *
+ * @tparam N capacity
+ */
+template <uint16_t N>
+class LinkQueue {
+    static_assert(N >= 4, "link queue needs at least 4 records");
+
+    public:
+        LinkQueue() : head(0), tail(0) {}
+
+        bool push(const FlightRecord &r) {
+            if(size() == N) {
+                return false;
+            }
+            rows[head % N] = r;
+            head++;
+            return true;
+        }
+
+        bool pop(FlightRecord &r) {
+            if(head == tail) {
+                return false;
+            }
+            r = rows[tail % N];
+            tail++;
+            return true;
+        }
+
+        uint16_t size() const { return head - tail; }
+        uint16_t room() const { return N - size(); }
+
+    private:
+        FlightRecord rows[N];
+        uint32_t head, tail;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <string.h>
+
+#include "SRAD_PHX_Log.h"
+
+#define PHX_LOGTYPE_U8  LOG_U8
+#define PHX_LOGTYPE_U16 LOG_U16
+#define PHX_LOGTYPE_U32 LOG_U32
+#define PHX_LOGTYPE_U64 LOG_U64
+#define PHX_LOGTYPE_F32 LOG_F32
+
+#define PHX_LOG_FIELD(name, type, precision, tlm, member, label, flags) \
+    { #name, PHX_LOGTYPE_##type, precision, (uint16_t)offsetof(LogRecord, data.name) },
+
+/**
+ * @brief schema written into every binary log header
+ *
+ * Lets tools other than phx_decode find fields without
+ * compiling against LogRecord.
+ */
+const LogFieldDesc PHX_LOG_FIELDS[] = {
+    PHX_FLIGHT_FIELDS(PHX_LOG_FIELD)
+};
+
+const uint16_t PHX_LOG_FIELD_COUNT = sizeof(PHX_LOG_FIELDS) / sizeof(PHX_LOG_FIELDS[0]);
+
+void makeLogFileHeader(LogFileHeader &hdr, uint16_t text_len) {
+    memcpy(hdr.magic, PHX_LOG_MAGIC, PHX_LOG_MAGIC_LEN);
+    hdr.version = PHX_LOG_VERSION;
+    hdr.little_endian = 1;
+    hdr.header_size = sizeof(LogFileHeader) + PHX_LOG_FIELD_COUNT * sizeof(LogFieldDesc) + text_len;
+    hdr.record_size = sizeof(LogRecord);
+    hdr.field_count = PHX_LOG_FIELD_COUNT;
+    hdr.text_len = text_len;
+}
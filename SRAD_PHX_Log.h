@@ -0,0 +1,126 @@
+#ifndef SRAD_PHX_LOG_H
+#define SRAD_PHX_LOG_H
+
+// Binary flight log format shared by the flight code and the host tools.
+// This header must not depend on Arduino so the decoder can build on Linux.
+//
+// File layout (all integers little-endian):
+//   LogFileHeader
+//   LogFieldDesc[field_count]       -- one entry per LogRecord field
+//   char text[text_len]             -- CSV column header the flight code was given
+//   LogRecord...                    -- fixed-size records until end of file,
+//                                      mixed with LogImuRecords when FIFO
+//                                      samples are logged and LogEventRecords
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SRAD_PHX_Schema.h"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "SRAD_PHX binary logs are little-endian; add byte swapping for this target"
+#endif
+
+#define PHX_LOG_MAGIC       "PHXLOG"
+#define PHX_LOG_MAGIC_LEN   6
+#define PHX_LOG_VERSION     4           // 3 adds LogImuRecord, 4 LogEventRecord; older logs decode the same
+#define PHX_LOG_SYNC        0xA55A
+#define PHX_LOG_SYNC_IMU    0xA55B
+#define PHX_LOG_SYNC_EVENT  0xA55C
+
+enum LogFieldType : uint8_t {
+    LOG_U8  = 0,
+    LOG_U16 = 1,
+    LOG_U64 = 2,
+    LOG_F32 = 3,
+    LOG_U32 = 4,
+};
+
+struct __attribute__((packed)) LogFileHeader {
+    char magic[PHX_LOG_MAGIC_LEN];  // PHX_LOG_MAGIC, not null terminated
+    uint8_t version;                // PHX_LOG_VERSION
+    uint8_t little_endian;          // always 1, lets tools reject foreign logs
+    uint16_t header_size;           // bytes from start of file to first record
+    uint16_t record_size;           // sizeof(LogRecord)
+    uint16_t field_count;           // number of LogFieldDesc entries
+    uint16_t text_len;              // length of the CSV header text
+};
+
+struct __attribute__((packed)) LogFieldDesc {
+    char name[20];                  // null padded
+    uint8_t type;                   // LogFieldType
+    uint8_t precision;              // digits after the decimal point in CSV output
+    uint16_t offset;                // byte offset inside LogRecord
+};
+
+/**
+ * One logged sample: a sync word followed by every schema field
+ * (see SRAD_PHX_Schema.h) in schema order.
+ */
+struct __attribute__((packed)) LogRecord {
+    uint16_t sync;                  // PHX_LOG_SYNC, used to resynchronize after corruption
+    FlightRecord data;
+};
+
+enum LogImuSource : uint8_t {
+    LOG_IMU_LSM = 1,                // same values as ACC_SOURCE
+    LOG_IMU_ADXL = 2,
+};
+
+/**
+ * One accelerometer FIFO sample (SRAD_PHX_Fifo.h), written by
+ * FLIGHT::writeSamplesBinary between the LogRecords.
+ */
+struct __attribute__((packed)) LogImuRecord {
+    uint16_t sync;                  // PHX_LOG_SYNC_IMU
+    uint8_t source;                 // LogImuSource
+    uint32_t time_us;               // reconstructed sample time, micros()
+    float acc[3];                   // m/s^2
+    float gyro[3];                  // rad/s, NAN for the ADXL375
+};
+
+enum LogEventType : uint8_t {
+    LOG_EVENT_RATE = 1,             // arg: log_every, serial_every, RATE_REDUCE
+    LOG_EVENT_HEALTH = 2,           // arg: SENSOR_ID, SENSOR_HEALTH, errors (saturates at 65535)
+};
+
+/**
+ * Something that happened between two rows, written by FLIGHT in both
+ * logs: as this record in the binary one and as a `#event` line in the CSV.
+ */
+struct __attribute__((packed)) LogEventRecord {
+    uint16_t sync;                  // PHX_LOG_SYNC_EVENT
+    uint8_t type;                   // LogEventType
+    uint64_t time_ms;               // totalTime_ms of the row it precedes
+    uint8_t state;                  // STATES value
+    uint16_t arg[3];                // meaning depends on type
+};
+
+/**
+ * @brief the CSV line for an event
+ *
+ * `#event,<type>,<time_ms>,<state>,<arg0>,<arg1>,<arg2>`, comma separated
+ * like the rows, so a reader can skip lines starting with `#`.
+ */
+template <class Out>
+void printLogEvent(Out &out, const LogEventRecord &e) {
+    out.print("#event,");
+    out.print(e.type == LOG_EVENT_RATE ? "rate" : e.type == LOG_EVENT_HEALTH ? "health" : "unknown");
+    out.print(",");
+    out.print((unsigned long long)e.time_ms);
+    out.print(",");
+    out.print((unsigned)e.state);
+    for(int i = 0; i < 3; i++) {
+        out.print(",");
+        out.print((unsigned)e.arg[i]);
+    }
+    out.println();
+}
+
+extern const LogFieldDesc PHX_LOG_FIELDS[];
+extern const uint16_t PHX_LOG_FIELD_COUNT;
+
+// Fills `hdr` for a log whose CSV header text is `text_len` bytes long.
+void makeLogFileHeader(LogFileHeader &hdr, uint16_t text_len);
+
+#endif
@@ -0,0 +1,202 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Logger.h"
+
+static_assert(PHX_LOG_BLOCK_COUNT >= 2 && PHX_LOG_BLOCK_COUNT <= 255, "PHX_LOG_BLOCK_COUNT out of range");
+
+SectorLogger::SectorLogger()
+: head(0), tail(0), full(0), fill(0), payload_begin(0), payload_end(PHX_LOG_BLOCK_SIZE),
+  file(nullptr), journal(nullptr), busy(nullptr), realtime(false),
+  flush_requested(false), flush_interval_ms(PHX_LOG_FLUSH_INTERVAL_MS), flush_bytes(PHX_LOG_FLUSH_BYTES),
+  unflushed_bytes(0), last_flush_ms(0), stat() {}
+
+/**
+ * @brief attaches the logger to an open file
+ * @param f File opened for writing, must stay open while logging
+ */
+void SectorLogger::begin(File &f) {
+    file = &f;
+    last_flush_ms = millis();
+}
+
+/**
+ * @brief logs to raw sectors of a preallocated extent instead of a file
+ * @param j journal already opened with ExtentJournal::begin()
+ *
+ * Call before anything is written: the ring's blocks are laid out as
+ * extent sectors from here on.
+ */
+void SectorLogger::begin(ExtentJournal &j) {
+    static_assert(PHX_LOG_BLOCK_SIZE == PHX_EXTENT_SECTOR, "an extent block is one ring block");
+    journal = &j;
+    payload_begin = sizeof(ExtentBlockHeader);
+    payload_end = payload_begin + PHX_EXTENT_PAYLOAD;
+    fill = payload_begin;
+    last_flush_ms = millis();
+}
+
+/**
+ * @brief sets when service() calls File::flush() outside of realtime
+ * @param interval_ms Flush at least this often while data is unflushed
+ * @param bytes Flush once this many bytes have been written since the last flush
+ */
+void SectorLogger::setFlushPolicy(uint32_t interval_ms, uint32_t bytes) {
+    flush_interval_ms = interval_ms;
+    flush_bytes = bytes;
+}
+
+/**
+ * @brief optional probe that reports a busy card
+ *
+ * While realtime, service() skips writing when the probe returns true.
+ * On Teensy: `logger.setBusyCheck([]{ return SD.sdfs.card()->isBusy(); });`
+ */
+void SectorLogger::setBusyCheck(bool (*probe)()) {
+    busy = probe;
+}
+
+/**
+ * @brief called by FLIGHT::calculateState on every state transition
+ * @param rt True if the new state must never wait on the card
+ *
+ * Every transition requests a flush so each flight phase is on the card
+ * before the next begins; while realtime the flush is held until
+ * realtime ends.
+ */
+void SectorLogger::onStateChange(bool rt) {
+    realtime = rt;
+    flush_requested = true;
+}
+
+size_t SectorLogger::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+/**
+ * @brief copies bytes into the ring, never touches the card
+ * @return number of bytes accepted, 0 if the whole write was dropped
+ *
+ * A write either fits entirely or is dropped entirely so binary
+ * records are never torn by an overrun.
+ */
+size_t SectorLogger::write(const uint8_t *buffer, size_t size) {
+    if(size > space()) {
+        stat.overruns++;
+        stat.bytes_dropped += size;
+        return 0;
+    }
+
+    size_t left = size;
+    while(left) {
+        size_t n = payload_end - fill;
+        if(n > left) {
+            n = left;
+        }
+        memcpy(&blocks[head][fill], buffer, n);
+        fill += n;
+        buffer += n;
+        left -= n;
+        if(fill == payload_end) {
+            commitBlock();
+        }
+    }
+    return size;
+}
+
+void SectorLogger::commitBlock() {
+    head = (head + 1) % PHX_LOG_BLOCK_COUNT;
+    fill = payload_begin;
+    full++;
+    if(full > stat.high_water) {
+        stat.high_water = full;
+    }
+}
+
+void SectorLogger::flushFile() {
+    if(journal) {
+        journal->sync();
+    } else {
+        file->flush();
+    }
+    stat.flushes++;
+    unflushed_bytes = 0;
+    flush_requested = false;
+    last_flush_ms = millis();
+}
+
+bool SectorLogger::writeBlock(uint8_t *block, uint16_t used) {
+    if(journal) {
+        return journal->append(block, used);
+    }
+    return file->write(block, used) == used;
+}
+
+/**
+ * @brief moves full sectors to the card, call once per loop
+ *
+ * Outside realtime every full block is written and the file is flushed
+ * according to the flush policy or a pending state-change request.
+ */
+void SectorLogger::service() {
+    if(!file && !journal) {
+        return;
+    }
+    uint32_t start_us = micros();
+
+    uint8_t budget = realtime ? PHX_LOG_REALTIME_BLOCKS : full;
+    while(full && budget--) {
+        if(realtime && busy && busy()) {
+            break;
+        }
+        if(!writeBlock(blocks[tail], payload_end - payload_begin)) {
+            stat.write_errors++;
+        }
+        tail = (tail + 1) % PHX_LOG_BLOCK_COUNT;
+        full--;
+        stat.blocks_written++;
+        unflushed_bytes += PHX_LOG_BLOCK_SIZE;
+    }
+
+    if(!realtime && unflushed_bytes &&
+       (flush_requested || unflushed_bytes >= flush_bytes || millis() - last_flush_ms >= flush_interval_ms)) {
+        flushFile();
+    }
+
+    uint32_t elapsed_us = micros() - start_us;
+    if(elapsed_us > stat.max_service_us) {
+        stat.max_service_us = elapsed_us;
+    }
+}
+
+/**
+ * @brief writes everything still buffered, including a partial sector, and flushes
+ *
+ * Blocks on the card; call after landing or before closing the file.
+ * On an extent the partial sector is a short last block, and later rows
+ * continue in a new one.
+ */
+void SectorLogger::close() {
+    if(!file && !journal) {
+        return;
+    }
+    realtime = false;
+    while(full) {
+        writeBlock(blocks[tail], payload_end - payload_begin);
+        tail = (tail + 1) % PHX_LOG_BLOCK_COUNT;
+        full--;
+        stat.blocks_written++;
+    }
+    if(fill != payload_begin) {
+        writeBlock(blocks[head], fill - payload_begin);
+        fill = payload_begin;
+    }
+    flushFile();
+}
@@ -0,0 +1,97 @@
+#ifndef SRAD_PHX_LOGGER_H
+#define SRAD_PHX_LOGGER_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+#include "SRAD_PHX_Extent.h"
+
+// Ring geometry and default flush policy; override with -D to resize.
+#ifndef PHX_LOG_BLOCK_SIZE
+#define PHX_LOG_BLOCK_SIZE 512              // one SD sector
+#endif
+#ifndef PHX_LOG_BLOCK_COUNT
+#define PHX_LOG_BLOCK_COUNT 16              // 8 KB of buffering
+#endif
+#ifndef PHX_LOG_REALTIME_BLOCKS
+#define PHX_LOG_REALTIME_BLOCKS 1           // sectors per service() while realtime
+#endif
+#ifndef PHX_LOG_FLUSH_INTERVAL_MS
+#define PHX_LOG_FLUSH_INTERVAL_MS 1000
+#endif
+#ifndef PHX_LOG_FLUSH_BYTES
+#define PHX_LOG_FLUSH_BYTES 16384
+#endif
+
+struct SectorLoggerStats {
+    uint32_t blocks_written;                // whole sectors handed to the card
+    uint32_t flushes;                       // File::flush() calls (FAT/directory updates), or superblock updates
+    uint32_t overruns;                      // writes rejected because the ring was full
+    uint32_t bytes_dropped;                 // bytes lost to overruns
+    uint32_t write_errors;                  // short writes reported by the card
+    uint8_t high_water;                     // most full blocks waiting at once
+    uint32_t max_service_us;                // longest single service() call
+};
+
+/**
+ * @brief buffered, sector-aligned writer for the SD log
+ *
+ * Rows are printed into a ring of PHX_LOG_BLOCK_COUNT sector-sized
+ * blocks and only complete sectors are written to the card from
+ * `service()`. While realtime (FLIGHT_ASCENT) at most
+ * PHX_LOG_REALTIME_BLOCKS sectors are written per call and File::flush()
+ * is never called, so a slow card costs data (counted as overruns)
+ * instead of loop time.
+ *
+ * Given an ExtentJournal instead of a File, each ring block is a whole
+ * extent sector: rows fill the space between its header and CRC, and
+ * the flush policy moves the superblock instead of the FAT.
+ */
+class SectorLogger : public Print {
+    public:
+        SectorLogger();
+
+        void begin(File &);
+        void begin(ExtentJournal &);
+        void service();
+        void onStateChange(bool realtime);
+        void setFlushPolicy(uint32_t interval_ms, uint32_t bytes);
+        void setBusyCheck(bool (*)());
+        void close();
+
+        size_t write(uint8_t) override;
+        size_t write(const uint8_t *, size_t) override;
+        using Print::write;
+        void flush() override {}            // rows call flush(); the flush policy lives in service()
+
+        uint8_t pending() const { return full; }
+        size_t space() const { return (size_t)(PHX_LOG_BLOCK_COUNT - full) * (payload_end - payload_begin) - (fill - payload_begin); }
+        const SectorLoggerStats& stats() const { return stat; }
+
+    private:
+        void commitBlock();
+        void flushFile();
+        bool writeBlock(uint8_t *block, uint16_t used);
+
+        uint8_t blocks[PHX_LOG_BLOCK_COUNT][PHX_LOG_BLOCK_SIZE];
+        uint8_t head;                       // block being filled
+        uint8_t tail;                       // oldest full block
+        uint8_t full;                       // full blocks waiting for the card
+        uint16_t fill;                      // end of the data in the head block
+        uint16_t payload_begin;             // where rows go in a block: all of it for a File,
+        uint16_t payload_end;               // between the header and CRC for an extent
+
+        File *file;
+        ExtentJournal *journal;
+        bool (*busy)();                     // optional card busy probe, skipped writes while realtime
+        bool realtime;
+        bool flush_requested;
+        uint32_t flush_interval_ms;
+        uint32_t flush_bytes;
+        uint32_t unflushed_bytes;
+        uint32_t last_flush_ms;
+
+        SectorLoggerStats stat;
+};
+
+#endif
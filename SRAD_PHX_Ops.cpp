@@ -13,334 +13,606 @@
 /** 
  * @brief tracks time during flight
  * 
- * This function calls the millis() function from the
- * Arduino library to track milliseconds since the board
- * was powered on. It updates three variables: 
+ * This function reads micros() from the Arduino library
+ * and widens it to 64 bits (SRAD_PHX_Clock.h), so the time
+ * since the board was powered on never wraps. It updates:
  * 
- * 1. `deltaTime_ms`
- * 2. `runningTime_ms`
- * 3. `output.totalTime_ms`
+ * 1. `deltaTime_us`
+ * 2. `runningTime_us` and `runningTime_ms`
+ * 3. `output.time_us` and `output.totalTime_ms`
+ *
+ * It is called once per loop, so it also marks the loop
+ * boundary for the profiler when PHX_PROFILE is defined.
+ * It must run at least once per 71 minutes, one wrap of micros().
  */
 void FLIGHT::incrementTime() {
-    uint64_t newRunningTime_ms = millis();
-    deltaTime_ms = newRunningTime_ms - runningTime_ms;
-    runningTime_ms = newRunningTime_ms;
-    output.totalTime_ms = newRunningTime_ms;
+    PHX_PROFILE_LOOP();
+
+    uint64_t now_us = nowMicros();
+    deltaTime_us = now_us - runningTime_us;
+    runningTime_us = now_us;
+    runningTime_ms = now_us / 1000;
+    output.time_us = now_us;
+    output.totalTime_ms = runningTime_ms;
+    loop_ticks++;
+}
+
+/**
+ * @brief copies every schema field out of FlightData
+ *
+ * Generated from PHX_FLIGHT_FIELDS, so it is a run of plain
+ * stores with no per-field bookkeeping.
+ */
+void packFlightRecord(const FlightData &d, FlightRecord &r) {
+#define PHX_PACK_FIELD(name, type, precision, tlm, member, label, flags) r.name = d.member;
+    PHX_FLIGHT_FIELDS(PHX_PACK_FIELD)
+#undef PHX_PACK_FIELD
+}
+
+/**
+ * @brief copies every schema field back into FlightData
+ */
+void unpackFlightRecord(const FlightRecord &r, FlightData &d) {
+#define PHX_UNPACK_FIELD(name, type, precision, tlm, member, label, flags) d.member = r.name;
+    PHX_FLIGHT_FIELDS(PHX_UNPACK_FIELD)
+#undef PHX_UNPACK_FIELD
+}
+
+/**
+ * @brief prints the schema's column names, after `data_header` as a `#` line if it is set
+ *
+ * The columns always come from PHX_FLIGHT_FIELDS; a sketch's own header
+ * text is kept only as a note, since it cannot follow the schema.
+ */
+void FLIGHT::writeHeader(Print &out) {
+    if(data_header.length()) {
+        out.print('#');
+        out.println(data_header);
+    }
+    printCsvHeader(out);
+    out.flush();
 }
 
 /**
  * @brief writes data stored in `output` to file
  * @param headers If true, function will only right headers and return early
- * @param File A reference to Arduino file type from SD.h
+ * @param File Arduino file from SD.h, or a SectorLogger for buffered sector writes
  * 
  * This function can write data headers or current data to SD card.
+ * Columns follow PHX_FLIGHT_FIELDS, one line per row. The row is
+ * formatted into a LineBuffer and handed over in one write(). The state's
+ * RatePolicy decides which calls write a row; when it changes, an
+ * `#event,rate` line is written first.
  */
-void FLIGHT::writeSD(bool headers, File& outputFile) {
+void FLIGHT::writeSD(bool headers, Print& outputFile) {
+    PHX_PROFILE_SCOPE(STAGE_WRITE_SD);
+
     if(headers) {
-        outputFile.println(data_header);
+        writeHeader(outputFile);
+        return;
+    }
+
+    RatePolicy rate = currentRate();
+    announceRate(csv_rate, rate, outputFile, false);
+    announceHealth(csv_health, outputFile, false);
+    FlightRecord rec;
+    packFlightRecord(output, rec);
+    bool due = log_rows.update(loop_ticks, rec, rate.log_every, rate.reduce);
+    if(pretrigger_on) {
+        if(due) {
+            capturePretrigger(log_rows.row());
+        }
+        drainPretrigger(pre_csv, outputFile, false);
         outputFile.flush();
         return;
     }
+    if(!due) {
+        return;
+    }
+    LineBuffer<PHX_CSV_LINE_MAX> line;
+    printCsvRow(line, log_rows.row());
+    outputFile.write(line.bytes(), line.length());
+    outputFile.flush();
+
+    return;
+}
+
+/**
+ * @brief writes data stored in `output` to file as a binary LogRecord
+ * @param headers If true, function will only write the file header and return early
+ * @param File Arduino file from SD.h, or a SectorLogger for buffered sector writes
+ *
+ * Same content as `writeSD` in a fixed-size record (see SRAD_PHX_Log.h),
+ * so each row is a single write instead of ~60 print calls.
+ * Use extras/tools/phx_decode to turn the log back into CSV.
+ */
+void FLIGHT::writeSDBinary(bool headers, Print& outputFile) {
+    PHX_PROFILE_SCOPE(STAGE_WRITE_SD);
 
-    outputFile.print(output.totalTime_ms); outputFile.print(", ");
-    if(last_gps.fix) {
-        outputFile.print(last_gps.latitudeDegrees, 6); outputFile.print(", ");
-        outputFile.print(last_gps.longitudeDegrees, 6); outputFile.print(",");
-        outputFile.print((int32_t)last_gps.satellites); outputFile.print(",");
-        outputFile.print(last_gps.speed, 3); outputFile.print(",");
-        outputFile.print(last_gps.angle, 3); outputFile.print(",");
-        outputFile.print(last_gps.altitude, 3); outputFile.print(",");
-    } else {
-        outputFile.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
-    }
-    outputFile.print(output.bno_orientation.w, 5); outputFile.print(",");
-    outputFile.print(output.bno_orientation.x, 5); outputFile.print(",");
-    outputFile.print(output.bno_orientation.y, 5); outputFile.print(",");
-    outputFile.print(output.bno_orientation.z, 5); outputFile.print(",");
-    outputFile.print(output.bno_gyro.x, 5); outputFile.print(",");
-    outputFile.print(output.bno_gyro.y, 5); outputFile.print(",");
-    outputFile.print(output.bno_gyro.z, 5); outputFile.print(",");
-    outputFile.print(output.bno_acc.x, 4); outputFile.print(",");
-    outputFile.print(output.bno_acc.y, 4); outputFile.print(",");
-    outputFile.print(output.bno_acc.z, 4); outputFile.print(",");
-    outputFile.print(output.adxl_acc.x, 2); outputFile.print(",");
-    outputFile.print(output.adxl_acc.y, 2); outputFile.print(",");
-    outputFile.print(output.adxl_acc.z, 2); outputFile.print(",");
-    outputFile.print(output.bmp_press, 6); outputFile.print(",");
-    outputFile.print(output.bmp_alt, 4); outputFile.print(",");
-    outputFile.print(output.lsm_temp, 2); outputFile.print(",");
-    outputFile.print(output.adxl_temp, 2); outputFile.print(",");
-    outputFile.print(output.bno_temp, 2); outputFile.print(",");
-    outputFile.print(output.bmp_temp, 2); outputFile.println();
-    outputFile.print(output.sensorStatus.test(0)); outputFile.print(", ");
-    outputFile.print(output.sensorStatus.test(1)); outputFile.print(", ");
-    outputFile.print(output.sensorStatus.test(2)); outputFile.print(", ");
-    outputFile.print(output.sensorStatus.test(3)); outputFile.print(", ");
-    outputFile.print(output.sensorStatus.test(4)); outputFile.println();
+    if(headers) {
+        LogFileHeader hdr;
+        makeLogFileHeader(hdr, data_header.length());
+        outputFile.write((const uint8_t*)&hdr, sizeof(hdr));
+        outputFile.write((const uint8_t*)PHX_LOG_FIELDS, PHX_LOG_FIELD_COUNT * sizeof(LogFieldDesc));
+        outputFile.write((const uint8_t*)data_header.c_str(), data_header.length());
+        outputFile.flush();
+        return;
+    }
+
+    RatePolicy rate = currentRate();
+    announceRate(bin_rate, rate, outputFile, true);
+    announceHealth(bin_health, outputFile, true);
+    LogRecord rec;
+    rec.sync = PHX_LOG_SYNC;
+    packFlightRecord(output, rec.data);
+    bool due = log_rows.update(loop_ticks, rec.data, rate.log_every, rate.reduce);
+    if(pretrigger_on) {
+        if(due) {
+            capturePretrigger(log_rows.row());
+        }
+        drainPretrigger(pre_bin, outputFile, true);
+        outputFile.flush();
+        return;
+    }
+    if(!due) {
+        return;
+    }
+    rec.data = log_rows.row();
+
+    outputFile.write((const uint8_t*)&rec, sizeof(rec));
     outputFile.flush();
 
     return;
 }
 
+static void writeImuRecords(Print &out, const SampleBatch &b, uint8_t source, uint32_t &next_seq) {
+    for(uint16_t i = 0; i < b.count; i++) {
+        if((int32_t)(b.first_seq + i - next_seq) < 0) {
+            continue;
+        }
+        const ImuSample &s = b.sample[i];
+        LogImuRecord rec;
+        rec.sync = PHX_LOG_SYNC_IMU;
+        rec.source = source;
+        rec.time_us = s.time_us;
+        memcpy(rec.acc, s.acc, sizeof(rec.acc));
+        memcpy(rec.gyro, s.gyro, sizeof(rec.gyro));
+        out.write((const uint8_t*)&rec, sizeof(rec));
+    }
+    next_seq = b.first_seq + b.count;
+}
+
+/**
+ * @brief writes every FIFO sample not logged yet as LogImuRecords
+ * @param outputFile the same file or SectorLogger as writeSDBinary
+ *
+ * Call after the FIFO reads of each loop; phx_decode -i extracts them.
+ * With the pretrigger ring enabled, samples read on the pad are skipped.
+ */
+void FLIGHT::writeSamplesBinary(Print& outputFile) {
+    PHX_PROFILE_SCOPE(STAGE_WRITE_SD);
+
+    if(pretrigger_on && STATE < STATES::FLIGHT_ASCENT) {
+        lsm_log_seq = batches.lsm.first_seq + batches.lsm.count;
+        adxl_log_seq = batches.adxl.first_seq + batches.adxl.count;
+        return;
+    }
+
+    writeImuRecords(outputFile, batches.lsm, LOG_IMU_LSM, lsm_log_seq);
+    writeImuRecords(outputFile, batches.adxl, LOG_IMU_ADXL, adxl_log_seq);
+    outputFile.flush();
+}
+
+/**
+ * @brief stores the current row, once per loop however many writers run
+ */
+void FLIGHT::capturePretrigger(const FlightRecord &rec) {
+    if(pretrigger.end() && pretrigger_tick == loop_ticks) {
+        return;
+    }
+    pretrigger_tick = loop_ticks;
+    pretrigger.push(rec);
+}
+
+/**
+ * @brief writes one row, unless an attached SectorLogger would be left with less than `reserve` bytes
+ * @return false if the row was not written
+ */
+bool FLIGHT::writeRow(Print &out, const FlightRecord &r, bool binary, size_t reserve) {
+    size_t room = SIZE_MAX;
+    if(logger && &out == logger) {
+        room = logger->space() > reserve ? logger->space() - reserve : 0;
+    }
+    if(binary) {
+        LogRecord rec;
+        rec.sync = PHX_LOG_SYNC;
+        rec.data = r;
+        if(sizeof(rec) > room) {
+            return false;
+        }
+        out.write((const uint8_t*)&rec, sizeof(rec));
+        return true;
+    }
+    LineBuffer<PHX_CSV_LINE_MAX> line;
+    printCsvRow(line, r);
+    if(line.length() > room) {
+        return false;
+    }
+    out.write(line.bytes(), line.length());
+    return true;
+}
+
+/**
+ * @brief logs the rows one writer may log now
+ *
+ * Before liftoff a row is only handled once it is about to leave the
+ * ring, and only rows at least the heartbeat interval apart are written,
+ * so the pad log is a slow heartbeat running ring-length behind. From
+ * FLIGHT_ASCENT on every row still in the ring is written in order, then
+ * each new row as it comes. Other sinks take the whole ring at once. A
+ * SectorLogger only takes what fits without eating into
+ * PHX_PRETRIGGER_LOG_RESERVE; the rest follow on later calls, so the
+ * dump does not crowd out the live rows and FIFO samples.
+ */
+void FLIGHT::drainPretrigger(PretriggerCursor &c, Print &out, bool binary) {
+    pretrigger.clamp(c);
+    bool pad = STATE < STATES::FLIGHT_ASCENT;
+    uint32_t keep = pad ? pretrigger.capacity() - 1 : 0;
+    uint32_t stop = pretrigger.end() > keep ? pretrigger.end() - keep : 0;
+
+    while((int32_t)(stop - c.next) > 0) {
+        const FlightRecord &r = pretrigger.at(c.next);
+        if(pad && c.beat && r.totalTime_ms - c.last_beat_ms < pretrigger_heartbeat_ms) {
+            c.next++;
+            continue;
+        }
+        size_t reserve = !pad && c.next + 1 != pretrigger.end() ? PHX_PRETRIGGER_LOG_RESERVE : 0;
+        if(!writeRow(out, r, binary, reserve)) {
+            if(pad) {
+                c.lost++;
+                c.next++;
+                continue;                   // a pad row cannot wait, the next push overwrites it
+            }
+            break;
+        }
+        if(pad) {
+            c.beat = true;
+            c.last_beat_ms = r.totalTime_ms;
+        }
+        c.written++;
+        c.next++;
+    }
+}
+
 /**
  * @brief writes data stored in `output` to a serial port
  * @param headers If true, function will only right headers and return early
  * @param Serial1 The serial port to write data to
  * 
  * This function can write data headers or current data to a serial port.
+ * Only one call in `serial_every` of the rate policy writes a row.
+ * Rows are not flushed: the port drains on its own and flush() would
+ * stall the loop until the last byte is on the wire.
  */
 void FLIGHT::writeSERIAL(bool headers, Stream& outputSerial) {
+    PHX_PROFILE_SCOPE(STAGE_WRITE_SERIAL);
+
     if(headers) {
-        outputSerial.println(data_header);
-        outputSerial.flush();
+        writeHeader(outputSerial);
         return;
     }
 
-    outputSerial.print(output.totalTime_ms); outputSerial.print(", ");
-    if(last_gps.fix) {
-        outputSerial.print(last_gps.latitudeDegrees, 6); outputSerial.print(", ");
-        outputSerial.print(last_gps.longitudeDegrees, 6); outputSerial.print(",");
-        outputSerial.print((int32_t)last_gps.satellites); outputSerial.print(",");
-        outputSerial.print(last_gps.speed, 3); outputSerial.print(",");
-        outputSerial.print(last_gps.angle, 3); outputSerial.print(",");
-        outputSerial.print(last_gps.altitude, 3); outputSerial.print(",");
-    } else {
-        outputSerial.print("-1,No fix,-1,No fix,0,-1,-1,-1,");
-    }
-    outputSerial.print(output.bno_orientation.w, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_orientation.x, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_orientation.y, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_orientation.z, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_gyro.x, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_gyro.y, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_gyro.z, 5); outputSerial.print(",");
-    outputSerial.print(output.bno_acc.x, 4); outputSerial.print(",");
-    outputSerial.print(output.bno_acc.y, 4); outputSerial.print(",");
-    outputSerial.print(output.bno_acc.z, 4); outputSerial.print(",");
-    outputSerial.print(output.adxl_acc.x, 2); outputSerial.print(",");
-    outputSerial.print(output.adxl_acc.y, 2); outputSerial.print(",");
-    outputSerial.print(output.adxl_acc.z, 2); outputSerial.print(",");
-    outputSerial.print(output.bmp_press, 6); outputSerial.print(",");
-    outputSerial.print(output.bmp_alt, 4); outputSerial.print(",");
-    outputSerial.print(output.lsm_temp, 2); outputSerial.print(",");
-    outputSerial.print(output.adxl_temp, 2); outputSerial.print(",");
-    outputSerial.print(output.bno_temp, 2); outputSerial.print(",");
-    outputSerial.print(output.bmp_temp, 2); outputSerial.println();
-    outputSerial.print(output.sensorStatus.test(0)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(1)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(2)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(3)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(4)); outputSerial.println();
-    outputSerial.flush();
+    RatePolicy rate = currentRate();
+    FlightRecord rec;
+    packFlightRecord(output, rec);
+    if(!serial_rows.update(loop_ticks, rec, rate.serial_every, rate.reduce)) {
+        return;
+    }
+    LineBuffer<PHX_CSV_LINE_MAX> line;
+    printCsvRow(line, serial_rows.row());
+    outputSerial.write(line.bytes(), line.length());
 
     return;
 }
 
+/**
+ * @brief writes data stored in `output` as labelled lines for bench testing
+ * @param headers If true, function will only right headers and return early
+ * @param outputSerial The serial port to write data to
+ */
 void FLIGHT::writeDEBUG(bool headers, Stream &outputSerial) {
+    PHX_PROFILE_SCOPE(STAGE_WRITE_DEBUG);
+
     if(headers) {
-        outputSerial.println(data_header);
-        outputSerial.flush();
+        writeHeader(outputSerial);
         return;
     }
 
-    outputSerial.print("Uptime (ms): ");outputSerial.print(output.totalTime_ms); outputSerial.print(", \n");
-    if(last_gps.fix) {
-        outputSerial.print("GPS Latitude Degrees: ");outputSerial.print(last_gps.latitudeDegrees, 6); outputSerial.println(", ");
-        outputSerial.print("GPS Longitude Degrees: ");outputSerial.print(last_gps.longitudeDegrees, 6); outputSerial.println(",");
-        outputSerial.print("GPS satellites: ");outputSerial.print((int32_t)last_gps.satellites); outputSerial.print(",");
-        outputSerial.print("GPS speed: ");outputSerial.print(last_gps.speed, 3); outputSerial.print(",");
-        outputSerial.print("GPS angle: ");outputSerial.print(last_gps.angle, 3); outputSerial.print(",");
-        outputSerial.print("GPS altitude: ");outputSerial.println(last_gps.altitude, 3); outputSerial.println();
-    } else {
-        outputSerial.println("-1,No fix,-1,No fix,0,-1,-1,-1,\n");
-    }
-    //BNO data
-        //orientation
-    outputSerial.print("BNO W-Orientation: ");outputSerial.print(output.bno_orientation.w, 5); outputSerial.print(",");
-    outputSerial.print("BNO X-Orientation: ");outputSerial.print(output.bno_orientation.x, 5); outputSerial.print(",");
-    outputSerial.print("BNO Y-Orientation: ");outputSerial.print(output.bno_orientation.y, 5); outputSerial.print(",");
-    outputSerial.print("BNO Z-Orientation: ");outputSerial.print(output.bno_orientation.z, 5); outputSerial.println(",");
-        //gyro
-    outputSerial.print("BNO X-Gyro: ");outputSerial.print(output.bno_gyro.x, 5); outputSerial.print(",");
-    outputSerial.print("BNO Y-Gyro: ");outputSerial.print(output.bno_gyro.y, 5); outputSerial.print(",");
-    outputSerial.print("BNO Z-Gyro: ");outputSerial.print(output.bno_gyro.z, 5); outputSerial.println(",");
-        //Accel
-    outputSerial.print("BNO X-Accel: ");outputSerial.print(output.bno_acc.x, 4); outputSerial.print(",");
-    outputSerial.print("BNO Y-Accel: ");outputSerial.print(output.bno_acc.y, 4); outputSerial.print(",");
-    outputSerial.print("BNO Z-Accel: ");outputSerial.print(output.bno_acc.z, 4); outputSerial.println(",");
-
-    //ADXL data
-    outputSerial.print("ADXL X_Accel: ");outputSerial.print(output.adxl_acc.x, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Y_Accel: ");outputSerial.print(output.adxl_acc.y, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Z_Accel: ");outputSerial.print(output.adxl_acc.z, 2); outputSerial.println(",");
-
-    //BMP data
-    outputSerial.print("BMP Pressure: ");outputSerial.print(output.bmp_press, 6); outputSerial.print(",");
-    outputSerial.print("BMP Altitude: ");outputSerial.print(output.bmp_alt, 4); outputSerial.println(",");
-
-    //Temperature data
-    outputSerial.print("LSM Temp: ");outputSerial.print(output.lsm_temp, 2); outputSerial.print(",");
-    outputSerial.print("ADXL Temp: ");outputSerial.print(output.adxl_temp, 2); outputSerial.print(",");
-    outputSerial.print("BNO Temp: ");outputSerial.print(output.bno_temp, 2); outputSerial.print(",");
-    outputSerial.print("BMP Temp: ");outputSerial.print(output.bmp_temp, 2); outputSerial.println("\n");
-
-    //Sensor status
-    outputSerial.println("Sensor Status:");
-    outputSerial.print(output.sensorStatus.test(0)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(1)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(2)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(3)); outputSerial.print(", ");
-    outputSerial.print(output.sensorStatus.test(4)); outputSerial.println("\n");
+    FlightRecord rec;
+    packFlightRecord(output, rec);
+    LineBuffer<PHX_DEBUG_LINE_MAX> text;
+    printDebugRecord(text, rec);
+    outputSerial.write(text.bytes(), text.length());
     outputSerial.flush();
 
     return;
 }
 
+static_assert(TLM_MAX_FRAME <= MAX_PACKET_SIZE, "a telemetry keyframe no longer fits in one SerialTransfer packet");
+
+/**
+ * @brief sends `output` to the logging board as one telemetry frame
+ *
+ * Frames are delta encoded against the previous one with a keyframe
+ * every PHX_TLM_KEYFRAME_INTERVAL frames (see SRAD_PHX_Telemetry.h).
+ * LinkAcks waiting on the port are applied first: a busy logging board
+ * gets only every `linkTx().stride`-th record, and one that lost the
+ * delta chain gets a keyframe straight away. A record is also skipped
+ * when the port cannot take a whole keyframe, so the loop never waits
+ * on the UART; on a Teensy give the port room with addMemoryForWrite().
+ */
 void FLIGHT::writeDataToTeensy(Stream &outputSerial) {
-    // TransmitFlightData transfer = prepareToTransmit(output);
-    
-    // initialize transmission size
-    uint_fast16_t trSz = 0;
-    
-    // transmit struct field by field;
-    trSz = myTransfer.txObj(output.lsm_gyro.x, trSz);
-    trSz = myTransfer.txObj(output.lsm_gyro.y, trSz);
-    trSz = myTransfer.txObj(output.lsm_gyro.z, trSz);
-
-    trSz = myTransfer.txObj(output.lsm_acc.x, trSz);
-    trSz = myTransfer.txObj(output.lsm_acc.y, trSz);
-    trSz = myTransfer.txObj(output.lsm_acc.z, trSz);
-
-    trSz = myTransfer.txObj(output.adxl_acc.x, trSz);
-    trSz = myTransfer.txObj(output.adxl_acc.y, trSz);
-    trSz = myTransfer.txObj(output.adxl_acc.z, trSz);
-
-    trSz = myTransfer.txObj(output.bno_gyro.x, trSz);
-    trSz = myTransfer.txObj(output.bno_gyro.y, trSz);
-    trSz = myTransfer.txObj(output.bno_gyro.z, trSz);
-
-    trSz = myTransfer.txObj(output.bno_acc.x, trSz);
-    trSz = myTransfer.txObj(output.bno_acc.y, trSz);
-    trSz = myTransfer.txObj(output.bno_acc.z, trSz);
-
-    trSz = myTransfer.txObj(output.bno_mag.x, trSz);
-    trSz = myTransfer.txObj(output.bno_mag.x, trSz);
-    trSz = myTransfer.txObj(output.bno_mag.x, trSz);
-
-    trSz = myTransfer.txObj(output.bno_orientation.w, trSz);
-    trSz = myTransfer.txObj(output.bno_orientation.x, trSz);
-    trSz = myTransfer.txObj(output.bno_orientation.y, trSz);
-    trSz = myTransfer.txObj(output.bno_orientation.z, trSz);
-
-    trSz = myTransfer.txObj(output.lsm_temp, trSz);
-    trSz = myTransfer.txObj(output.adxl_temp, trSz);
-    trSz = myTransfer.txObj(output.bno_temp, trSz);
-    trSz = myTransfer.txObj(output.bmp_temp, trSz);
-    trSz = myTransfer.txObj(output.bmp_press, trSz);
-    trSz = myTransfer.txObj(output.bmp_alt, trSz);
-
-    uint_fast8_t sensor1 = output.sensorStatus[0];
-    uint_fast8_t sensor2 = output.sensorStatus[1];
-    uint_fast8_t sensor3 = output.sensorStatus[2];
-    uint_fast8_t sensor4 = output.sensorStatus[3];
-    // uint_fast8_t sensor5 = output.sensorStatus[4];
-
-    trSz = myTransfer.txObj(sensor1, trSz);
-    trSz = myTransfer.txObj(sensor2, trSz);
-    trSz = myTransfer.txObj(sensor3, trSz);
-    trSz = myTransfer.txObj(sensor4, trSz);
-    // trSz = myTransfer.txObj(sensor5, trSz);
-
-    // trSz = myTransfer.txObj(output.totalTime_ms, trSz);
-    
-    myTransfer.sendData(trSz);
+    PHX_PROFILE_SCOPE(STAGE_TELEMETRY);
+
+    for(int n = 0; n < PHX_LINK_ACK_EVERY; n++) {
+        uint8_t len = myTransfer.available();
+        if(!len) {
+            break;
+        }
+        if(myTransfer.currentPacketID() != LINK_ACK || len < sizeof(LinkAck)) {
+            continue;
+        }
+        LinkAck ack;
+        myTransfer.rxObj(ack);
+        if(link_tx.onAck(ack, tlm_tx.sequence())) {
+            tlm_tx.requestKeyframe();
+        }
+    }
+
+    if(!link_tx.due()) {
+        return;
+    }
+    if(outputSerial.availableForWrite() < (int)(TLM_MAX_FRAME + PHX_LINK_FRAMING)) {
+        link_tx.stat.blocked++;
+        return;
+    }
+
+    FlightRecord rec;
+    packFlightRecord(output, rec);
+
+    size_t len = tlm_tx.encode(rec, myTransfer.packet.txBuff, MAX_PACKET_SIZE);
+    myTransfer.sendData(len, LINK_FRAME);
+    link_tx.stat.sent++;
 }
 
+/**
+ * @brief queues the frames sent by writeDataToTeensy for nextLinkRecord
+ *
+ * Lost frames and deltas that arrive without a chain are counted in
+ * `telemetryRx().stats()`, records that find the queue full in
+ * `linkRx().overflow`. Acks go back every PHX_LINK_ACK_EVERY frames, and
+ * as soon as the queue crosses PHX_LINK_LOW_WATER or the chain breaks.
+ */
 void FLIGHT::readDataFromTeensy(Stream &inputSerial) {
-    // TransmitFlightData receiveStruct;
-    if(myTransfer.available()) {
-        // initialize transmission size
-        uint_fast16_t trSz = 0;
-
-        // transmit struct field by field;
-        trSz = myTransfer.rxObj(output.lsm_gyro.x, trSz);
-        trSz = myTransfer.rxObj(output.lsm_gyro.y, trSz);
-        trSz = myTransfer.rxObj(output.lsm_gyro.z, trSz);
-
-        trSz = myTransfer.rxObj(output.lsm_acc.x, trSz);
-        trSz = myTransfer.rxObj(output.lsm_acc.y, trSz);
-        trSz = myTransfer.rxObj(output.lsm_acc.z, trSz);
-
-        trSz = myTransfer.rxObj(output.adxl_acc.x, trSz);
-        trSz = myTransfer.rxObj(output.adxl_acc.y, trSz);
-        trSz = myTransfer.rxObj(output.adxl_acc.z, trSz);
-
-        trSz = myTransfer.rxObj(output.bno_gyro.x, trSz);
-        trSz = myTransfer.rxObj(output.bno_gyro.y, trSz);
-        trSz = myTransfer.rxObj(output.bno_gyro.z, trSz);
-
-        trSz = myTransfer.rxObj(output.bno_acc.x, trSz);
-        trSz = myTransfer.rxObj(output.bno_acc.y, trSz);
-        trSz = myTransfer.rxObj(output.bno_acc.z, trSz);
-
-        trSz = myTransfer.rxObj(output.bno_mag.x, trSz);
-        trSz = myTransfer.rxObj(output.bno_mag.x, trSz);
-        trSz = myTransfer.rxObj(output.bno_mag.x, trSz);
-
-        trSz = myTransfer.rxObj(output.bno_orientation.w, trSz);
-        trSz = myTransfer.rxObj(output.bno_orientation.x, trSz);
-        trSz = myTransfer.rxObj(output.bno_orientation.y, trSz);
-        trSz = myTransfer.rxObj(output.bno_orientation.z, trSz);
-
-        trSz = myTransfer.rxObj(output.lsm_temp, trSz);
-        trSz = myTransfer.rxObj(output.adxl_temp, trSz);
-        trSz = myTransfer.rxObj(output.bno_temp, trSz);
-        trSz = myTransfer.rxObj(output.bmp_temp, trSz);
-        trSz = myTransfer.rxObj(output.bmp_press, trSz);
-        trSz = myTransfer.rxObj(output.bmp_alt, trSz);
-
-        uint_fast8_t sensor1 = output.sensorStatus[0];
-        uint_fast8_t sensor2 = output.sensorStatus[1];
-        uint_fast8_t sensor3 = output.sensorStatus[2];
-        uint_fast8_t sensor4 = output.sensorStatus[3];
-        // uint_fast8_t sensor5 = output.sensorStatus[4];
-
-        trSz = myTransfer.rxObj(sensor1, trSz);
-        trSz = myTransfer.rxObj(sensor2, trSz);
-        trSz = myTransfer.rxObj(sensor3, trSz);
-        trSz = myTransfer.rxObj(sensor4, trSz);
-        // trSz = myTransfer.rxObj(sensor5, trSz);
-
-        // trSz = myTransfer.rxObj(output.totalTime_ms, trSz);
-
-    }
-    // output = decodeTransmission(receiveStruct);
+    PHX_PROFILE_SCOPE(STAGE_TELEMETRY);
+    (void)inputSerial;
+
+    for(int n = 0; n < PHX_LINK_QUEUE; n++) {
+        uint8_t len = myTransfer.available();
+        if(!len) {
+            break;
+        }
+        if(myTransfer.currentPacketID() != LINK_FRAME) {
+            continue;
+        }
+        link_rx_since_ack++;
+        FlightRecord rec;
+        if(!tlm_rx.decode(myTransfer.packet.rxBuff, len, rec)) {
+            continue;
+        }
+        if(link_queue.push(rec)) {
+            link_rx.queued++;
+        } else {
+            link_rx.overflow++;
+        }
+    }
+    if(link_queue.size() > link_rx.high_water) {
+        link_rx.high_water = link_queue.size();
+    }
+
+    uint8_t flags = 0;
+    if(link_queue.room() < PHX_LINK_LOW_WATER ||
+       (link_ack_flags & LINK_ACK_BUSY && link_queue.room() < PHX_LINK_HIGH_WATER)) {
+        flags |= LINK_ACK_BUSY;
+    }
+    if(tlm_rx.stats().frames + tlm_rx.stats().dropped && !tlm_rx.synced()) {
+        flags |= LINK_ACK_RESYNC;
+    }
+    if(link_rx_since_ack >= PHX_LINK_ACK_EVERY || flags != link_ack_flags) {
+        sendLinkAck(flags);
+    }
+}
+
+void FLIGHT::sendLinkAck(uint8_t flags) {
+    const TelemetryRxStats &st = tlm_rx.stats();
+    LinkAck ack;
+    ack.seq = tlm_rx.lastSequence();
+    ack.room = link_queue.room();
+    ack.flags = flags;
+    ack.applied = st.frames;
+    ack.lost = st.lost;
+    ack.dropped = st.dropped;
+    ack.overflow = link_rx.overflow;
+    myTransfer.sendData(myTransfer.txObj(ack), LINK_ACK);
+
+    link_rx.acks++;
+    link_rx_since_ack = 0;
+    link_ack_flags = flags;
+}
+
+/**
+ * @brief moves the oldest queued record into `output`, on the logging board
+ * @return false if none is waiting
+ *
+ * The board's clock and STATE follow the record, so writeSD,
+ * writeSDBinary and the rate policy behave as on the flight board:
+ *
+ *     flight.readDataFromTeensy(Serial1);
+ *     while(flight.nextLinkRecord()) {
+ *         flight.writeSD(false, file);
+ *     }
+ */
+bool FLIGHT::nextLinkRecord() {
+    FlightRecord rec;
+    if(!link_queue.pop(rec)) {
+        return false;
+    }
+    unpackFlightRecord(rec, output);
+    deltaTime_us = output.time_us - runningTime_us;
+    runningTime_us = output.time_us;
+    runningTime_ms = output.totalTime_ms;
+    loop_ticks++;
+
+    if(output.state != STATE && output.state <= STATES::POST_LANDED) {
+        STATE = (STATES)output.state;
+        noteStateChange();
+    }
+    return true;
 }
 
 void FLIGHT::initTransferSerial(Stream &transferSerial) {
     myTransfer.begin(transferSerial);
 }
 
-// FlightData FLIGHT::decodeTransmission(TransmitFlightData s) {
-//     return {
-//         s.lsm_gyro, s.lsm_acc,
-//         s.adxl_acc,
-//         s.bno_gyro, s.bno_acc, s.bno_mag,
-//         s.bno_orientation,
-//         s.lsm_temp, s.adxl_temp, s.bno_temp,
-//         s.bmp_temp, s.bmp_press, s.bmp_alt,
-//         s.sensorStatus
-//     };
-// }
-
-// TransmitFlightData FLIGHT::prepareToTransmit(FlightData s) {
-//     return {
-//         s.lsm_gyro, s.lsm_acc,
-//         s.adxl_acc,
-//         s.bno_gyro, s.bno_acc, s.bno_mag,
-//         s.bno_orientation,
-//         s.lsm_temp, s.adxl_temp, s.bno_temp,
-//         s.bmp_temp, s.bmp_press, s.bmp_alt,
-//         s.sensorStatus
-//     };
-// }
\ No newline at end of file
+/**
+ * @brief lets calculateState drive the logger's flush and realtime policy
+ * @param l Logger that writeSD/writeSDBinary are given
+ */
+void FLIGHT::attachLogger(SectorLogger &l) {
+    logger = &l;
+    logger->onStateChange(STATE == STATES::FLIGHT_ASCENT);
+}
+
+/**
+ * @brief chooses which BNO055 vectors read_BNO(BNO055Burst &) fetches in a state
+ * @param s flight state the mask applies to
+ * @param fetch BNO_FETCH bits; every state starts with BNO_FETCH_ALL
+ *
+ * Leaving out vectors at either end of the register block shortens the
+ * burst, e.g. BNO_FETCH_GYRO | BNO_FETCH_QUAT reads 20 bytes instead of 32.
+ */
+void FLIGHT::setBnoFetch(STATES s, uint8_t fetch) {
+    bno_fetch[s] = fetch;
+}
+
+/**
+ * @brief holds pad rows in RAM and logs only a heartbeat until liftoff
+ * @param rows the ring's storage, owned by the sketch; PHX_PRETRIGGER_ROWS is a good size
+ * @param n rows in it, at least 2
+ * @param heartbeat_ms spacing of the rows logged before FLIGHT_ASCENT
+ * @return false, and pad logging as usual, if the buffer is too small
+ *
+ * writeSD and writeSDBinary then keep the last `n` rows in `rows`. When
+ * calculateState reaches FLIGHT_ASCENT they write that whole window, so
+ * the seconds before liftoff are logged at full rate. FIFO samples are
+ * not logged on the pad. Call before the first row.
+ */
+bool FLIGHT::enablePretrigger(FlightRecord *rows, uint16_t n, uint32_t heartbeat_ms) {
+    if(!rows || n < 2) {
+        return false;
+    }
+    pretrigger.attach(rows, n);
+    pretrigger_on = true;
+    pretrigger_heartbeat_ms = heartbeat_ms;
+    return true;
+}
+
+/**
+ * @brief sets how many rows are logged and sent in a state
+ * @param s flight state the policy applies to
+ * @param p rows per logged row, per sent row, full-rate time and reduction;
+ * every state starts at full rate
+ */
+void FLIGHT::setRatePolicy(STATES s, const RatePolicy &p) {
+    rate_policy[s] = p;
+}
+
+/**
+ * @brief full rate through ascent and the first 5 s of descent
+ *
+ * The rest of the descent logs one row in 5 with peaks held and sends one
+ * in 2. After landing, one row in 100 is logged as an average and one in
+ * 50 is sent as a beacon.
+ */
+void FLIGHT::useDefaultRatePolicy() {
+    setRatePolicy(STATES::FLIGHT_DESCENT, RatePolicy{ 5, 2, 5000, REDUCE_PEAK });
+    setRatePolicy(STATES::POST_LANDED, RatePolicy{ 100, 50, 0, REDUCE_MEAN });
+}
+
+/**
+ * @brief the current state's policy, at full rate while its `full_ms` runs
+ */
+RatePolicy FLIGHT::currentRate() const {
+    RatePolicy p = rate_policy[STATE];
+    if(p.full_ms && runningTime_ms - state_entered_ms < p.full_ms) {
+        p.log_every = p.serial_every = 1;
+        p.reduce = REDUCE_LAST;
+    }
+    return p;
+}
+
+/**
+ * @brief logs a LOG_EVENT_RATE when `now` differs from what this log last announced
+ */
+void FLIGHT::announceRate(RatePolicy &announced, const RatePolicy &now, Print &out, bool binary) {
+    if(now.log_every == announced.log_every && now.serial_every == announced.serial_every &&
+       now.reduce == announced.reduce) {
+        return;
+    }
+    announced = now;
+
+    LogEventRecord e;
+    e.sync = PHX_LOG_SYNC_EVENT;
+    e.type = LOG_EVENT_RATE;
+    e.time_ms = runningTime_ms;
+    e.state = STATE;
+    e.arg[0] = now.log_every;
+    e.arg[1] = now.serial_every;
+    e.arg[2] = now.reduce;
+    if(binary) {
+        out.write((const uint8_t*)&e, sizeof(e));
+        return;
+    }
+    LineBuffer<PHX_CSV_LINE_MAX> line;
+    printLogEvent(line, e);
+    out.write(line.bytes(), line.length());
+}
+
+/**
+ * @brief logs a LOG_EVENT_HEALTH for each sensor whose SENSOR_HEALTH changed since this log last saw it
+ */
+void FLIGHT::announceHealth(uint8_t announced[SENSOR_COUNT], Print &out, bool binary) {
+    for(uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        const SensorHealth &h = output.health[i];     // the flight board's, on the logging board
+        if(h.state == announced[i]) {
+            continue;
+        }
+        announced[i] = h.state;
+
+        LogEventRecord e;
+        e.sync = PHX_LOG_SYNC_EVENT;
+        e.type = LOG_EVENT_HEALTH;
+        e.time_ms = runningTime_ms;
+        e.state = STATE;
+        e.arg[0] = i;
+        e.arg[1] = h.state;
+        e.arg[2] = h.errors > UINT16_MAX ? UINT16_MAX : h.errors;
+        if(binary) {
+            out.write((const uint8_t*)&e, sizeof(e));
+            continue;
+        }
+        LineBuffer<PHX_CSV_LINE_MAX> line;
+        printLogEvent(line, e);
+        out.write(line.bytes(), line.length());
+    }
+}
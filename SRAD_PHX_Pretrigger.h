@@ -0,0 +1,74 @@
+#ifndef SRAD_PHX_PRETRIGGER_H
+#define SRAD_PHX_PRETRIGGER_H
+
+#include <stdint.h>
+
+#include "SRAD_PHX_Schema.h"
+
+// Suggested ring size and pad logging rate; override with -D.
+#ifndef PHX_PRETRIGGER_ROWS
+#define PHX_PRETRIGGER_ROWS 300             // log rows, 3 s at PHX_RATE_LOG_HZ (~70 KB of the sketch's RAM)
+#endif
+#ifndef PHX_PRETRIGGER_LOG_RESERVE
+#define PHX_PRETRIGGER_LOG_RESERVE 4096     // SectorLogger bytes the dump leaves to live rows and FIFO samples
+#endif
+#ifndef PHX_PRETRIGGER_HEARTBEAT_MS
+#define PHX_PRETRIGGER_HEARTBEAT_MS 1000    // one row per second reaches the log on the pad
+#endif
+
+/**
+ * @brief where one log writer is in the PretriggerRing
+ */
+struct PretriggerCursor {
+    uint32_t next = 0;                      // sequence number of the next row to handle
+    uint64_t last_beat_ms = 0;              // totalTime_ms of the last heartbeat row
+    bool beat = false;                      // a heartbeat row has been written
+    uint32_t written = 0;                   // rows this writer put in the log
+    uint32_t lost = 0;                      // rows overwritten before this writer got to them
+};
+
+/**
+ * @brief the last log rows, in a buffer the sketch provides
+ *
+ * Rows are numbered by a sequence that runs over the whole flight; the
+ * ring holds sequence numbers [begin(), end()). Each writer walks it with
+ * its own PretriggerCursor, so the CSV and binary logs see the same rows
+ * no matter which of them captured a row first. Without a buffer the
+ * ring holds nothing and costs a pointer and two counters.
+ */
+class PretriggerRing {
+    public:
+        PretriggerRing() : rows(nullptr), rows_n(0), head(0) {}
+
+        // at least 2 rows; the ring starts empty
+        void attach(FlightRecord *buf, uint16_t n) {
+            rows = buf;
+            rows_n = n;
+            head = 0;
+        }
+
+        void push(const FlightRecord &r) {
+            rows[head % rows_n] = r;
+            head++;
+        }
+
+        uint32_t begin() const { return head > rows_n ? head - rows_n : 0; }
+        uint32_t end() const { return head; }
+        const FlightRecord& at(uint32_t seq) const { return rows[seq % rows_n]; }
+        uint16_t capacity() const { return rows_n; }
+
+        // moves a cursor that fell out of the ring up to the oldest row held
+        void clamp(PretriggerCursor &c) const {
+            if((int32_t)(c.next - begin()) < 0) {
+                c.lost += begin() - c.next;
+                c.next = begin();
+            }
+        }
+
+    private:
+        FlightRecord *rows;
+        uint16_t rows_n;
+        uint32_t head;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX_Profile.h"
+
+#ifdef PHX_PROFILE
+
+#if !defined(ARM_DWT_CYCCNT) && !defined(ARDUINO)
+#include <chrono>
+uint32_t phxProfileHostTicks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+PHX_PROFILE_STORAGE LoopProfiler PHX_PROFILER;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+    "loop", "read_LSM", "read_BMP", "read_ADXL", "read_BNO", "read_GPS",
+    "calculateState", "writeSD", "writeSERIAL", "writeDEBUG", "telemetry"
+};
+
+static uint8_t bucketOf(uint32_t v) {
+    if(v < 4) {
+        return v;
+    }
+    uint8_t msb = 31 - __builtin_clz(v);
+    return 4 * (msb - 1) + ((v >> (msb - 2)) & 3);
+}
+
+// smallest value that lands in bucket b
+static uint32_t bucketFloor(uint8_t b) {
+    if(b < 4) {
+        return b;
+    }
+    uint8_t msb = b / 4 + 1;
+    return (uint32_t)(4 + b % 4) << (msb - 2);
+}
+
+void StageHistogram::add(uint32_t ticks) {
+    buckets[bucketOf(ticks)]++;
+    count++;
+    total += ticks;
+    if(ticks < min) {
+        min = ticks;
+    }
+    if(ticks > max) {
+        max = ticks;
+    }
+}
+
+/**
+ * @brief upper edge of the bucket holding the p-th percentile, clamped to max
+ * @param p Fraction between 0 and 1, e.g. 0.99
+ */
+uint32_t StageHistogram::percentile(float p) const {
+    if(!count) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(p * count);
+    uint32_t seen = 0;
+    for(uint8_t b = 0; b < PHX_PROFILE_BUCKETS; b++) {
+        seen += buckets[b];
+        if(seen > rank) {
+            uint32_t edge = b + 1 < PHX_PROFILE_BUCKETS ? bucketFloor(b + 1) - 1 : max;
+            return edge < max ? edge : max;
+        }
+    }
+    return max;
+}
+
+void LoopProfiler::reset() {
+    memset(stages, 0, sizeof(stages));
+    for(StageHistogram &s : stages) {
+        s.min = UINT32_MAX;
+    }
+    last_loop = 0;
+    last_report_ms = millis();
+}
+
+/**
+ * @brief records the time since the previous call as one loop period
+ */
+void LoopProfiler::markLoop() {
+    uint32_t now = PHX_PROFILE_NOW();
+    if(last_loop) {
+        record(STAGE_LOOP, now - last_loop);
+    }
+    last_loop = now;
+}
+
+static void printUs(Print &out, uint32_t ticks) {
+    out.print((float)ticks / PHX_PROFILE_TICKS_PER_US, 2);
+}
+
+/**
+ * @brief prints one line per stage: count, min, mean, p99 and max in microseconds
+ */
+void LoopProfiler::report(Print &out) {
+    out.println("stage, count, min_us, mean_us, p99_us, max_us");
+    for(uint8_t i = 0; i < STAGE_COUNT; i++) {
+        const StageHistogram &s = stages[i];
+        if(!s.count) {
+            continue;
+        }
+        out.print(STAGE_NAMES[i]); out.print(", ");
+        out.print(s.count); out.print(", ");
+        printUs(out, s.min); out.print(", ");
+        printUs(out, s.total / s.count); out.print(", ");
+        printUs(out, s.percentile(0.99f)); out.print(", ");
+        printUs(out, s.max); out.println();
+    }
+}
+
+/**
+ * @brief report() at most once per interval, for use from loop()
+ */
+void LoopProfiler::reportEvery(Print &out, uint32_t interval_ms) {
+    if(millis() - last_report_ms < interval_ms) {
+        return;
+    }
+    last_report_ms = millis();
+    report(out);
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef SRAD_PHX_PROFILE_H
+#define SRAD_PHX_PROFILE_H
+
+// Per-stage loop timing. Build with -DPHX_PROFILE (or uncomment the line
+// below) to enable; otherwise every PHX_PROFILE_* macro expands to nothing
+// and no profiler storage is linked in.
+//
+// #define PHX_PROFILE
+
+#include <Arduino.h>
+
+enum PROFILE_STAGES {
+    STAGE_LOOP = 0,                         // period between incrementTime() calls
+    STAGE_LSM,
+    STAGE_BMP,
+    STAGE_ADXL,
+    STAGE_BNO,
+    STAGE_GPS,
+    STAGE_STATE,
+    STAGE_WRITE_SD,
+    STAGE_WRITE_SERIAL,
+    STAGE_WRITE_DEBUG,
+    STAGE_TELEMETRY,
+    STAGE_COUNT
+};
+
+#ifdef PHX_PROFILE
+
+#if defined(ARM_DWT_CYCCNT)
+    #define PHX_PROFILE_NOW() ((uint32_t)ARM_DWT_CYCCNT)
+    #define PHX_PROFILE_TICKS_PER_US (F_CPU_ACTUAL / 1000000)
+#elif defined(ARDUINO)
+    #define PHX_PROFILE_NOW() micros()
+    #define PHX_PROFILE_TICKS_PER_US 1
+#else
+    // host builds run on a simulated clock, so time the real one
+    uint32_t phxProfileHostTicks();
+    #define PHX_PROFILE_NOW() phxProfileHostTicks()
+    #define PHX_PROFILE_TICKS_PER_US 1000
+#endif
+
+// 4 log-linear buckets per power of two: <25% error on any percentile
+#define PHX_PROFILE_BUCKETS 124
+
+struct StageHistogram {
+    uint32_t buckets[PHX_PROFILE_BUCKETS];
+    uint32_t count;
+    uint32_t min, max;                      // ticks
+    uint64_t total;
+
+    void add(uint32_t ticks);
+    uint32_t percentile(float p) const;
+};
+
+/**
+ * @brief fixed-memory latency histograms for every PROFILE_STAGES entry
+ */
+class LoopProfiler {
+    public:
+        LoopProfiler() { reset(); }
+
+        void record(uint8_t stage, uint32_t ticks) { stages[stage].add(ticks); }
+        void markLoop();
+        void reset();
+        void report(Print &);
+        void reportEvery(Print &, uint32_t interval_ms);
+
+        const StageHistogram& stage(uint8_t s) const { return stages[s]; }
+
+    private:
+        StageHistogram stages[STAGE_COUNT];
+        uint32_t last_loop;
+        uint32_t last_report_ms;
+};
+
+// host tools that run several FLIGHTs on their own threads build with
+// -DPHX_PROFILE_STORAGE=thread_local, so each thread keeps its own histograms
+#ifndef PHX_PROFILE_STORAGE
+#define PHX_PROFILE_STORAGE
+#endif
+
+extern PHX_PROFILE_STORAGE LoopProfiler PHX_PROFILER;
+
+class ProfileScope {
+    public:
+        ProfileScope(uint8_t s) : stage(s), start(PHX_PROFILE_NOW()) {}
+        ~ProfileScope() { PHX_PROFILER.record(stage, PHX_PROFILE_NOW() - start); }
+    private:
+        uint8_t stage;
+        uint32_t start;
+};
+
+#define PHX_PROFILE_SCOPE(stage)            ProfileScope phx_profile_scope_(stage)
+#define PHX_PROFILE_LOOP()                  PHX_PROFILER.markLoop()
+#define PHX_PROFILE_REPORT(out, interval)   PHX_PROFILER.reportEvery(out, interval)
+
+#else
+
+#define PHX_PROFILE_SCOPE(stage)            do {} while(0)
+#define PHX_PROFILE_LOOP()                  do {} while(0)
+#define PHX_PROFILE_REPORT(out, interval)   do {} while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SRAD_PHX_QUEUE_H
+#define SRAD_PHX_QUEUE_H
+
+// Lock-free single-producer/single-consumer ring for handing samples
+// from an interrupt to the main loop. No Arduino dependency, so the same
+// code runs between two threads on Linux.
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief fixed-capacity SPSC ring
+ *
+ * `push()` may only be called from one context (the ISR) and `pop()`
+ * from one other (the loop). Head and tail are free-running 32-bit
+ * counters: only the producer writes head, only the consumer writes
+ * tail, and each publishes with a release store that the other side
+ * reads with an acquire load, so slots are never read half-written.
+ * A full ring drops the new item and counts it; the producer never waits.
+ *
+ * @tparam T trivially copyable item
+ * @tparam N capacity, a power of two
+ */
+template <class T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+        SpscQueue() : head(0), tail(0), dropped(0), high_water(0) {}
+
+        // producer side
+        bool push(const T &item) {
+            uint32_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+            uint32_t used = h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+            if(used == N) {
+                __atomic_store_n(&dropped, dropped + 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            slots[h & (N - 1)] = item;
+            __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+            if(used + 1 > high_water) {
+                __atomic_store_n(&high_water, used + 1, __ATOMIC_RELAXED);
+            }
+            return true;
+        }
+
+        // consumer side: moves up to `max` items into `out`, oldest first
+        uint32_t pop(T *out, uint32_t max) {
+            uint32_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+            uint32_t avail = __atomic_load_n(&head, __ATOMIC_ACQUIRE) - t;
+            uint32_t n = avail < max ? avail : max;
+            for(uint32_t i = 0; i < n; i++) {
+                out[i] = slots[(t + i) & (N - 1)];
+            }
+            __atomic_store_n(&tail, t + n, __ATOMIC_RELEASE);
+            return n;
+        }
+
+        // either side; a snapshot that may already be stale
+        uint32_t size() const {
+            return __atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        }
+        uint32_t overflows() const { return __atomic_load_n(&dropped, __ATOMIC_RELAXED); }
+        uint32_t highWater() const { return __atomic_load_n(&high_water, __ATOMIC_RELAXED); }
+        static uint32_t capacity() { return N; }
+
+    private:
+        T slots[N];
+        uint32_t head;                      // written by the producer only
+        uint32_t tail;                      // written by the consumer only
+        uint32_t dropped;                   // producer: items refused while full
+        uint32_t high_water;                // producer: most items ever queued
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SRAD_PHX_RATEPOLICY_H
+#define SRAD_PHX_RATEPOLICY_H
+
+// How many rows each flight state logs and sends, and how the rows in
+// between are folded into the one that goes out. No Arduino dependency.
+
+#include <math.h>
+#include <stdint.h>
+
+#include "SRAD_PHX_Schema.h"
+
+enum RATE_REDUCE : uint8_t {
+    REDUCE_LAST = 0,                        // plain decimation, the newest row
+    REDUCE_MEAN = 1,                        // PHX_F_RATE fields averaged, the rest from the newest row
+    REDUCE_PEAK = 2,                        // PHX_F_RATE fields at their largest magnitude, sign kept
+};
+
+/**
+ * @brief one state's entry in FLIGHT's rate table
+ *
+ * `log_every` rows become one row for writeSD/writeSDBinary,
+ * `serial_every` rows one for writeSERIAL. For `full_ms` after the state
+ * is entered both run at full rate, e.g. the seconds after apogee at the
+ * start of FLIGHT_DESCENT.
+ */
+struct RatePolicy {
+    uint16_t log_every;
+    uint16_t serial_every;
+    uint16_t full_ms;
+    uint8_t reduce;                         // RATE_REDUCE
+};
+
+// FlightRecord is packed, so fields are passed and returned by value
+inline float reduceField(float acc, float v, uint16_t n, uint8_t reduce) {
+    if(reduce == REDUCE_MEAN) {
+        return n == 0 ? v : acc + v;
+    }
+    if(reduce == REDUCE_PEAK) {
+        return n == 0 || isnan(acc) || fabsf(v) > fabsf(acc) ? v : acc;
+    }
+    return v;
+}
+template <class T> inline T reduceField(T, T v, uint16_t, uint8_t) { return v; }
+
+/**
+ * @brief folds consecutive rows into one every `every` rows
+ *
+ * Only the accel and gyro channels (PHX_F_RATE in the schema) are
+ * reduced; every other field is that of the newest row.
+ * If the policy changes part way through a window, the window is closed
+ * early with the row that brought the change, so no row is lost.
+ * `update()` may be called by several writers in the same loop; only the
+ * first call with a new tick adds the row.
+ */
+class RowReducer {
+    public:
+        RowReducer() : n(0), every(1), reduce(REDUCE_LAST), tick(0), started(false), due(false) {}
+
+        bool update(uint32_t loop_tick, const FlightRecord &r, uint16_t new_every, uint8_t new_reduce) {
+            if(started && loop_tick == tick) {
+                return due;
+            }
+            started = true;
+            tick = loop_tick;
+            if(new_every < 1) new_every = 1;
+            bool changed = n && (new_every != every || new_reduce != reduce);
+
+            uint8_t how = n ? reduce : new_reduce;
+#define PHX_REDUCE_FIELD(name, type, precision, tlm, member, label, flags) \
+            acc.name = reduceField(acc.name, r.name, n, ((flags) & PHX_F_RATE) ? how : (uint8_t)REDUCE_LAST);
+            PHX_FLIGHT_FIELDS(PHX_REDUCE_FIELD)
+#undef PHX_REDUCE_FIELD
+            n++;
+
+            if(!changed) {
+                every = new_every;
+                reduce = new_reduce;
+            }
+            due = changed || n >= every;
+            if(due) {
+                if(reduce == REDUCE_MEAN && n > 1) {
+#define PHX_MEAN_FIELD(name, type, precision, tlm, member, label, flags) \
+                    if((flags) & PHX_F_RATE) { acc.name = divide(acc.name, n); }
+                    PHX_FLIGHT_FIELDS(PHX_MEAN_FIELD)
+#undef PHX_MEAN_FIELD
+                }
+                out = acc;
+                n = 0;
+                every = new_every;
+                reduce = new_reduce;
+            }
+            return due;
+        }
+
+        const FlightRecord& row() const { return out; }
+
+    private:
+        static float divide(float v, uint16_t k) { return v / k; }
+        template <class T> static T divide(T v, uint16_t) { return v; }
+
+        FlightRecord acc, out;
+        uint16_t n, every;
+        uint8_t reduce;
+        uint32_t tick;
+        bool started, due;
+};
+
+#endif
@@ -0,0 +1,220 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "SRAD_PHX.h"
+
+TaskScheduler::TaskScheduler() : n_tasks(0), on_miss(nullptr) {}
+
+/**
+ * @brief adds a task, first due immediately
+ * @param period_us time between releases
+ * @param deadline_us how late a run may start before it counts as a miss; 0 means one period
+ * @return task id, or -1 if the table is full
+ */
+int8_t TaskScheduler::add(const char *name, SchedFn fn, void *ctx, uint32_t period_us, uint32_t deadline_us) {
+    if(n_tasks == PHX_SCHED_MAX_TASKS || period_us == 0) {
+        return -1;
+    }
+    SchedTask &t = tasks[n_tasks];
+    memset(&t, 0, sizeof(t));
+    t.name = name;
+    t.fn = fn;
+    t.ctx = ctx;
+    t.period_us = period_us;
+    t.deadline_us = deadline_us ? deadline_us : period_us;
+    t.next_due_us = micros();
+    t.enabled = true;
+    return n_tasks++;
+}
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t period_us, uint32_t deadline_us) {
+    if(id < 0 || id >= n_tasks || period_us == 0) {
+        return;
+    }
+    tasks[id].period_us = period_us;
+    tasks[id].deadline_us = deadline_us ? deadline_us : period_us;
+}
+
+/**
+ * @brief pauses or resumes a task; a resumed task is due immediately
+ */
+void TaskScheduler::enable(int8_t id, bool on) {
+    if(id < 0 || id >= n_tasks) {
+        return;
+    }
+    if(on && !tasks[id].enabled) {
+        tasks[id].next_due_us = micros();
+    }
+    tasks[id].enabled = on;
+}
+
+/**
+ * @brief called with the task and how late it started whenever a deadline is missed
+ */
+void TaskScheduler::setMissHandler(void (*fn)(const SchedTask &, uint32_t)) {
+    on_miss = fn;
+}
+
+/**
+ * @brief runs the due task with the nearest deadline
+ * @return true if a task ran; call again until it returns false
+ */
+bool TaskScheduler::service() {
+    uint32_t now = micros();
+
+    int8_t pick = -1;
+    int32_t pick_slack = 0;
+    for(uint8_t i = 0; i < n_tasks; i++) {
+        const SchedTask &t = tasks[i];
+        if(!t.enabled || (int32_t)(now - t.next_due_us) < 0) {
+            continue;
+        }
+        int32_t slack = (int32_t)(t.next_due_us + t.deadline_us - now);
+        if(pick < 0 || slack < pick_slack) {
+            pick = i;
+            pick_slack = slack;
+        }
+    }
+    if(pick < 0) {
+        return false;
+    }
+
+    SchedTask &t = tasks[pick];
+    uint32_t late = now - t.next_due_us;
+    if(late > t.max_late_us) {
+        t.max_late_us = late;
+    }
+    if(late > t.deadline_us) {
+        t.misses++;
+        if(on_miss) {
+            on_miss(t, late);
+        }
+    }
+
+    t.last_run_us = now;
+    t.fn(t.ctx);
+    t.runs++;
+
+    uint32_t end = micros();
+    if(end - now > t.max_run_us) {
+        t.max_run_us = end - now;
+    }
+
+    // stay on the release grid; drop whole periods rather than bursting to catch up.
+    // A release at exactly `end` is on time, so only earlier ones are dropped.
+    t.next_due_us += t.period_us;
+    if((int32_t)(end - t.next_due_us) > 0) {
+        uint32_t behind = (end - t.next_due_us - 1) / t.period_us + 1;
+        t.skipped += behind;
+        t.next_due_us += behind * t.period_us;
+    }
+    return true;
+}
+
+/**
+ * @brief time the next task is due, for sleeping or for stepping a simulated clock
+ */
+uint32_t TaskScheduler::nextDue() const {
+    uint32_t now = micros();
+    uint32_t best = now + 0x7FFFFFFF;
+    for(uint8_t i = 0; i < n_tasks; i++) {
+        if(tasks[i].enabled && (int32_t)(tasks[i].next_due_us - best) < 0) {
+            best = tasks[i].next_due_us;
+        }
+    }
+    return best;
+}
+
+uint32_t TaskScheduler::misses() const {
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < n_tasks; i++) {
+        total += tasks[i].misses;
+    }
+    return total;
+}
+
+void TaskScheduler::resetStats() {
+    for(uint8_t i = 0; i < n_tasks; i++) {
+        SchedTask &t = tasks[i];
+        t.runs = t.misses = t.skipped = t.max_late_us = t.max_run_us = 0;
+    }
+}
+
+/**
+ * @brief one line per task: rate, runs, deadline misses and worst lateness/run time
+ */
+void TaskScheduler::report(Print &out) const {
+    out.println("task       hz      runs    misses  skipped  max late us  max run us");
+    for(uint8_t i = 0; i < n_tasks; i++) {
+        const SchedTask &t = tasks[i];
+        char line[96];
+        snprintf(line, sizeof(line), "%-8s %6lu %9lu %9lu %8lu %12lu %11lu",
+                 t.name, (unsigned long)(1000000UL / t.period_us), (unsigned long)t.runs,
+                 (unsigned long)t.misses, (unsigned long)t.skipped,
+                 (unsigned long)t.max_late_us, (unsigned long)t.max_run_us);
+        out.println(line);
+    }
+}
+
+void FlightTasks::runLSM(void *c)    { FlightTasks *t = (FlightTasks *)c; t->flight.read_LSM(*t->lsm); }
+void FlightTasks::runLSMFifo(void *c) { FlightTasks *t = (FlightTasks *)c; t->flight.read_LSM(*t->lsmFifo); }
+void FlightTasks::runBMP(void *c)    { FlightTasks *t = (FlightTasks *)c; t->flight.read_BMP(*t->bmp); }
+void FlightTasks::runADXL(void *c)   { FlightTasks *t = (FlightTasks *)c; t->flight.read_ADXL(*t->adxl); }
+void FlightTasks::runADXLFifo(void *c) { FlightTasks *t = (FlightTasks *)c; t->flight.read_ADXL(*t->adxlFifo); }
+void FlightTasks::runBNO(void *c)    { FlightTasks *t = (FlightTasks *)c; t->flight.read_BNO(*t->bno); }
+void FlightTasks::runBNOBurst(void *c) { FlightTasks *t = (FlightTasks *)c; t->flight.read_BNO(*t->bnoBurst); }
+void FlightTasks::runIMU(void *c)    { FlightTasks *t = (FlightTasks *)c; t->flight.read_IMU(*t->imu); }
+void FlightTasks::runGPS(void *c)    { FlightTasks *t = (FlightTasks *)c; t->flight.read_GPS(*t->gps); }
+void FlightTasks::runSerial(void *c) { FlightTasks *t = (FlightTasks *)c; t->flight.writeSERIAL(false, *t->serial); }
+void FlightTasks::runLogger(void *c) { ((FlightTasks *)c)->logger->service(); }
+
+void FlightTasks::runState(void *c) {
+    FlightTasks *t = (FlightTasks *)c;
+    t->flight.incrementTime();
+    t->flight.calculateState();
+}
+
+void FlightTasks::runLog(void *c) {
+    FlightTasks *t = (FlightTasks *)c;
+    if(t->sd) {
+        t->flight.writeSD(false, *t->sd);
+    }
+    if(t->sdBinary) {
+        t->flight.writeSDBinary(false, *t->sdBinary);
+        if(t->lsmFifo || t->adxlFifo || t->imu) {
+            t->flight.writeSamplesBinary(*t->sdBinary);
+        }
+    }
+}
+
+/**
+ * @brief registers one task per configured device or sink
+ *
+ * Sensor reads get a deadline of half their period so a late high-rate
+ * read is reported before it turns into a dropped sample. FIFO drains
+ * run at PHX_RATE_FIFO_HZ; the chip keeps the samples in between. So
+ * does the data-ready queue, which replaces both accelerometer tasks.
+ */
+void FlightTasks::attach(TaskScheduler &s) {
+    if(imu)            lsm_task  = s.add("imu",  runIMU,      this, 1000000UL / PHX_RATE_FIFO_HZ, 500000UL / PHX_RATE_FIFO_HZ);
+    else if(lsmFifo)   lsm_task  = s.add("lsm",  runLSMFifo,  this, 1000000UL / PHX_RATE_FIFO_HZ, 500000UL / PHX_RATE_FIFO_HZ);
+    else if(lsm)       lsm_task  = s.add("lsm",  runLSM,      this, 1000000UL / PHX_RATE_LSM_HZ,  500000UL / PHX_RATE_LSM_HZ);
+    if(imu)            adxl_task = -1;     // read by the imu task
+    else if(adxlFifo)  adxl_task = s.add("adxl", runADXLFifo, this, 1000000UL / PHX_RATE_FIFO_HZ, 500000UL / PHX_RATE_FIFO_HZ);
+    else if(adxl)      adxl_task = s.add("adxl", runADXL,     this, 1000000UL / PHX_RATE_ADXL_HZ, 500000UL / PHX_RATE_ADXL_HZ);
+    if(bmp)    bmp_task    = s.add("bmp",    runBMP,    this, 1000000UL / PHX_RATE_BMP_HZ,  500000UL / PHX_RATE_BMP_HZ);
+    if(bnoBurst)  bno_task  = s.add("bno",  runBNOBurst, this, 1000000UL / PHX_RATE_BNO_HZ,  500000UL / PHX_RATE_BNO_HZ);
+    else if(bno)  bno_task  = s.add("bno",  runBNO,      this, 1000000UL / PHX_RATE_BNO_HZ,  500000UL / PHX_RATE_BNO_HZ);
+    if(gps)    gps_task    = s.add("gps",    runGPS,    this, 1000000UL / PHX_RATE_GPS_HZ);
+    state_task = s.add("state", runState, this, 1000000UL / PHX_RATE_STATE_HZ);
+    if(sd || sdBinary) log_task = s.add("log", runLog, this, 1000000UL / PHX_RATE_LOG_HZ);
+    if(serial) serial_task = s.add("serial", runSerial, this, 1000000UL / PHX_RATE_SERIAL_HZ);
+    if(logger) logger_task = s.add("logger", runLogger, this, 1000000UL / PHX_RATE_LOGGER_HZ);
+}
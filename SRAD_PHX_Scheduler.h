@@ -0,0 +1,156 @@
+#ifndef SRAD_PHX_SCHEDULER_H
+#define SRAD_PHX_SCHEDULER_H
+
+#include <Arduino.h>
+
+#ifndef PHX_SCHED_MAX_TASKS
+#define PHX_SCHED_MAX_TASKS 12
+#endif
+
+// Default task rates used by FlightTasks; override with -D.
+#ifndef PHX_RATE_LSM_HZ
+#define PHX_RATE_LSM_HZ 1000                // LSM6DSO32 can run to 6.66 kHz
+#endif
+#ifndef PHX_RATE_ADXL_HZ
+#define PHX_RATE_ADXL_HZ 800
+#endif
+#ifndef PHX_RATE_FIFO_HZ
+#define PHX_RATE_FIFO_HZ 100                // LSM/ADXL FIFO drains, each takes every sample since the last
+#endif
+#ifndef PHX_RATE_BMP_HZ
+#define PHX_RATE_BMP_HZ 50                  // BMP388 ODR with 2x oversampling
+#endif
+#ifndef PHX_RATE_BNO_HZ
+#define PHX_RATE_BNO_HZ 100                 // BNO055 fusion output rate
+#endif
+#ifndef PHX_RATE_GPS_HZ
+#define PHX_RATE_GPS_HZ 20                  // drains the UART, fixes arrive at 1-10 Hz
+#endif
+#ifndef PHX_RATE_STATE_HZ
+#define PHX_RATE_STATE_HZ 100
+#endif
+#ifndef PHX_RATE_LOG_HZ
+#define PHX_RATE_LOG_HZ 100
+#endif
+#ifndef PHX_RATE_SERIAL_HZ
+#define PHX_RATE_SERIAL_HZ 10
+#endif
+#ifndef PHX_RATE_LOGGER_HZ
+#define PHX_RATE_LOGGER_HZ 200              // SectorLogger::service()
+#endif
+
+typedef void (*SchedFn)(void *);
+
+struct SchedTask {
+    const char *name;
+    SchedFn fn;
+    void *ctx;
+    uint32_t period_us;
+    uint32_t deadline_us;                   // allowed start lateness after the due time
+    uint32_t next_due_us;
+    uint32_t last_run_us;                   // start time of the latest run
+    uint32_t runs;
+    uint32_t misses;                        // runs that started after due + deadline
+    uint32_t skipped;                       // whole periods dropped to catch up
+    uint32_t max_late_us;
+    uint32_t max_run_us;
+    bool enabled;
+};
+
+/**
+ * @brief cooperative fixed-rate scheduler
+ *
+ * Every task has a period and a start deadline. Each `service()` call
+ * runs at most one due task, the one whose deadline is nearest, so a
+ * slow task only delays the others by its own run time. Tasks are
+ * released on a fixed grid (due += period) so their rate does not drift;
+ * if a task falls more than a period behind, the missed periods are
+ * dropped and counted instead of being run back to back.
+ */
+class TaskScheduler {
+    public:
+        TaskScheduler();
+
+        int8_t add(const char *name, SchedFn fn, void *ctx, uint32_t period_us, uint32_t deadline_us = 0);
+        void setPeriod(int8_t id, uint32_t period_us, uint32_t deadline_us = 0);
+        void enable(int8_t id, bool on);
+        void setMissHandler(void (*)(const SchedTask &, uint32_t late_us));
+
+        bool service();
+        uint32_t nextDue() const;
+        void resetStats();
+        void report(Print &) const;
+
+        uint8_t count() const { return n_tasks; }
+        const SchedTask& task(uint8_t i) const { return tasks[i]; }
+        uint32_t misses() const;
+
+    private:
+        SchedTask tasks[PHX_SCHED_MAX_TASKS];
+        uint8_t n_tasks;
+        void (*on_miss)(const SchedTask &, uint32_t);
+};
+
+class FLIGHT;
+class Adafruit_LSM6DSO32;
+class Adafruit_BMP3XX;
+class Adafruit_ADXL375;
+class Adafruit_BNO055;
+class LSM6DSO32Fifo;
+class ADXL375Fifo;
+class BNO055Burst;
+class DrdyAcquisition;
+class Adafruit_GPS;
+class SectorLogger;
+
+/**
+ * @brief the flight loop as scheduler tasks
+ *
+ * Set the devices and sinks that exist on this board, then call
+ * `attach()`. Anything left null is not scheduled. The state task runs
+ * incrementTime() and calculateState() at PHX_RATE_STATE_HZ regardless
+ * of how long any sensor takes.
+ */
+class FlightTasks {
+    public:
+        FlightTasks(FLIGHT &f) : flight(f) {}
+
+        void attach(TaskScheduler &);
+
+        Adafruit_LSM6DSO32 *lsm = nullptr;
+        Adafruit_BMP3XX *bmp = nullptr;
+        Adafruit_ADXL375 *adxl = nullptr;
+        Adafruit_BNO055 *bno = nullptr;
+        Adafruit_GPS *gps = nullptr;
+        LSM6DSO32Fifo *lsmFifo = nullptr;   // used instead of lsm when set
+        ADXL375Fifo *adxlFifo = nullptr;    // used instead of adxl when set
+        BNO055Burst *bnoBurst = nullptr;    // used instead of bno when set
+        DrdyAcquisition *imu = nullptr;     // used instead of both accelerometers when set
+        Print *sd = nullptr;                // writeSD
+        Print *sdBinary = nullptr;          // writeSDBinary
+        Stream *serial = nullptr;           // writeSERIAL
+        SectorLogger *logger = nullptr;     // service()
+
+        // task ids, -1 when not scheduled
+        int8_t lsm_task = -1, bmp_task = -1, adxl_task = -1, bno_task = -1, gps_task = -1;
+        int8_t state_task = -1, log_task = -1, serial_task = -1, logger_task = -1;
+
+    private:
+        static void runLSM(void *);
+        static void runLSMFifo(void *);
+        static void runBMP(void *);
+        static void runADXL(void *);
+        static void runADXLFifo(void *);
+        static void runBNO(void *);
+        static void runBNOBurst(void *);
+        static void runIMU(void *);
+        static void runGPS(void *);
+        static void runState(void *);
+        static void runLog(void *);
+        static void runSerial(void *);
+        static void runLogger(void *);
+
+        FLIGHT &flight;
+};
+
+#endif
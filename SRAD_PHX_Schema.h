@@ -0,0 +1,172 @@
+#ifndef SRAD_PHX_SCHEMA_H
+#define SRAD_PHX_SCHEMA_H
+
+// The single description of every FlightData field that leaves the board.
+// The CSV and debug writers, the binary log record, the Teensy link and
+// the host decoder are all generated from PHX_FLIGHT_FIELDS, so adding a
+// field here adds it everywhere. Like SRAD_PHX_Log.h this header must not
+// depend on Arduino.
+//
+// X(name, type, precision, tlm, member, label, flags)
+//   name       column name, and member name in FlightRecord
+//   type       wire type: U8, U16, U32, U64 or F32
+//   precision  digits after the decimal point in text output
+//   member     expression that reaches the value inside FlightData
+//   label      human readable name used by writeDEBUG
+//   flags      PHX_F_* bits
+//
+// Rows decimated by the rate policy keep the newest row's value of every
+// field except the PHX_F_RATE ones. A peak or mean of a quaternion, a
+// position, a pressure or a filter state is a value the rocket never had.
+//
+// The us_* sample stamps are the low 32 bits of the 64-bit microsecond
+// clock. The full stamp is the one within half a wrap (35 minutes) of
+// the row's time_us, as MicrosClock::widen computes it.
+
+#include <stdint.h>
+
+#define PHX_F_NONE  0
+#define PHX_F_GPS   1                       // left blank in text output while there is no fix
+#define PHX_F_RATE  2                       // accel/gyro channel: decimated rows take its mean or peak
+
+#define PHX_FLIGHT_FIELDS(X) \
+    X(totalTime_ms, U64, 0, 0, totalTime_ms,             "Uptime (ms)",           PHX_F_NONE) \
+    X(time_us,      U64, 0, 0, time_us,                  "Uptime (us)",           PHX_F_NONE) \
+    X(state,        U8,  0, 0, state,                    "State",                 PHX_F_NONE) \
+    X(gps_fix,      U8,  0, 0, gps.fix,                  "GPS fix",               PHX_F_NONE) \
+    X(gps_lat,      F32, 6, 6, gps.latitudeDegrees,      "GPS Latitude Degrees",  PHX_F_GPS)  \
+    X(gps_lon,      F32, 6, 6, gps.longitudeDegrees,     "GPS Longitude Degrees", PHX_F_GPS)  \
+    X(gps_sats,     U8,  0, 0, gps.satellites,           "GPS satellites",        PHX_F_GPS)  \
+    X(gps_speed,    F32, 3, 2, gps.speed,                "GPS speed",             PHX_F_GPS)  \
+    X(gps_angle,    F32, 3, 2, gps.angle,                "GPS angle",             PHX_F_GPS)  \
+    X(gps_alt,      F32, 3, 2, gps.altitude,             "GPS altitude",          PHX_F_GPS)  \
+    X(bno_quat_w,   F32, 5, 4, bno_orientation.w,        "BNO W-Orientation",     PHX_F_NONE) \
+    X(bno_quat_x,   F32, 5, 4, bno_orientation.x,        "BNO X-Orientation",     PHX_F_NONE) \
+    X(bno_quat_y,   F32, 5, 4, bno_orientation.y,        "BNO Y-Orientation",     PHX_F_NONE) \
+    X(bno_quat_z,   F32, 5, 4, bno_orientation.z,        "BNO Z-Orientation",     PHX_F_NONE) \
+    X(bno_gyro_x,   F32, 5, 3, bno_gyro.x,               "BNO X-Gyro",            PHX_F_RATE) \
+    X(bno_gyro_y,   F32, 5, 3, bno_gyro.y,               "BNO Y-Gyro",            PHX_F_RATE) \
+    X(bno_gyro_z,   F32, 5, 3, bno_gyro.z,               "BNO Z-Gyro",            PHX_F_RATE) \
+    X(bno_acc_x,    F32, 4, 2, bno_acc.x,                "BNO X-Accel",           PHX_F_RATE) \
+    X(bno_acc_y,    F32, 4, 2, bno_acc.y,                "BNO Y-Accel",           PHX_F_RATE) \
+    X(bno_acc_z,    F32, 4, 2, bno_acc.z,                "BNO Z-Accel",           PHX_F_RATE) \
+    X(bno_mag_x,    F32, 4, 1, bno_mag.x,                "BNO X-Mag",             PHX_F_NONE) \
+    X(bno_mag_y,    F32, 4, 1, bno_mag.y,                "BNO Y-Mag",             PHX_F_NONE) \
+    X(bno_mag_z,    F32, 4, 1, bno_mag.z,                "BNO Z-Mag",             PHX_F_NONE) \
+    X(adxl_acc_x,   F32, 2, 1, adxl_acc.x,               "ADXL X-Accel",          PHX_F_RATE) \
+    X(adxl_acc_y,   F32, 2, 1, adxl_acc.y,               "ADXL Y-Accel",          PHX_F_RATE) \
+    X(adxl_acc_z,   F32, 2, 1, adxl_acc.z,               "ADXL Z-Accel",          PHX_F_RATE) \
+    X(lsm_gyro_x,   F32, 5, 3, lsm_gyro.x,               "LSM X-Gyro",            PHX_F_RATE) \
+    X(lsm_gyro_y,   F32, 5, 3, lsm_gyro.y,               "LSM Y-Gyro",            PHX_F_RATE) \
+    X(lsm_gyro_z,   F32, 5, 3, lsm_gyro.z,               "LSM Z-Gyro",            PHX_F_RATE) \
+    X(lsm_acc_x,    F32, 4, 2, lsm_acc.x,                "LSM X-Accel",           PHX_F_RATE) \
+    X(lsm_acc_y,    F32, 4, 2, lsm_acc.y,                "LSM Y-Accel",           PHX_F_RATE) \
+    X(lsm_acc_z,    F32, 4, 2, lsm_acc.z,                "LSM Z-Accel",           PHX_F_RATE) \
+    X(bmp_press,    F32, 6, 1, bmp_press,                "BMP Pressure",          PHX_F_NONE) \
+    X(bmp_alt,      F32, 4, 2, bmp_alt,                  "BMP Altitude",          PHX_F_NONE) \
+    X(lsm_temp,     F32, 2, 1, lsm_temp,                 "LSM Temp",              PHX_F_NONE) \
+    X(adxl_temp,    F32, 2, 1, adxl_temp,                "ADXL Temp",             PHX_F_NONE) \
+    X(bno_temp,     F32, 2, 1, bno_temp,                 "BNO Temp",              PHX_F_NONE) \
+    X(bmp_temp,     F32, 2, 1, bmp_temp,                 "BMP Temp",              PHX_F_NONE) \
+    X(est_alt,      F32, 3, 2, est_alt,                  "Est. Altitude AGL",     PHX_F_NONE) \
+    X(est_vel,      F32, 3, 2, est_vel,                  "Est. Vertical Vel",     PHX_F_NONE) \
+    X(est_acc,      F32, 3, 2, est_acc,                  "Est. Vertical Accel",   PHX_F_NONE) \
+    X(acc_source,   U8,  0, 0, acc_source,               "Accel source",          PHX_F_NONE) \
+    X(att_tilt,     F32, 2, 1, att_tilt,                 "Tilt",                  PHX_F_NONE) \
+    X(att_acc_up,   F32, 3, 2, att_acc_up,               "Att. Vertical Accel",   PHX_F_NONE) \
+    X(status_lsm,   U8,  0, 0, sensorStatus[0],          "LSM status",            PHX_F_NONE) \
+    X(status_bmp,   U8,  0, 0, sensorStatus[1],          "BMP status",            PHX_F_NONE) \
+    X(status_adxl,  U8,  0, 0, sensorStatus[2],          "ADXL status",           PHX_F_NONE) \
+    X(status_bno,   U8,  0, 0, sensorStatus[3],          "BNO status",            PHX_F_NONE) \
+    X(status_gps,   U8,  0, 0, sensorStatus[4],          "GPS status",            PHX_F_NONE) \
+    X(health_lsm,   U8,  0, 0, health[0].state,          "LSM health",            PHX_F_NONE) \
+    X(health_bmp,   U8,  0, 0, health[1].state,          "BMP health",            PHX_F_NONE) \
+    X(health_adxl,  U8,  0, 0, health[2].state,          "ADXL health",           PHX_F_NONE) \
+    X(health_bno,   U8,  0, 0, health[3].state,          "BNO health",            PHX_F_NONE) \
+    X(health_gps,   U8,  0, 0, health[4].state,          "GPS health",            PHX_F_NONE) \
+    X(errors_lsm,   U32, 0, 0, health[0].errors,         "LSM errors",            PHX_F_NONE) \
+    X(errors_bmp,   U32, 0, 0, health[1].errors,         "BMP errors",            PHX_F_NONE) \
+    X(errors_adxl,  U32, 0, 0, health[2].errors,         "ADXL errors",           PHX_F_NONE) \
+    X(errors_bno,   U32, 0, 0, health[3].errors,         "BNO errors",            PHX_F_NONE) \
+    X(errors_gps,   U32, 0, 0, health[4].errors,         "GPS errors",            PHX_F_NONE) \
+    X(lat_lsm,      U16, 0, 0, health[0].max_us,         "LSM peak us",           PHX_F_NONE) \
+    X(lat_bmp,      U16, 0, 0, health[1].max_us,         "BMP peak us",           PHX_F_NONE) \
+    X(lat_adxl,     U16, 0, 0, health[2].max_us,         "ADXL peak us",          PHX_F_NONE) \
+    X(lat_bno,      U16, 0, 0, health[3].max_us,         "BNO peak us",           PHX_F_NONE) \
+    X(lat_gps,      U16, 0, 0, health[4].max_us,         "GPS peak us",           PHX_F_NONE) \
+    X(us_lsm,       U32, 0, 0, sample_us[0],             "LSM sampled (us)",      PHX_F_NONE) \
+    X(us_bmp,       U32, 0, 0, sample_us[1],             "BMP sampled (us)",      PHX_F_NONE) \
+    X(us_adxl,      U32, 0, 0, sample_us[2],             "ADXL sampled (us)",     PHX_F_NONE) \
+    X(us_bno,       U32, 0, 0, sample_us[3],             "BNO sampled (us)",      PHX_F_NONE) \
+    X(us_gps,       U32, 0, 0, sample_us[4],             "GPS fix sampled (us)",  PHX_F_NONE)
+
+// wire type -> C type
+#define PHX_CTYPE_U8  uint8_t
+#define PHX_CTYPE_U16 uint16_t
+#define PHX_CTYPE_U32 uint32_t
+#define PHX_CTYPE_U64 uint64_t
+#define PHX_CTYPE_F32 float
+
+/**
+ * @brief every schema field packed back to back, little-endian
+ *
+ * This is the payload of a binary log record and of a Teensy link frame.
+ */
+#define PHX_DECLARE_FIELD(name, type, precision, tlm, member, label, flags) PHX_CTYPE_##type name;
+struct __attribute__((packed)) FlightRecord {
+    PHX_FLIGHT_FIELDS(PHX_DECLARE_FIELD)
+};
+#undef PHX_DECLARE_FIELD
+
+// Text output helpers. `Out` is anything with Arduino Print style
+// print()/println() overloads; the writers use a LineBuffer (SRAD_PHX_Format.h).
+template <class Out> void phxPrintField(Out &out, float v, int precision) { out.print(v, precision); }
+template <class Out> void phxPrintField(Out &out, uint8_t v, int) { out.print((unsigned)v); }
+template <class Out> void phxPrintField(Out &out, uint16_t v, int) { out.print((unsigned)v); }
+template <class Out> void phxPrintField(Out &out, uint32_t v, int) { out.print(v); }
+template <class Out> void phxPrintField(Out &out, uint64_t v, int) { out.print(v); }
+
+/**
+ * @brief prints the column names, one CSV line
+ */
+template <class Out>
+void printCsvHeader(Out &out) {
+    const char *sep = "";
+#define PHX_HEADER_FIELD(name, type, precision, tlm, member, label, flags) \
+    out.print(sep); out.print(#name); sep = ",";
+    PHX_FLIGHT_FIELDS(PHX_HEADER_FIELD)
+#undef PHX_HEADER_FIELD
+    out.println();
+}
+
+/**
+ * @brief prints one record as a single CSV line
+ *
+ * GPS columns are left empty while the record has no fix.
+ */
+template <class Out>
+void printCsvRow(Out &out, const FlightRecord &r) {
+    const bool gps = r.gps_fix;
+    const char *sep = "";
+#define PHX_ROW_FIELD(name, type, precision, tlm, member, label, flags) \
+    out.print(sep); sep = ","; \
+    if(!((flags) & PHX_F_GPS) || gps) { phxPrintField(out, r.name, precision); }
+    PHX_FLIGHT_FIELDS(PHX_ROW_FIELD)
+#undef PHX_ROW_FIELD
+    out.println();
+}
+
+/**
+ * @brief prints one record as "label: value" lines
+ */
+template <class Out>
+void printDebugRecord(Out &out, const FlightRecord &r) {
+    const bool gps = r.gps_fix;
+#define PHX_DEBUG_FIELD(name, type, precision, tlm, member, label, flags) \
+    if(!((flags) & PHX_F_GPS) || gps) { out.print(label ": "); phxPrintField(out, r.name, precision); out.println(); }
+    PHX_FLIGHT_FIELDS(PHX_DEBUG_FIELD)
+#undef PHX_DEBUG_FIELD
+    out.println();
+}
+
+#endif
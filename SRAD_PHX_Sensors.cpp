@@ -10,6 +10,23 @@
 
 #include "SRAD_PHX.h"
 
+/**
+ * @brief times one read_* and reports it to the HealthMonitor when it returns
+ *
+ * The outcome is the sensor's sensorStatus bit at that point, which every
+ * return path of a read_* sets or clears.
+ */
+class FLIGHT::HealthScope {
+    public:
+        HealthScope(FLIGHT &f, SENSOR_ID id) : flight(f), sensor(id), start_us(micros()) {}
+        ~HealthScope() { flight.healthRecord(sensor, !flight.output.sensorStatus.test(sensor), micros() - start_us); }
+
+    private:
+        FLIGHT &flight;
+        SENSOR_ID sensor;
+        uint32_t start_us;
+};
+
 /**
  * Reads the Adafruit LSM6DS032 6 DoF Accelerometer/Gyroscope.
  * It's index in the sensorStatus is 0.
@@ -17,7 +34,15 @@
  * @returns Returns `true` if the operation succeeds, False if the operation fails
  */
 uint8_t FLIGHT::read_LSM(Adafruit_LSM6DSO32 &LSM) {
+    PHX_PROFILE_SCOPE(STAGE_LSM);
+
+    if(!healthDue(SENSOR_LSM)) {
+        return 1;                           // backed off; sensorStatus bit 0 stays set
+    }
+    HealthScope checked(*this, SENSOR_LSM);
+
     sensors_event_t accel, gyro, temp;
+    const uint64_t sampled_us = nowMicros();
 
     // Attempt to read sensor data
     if(!LSM.getEvent(&accel, &gyro, &temp))
@@ -35,14 +60,55 @@ uint8_t FLIGHT::read_LSM(Adafruit_LSM6DSO32 &LSM) {
     output.lsm_acc.x = accel.acceleration.x;
     output.lsm_acc.y = accel.acceleration.y;
     output.lsm_acc.z = accel.acceleration.z;
+    calibrateVector(CAL_LSM_GYRO, output.lsm_gyro);
+    calibrateVector(CAL_LSM_ACC, output.lsm_acc);
 
     // Store temperature data
     output.lsm_temp = float(temp.temperature);
 
+    output.sample_us[SENSOR_LSM] = sampled_us;
     output.sensorStatus.reset(0);
     return 0;  // Return false if read succeeds
 }
 
+/**
+ * Drains the LSM6DSO32 FIFO into `samples().lsm`.
+ * It's index in the sensorStatus is 0.
+ * The newest sample is also published to `output`, as read_LSM with the
+ * Adafruit driver does; an empty FIFO leaves the last one in place.
+ * @param LSM FIFO driver, after begin()
+ * @returns Returns `true` if a bus transfer fails
+ */
+uint8_t FLIGHT::read_LSM(LSM6DSO32Fifo &LSM) {
+    PHX_PROFILE_SCOPE(STAGE_LSM);
+
+    if(!healthDue(SENSOR_LSM)) {
+        return 1;                           // backed off; sensorStatus bit 0 stays set
+    }
+    HealthScope checked(*this, SENSOR_LSM);
+
+    if(!LSM.drain(batches.lsm, micros())) {
+        output.sensorStatus.set(0);
+        return 1;
+    }
+    calibrateBatch(batches.lsm, CAL_LSM_ACC, CAL_LSM_GYRO);
+
+    if(batches.lsm.count) {
+        const ImuSample &s = batches.lsm.sample[batches.lsm.count - 1];
+        output.lsm_acc.x = s.acc[0];
+        output.lsm_acc.y = s.acc[1];
+        output.lsm_acc.z = s.acc[2];
+        output.lsm_gyro.x = s.gyro[0];
+        output.lsm_gyro.y = s.gyro[1];
+        output.lsm_gyro.z = s.gyro[2];
+        output.sample_us[SENSOR_LSM] = clock.widen(s.time_us);
+    }
+    output.lsm_temp = LSM.temperature();
+
+    output.sensorStatus.reset(0);
+    return 0;
+}
+
 /**
  * Reads the Adafruit BMP388 Precision Barometer and Altimeter
  * It's index in sensorStatus is 1.
@@ -50,6 +116,15 @@ uint8_t FLIGHT::read_LSM(Adafruit_LSM6DSO32 &LSM) {
  * @return Returns `true` if operation succeeds
  */
 uint8_t FLIGHT::read_BMP(Adafruit_BMP3XX &BMP) {
+    PHX_PROFILE_SCOPE(STAGE_BMP);
+    DrdyBusGuard bus;                       // on the data-ready chips' I2C bus, see SRAD_PHX_Isr.h
+
+    if(!healthDue(SENSOR_BMP)) {
+        return 1;                           // backed off; sensorStatus bit 1 stays set
+    }
+    HealthScope checked(*this, SENSOR_BMP);
+    const uint64_t sampled_us = nowMicros();
+
     if (!BMP.performReading()) {
         output.sensorStatus.set(1);
         return 1;
@@ -57,20 +132,21 @@ uint8_t FLIGHT::read_BMP(Adafruit_BMP3XX &BMP) {
     output.bmp_temp = BMP.temperature;
     output.bmp_press = BMP.pressure;
 
-    output.bmp_alt = BMP.readAltitude(1013.25) - alt_offset;
+    // same formula as BMP.readAltitude(), which would start another conversion
+    baro_msl = 44330.0f * (1.0f - powf(output.bmp_press / 100.0f / 1013.25f, 0.1903f));
+                                            //sea level can fluctuate under +/- 7
+                                            // depends on the data of the day.
+                                            //But 1013.25 is an acceptable value.
+    baro_seq++;
 
     if(STATE < STATES::FLIGHT_ASCENT) {
-        output.bmp_alt = BMP.readAltitude(1013.25);   //uncalibrated/true altitude
+        output.bmp_alt = baro_msl;              //uncalibrated/true altitude
     } else {
-        output.bmp_alt = BMP.readAltitude(1013.25) - alt_offset;    //sea level can fluctuate under +/- 7 
-                                                                    // depends on the data of the day. 
-                                                                    //But 1013.25 is an acceptable value.
-    }
-    altReadings[altReadings_ind] = output.bmp_alt;
-    if(++altReadings_ind == 10) {
-        altReadings_ind = 0;
+        output.bmp_alt = baro_msl - alt_offset;
     }
+    apogee.add(baro_msl, (uint32_t)sampled_us);     // MSL, so the AGL switch at liftoff is not a step
 
+    output.sample_us[SENSOR_BMP] = sampled_us;
     output.sensorStatus.reset(1);
     return 0;
 }
@@ -82,7 +158,15 @@ uint8_t FLIGHT::read_BMP(Adafruit_BMP3XX &BMP) {
  * @return Returns `true`if operation succeeds
  */
 uint8_t FLIGHT::read_ADXL(Adafruit_ADXL375 &ADXL) {
+    PHX_PROFILE_SCOPE(STAGE_ADXL);
+
+    if(!healthDue(SENSOR_ADXL)) {
+        return 1;                           // backed off; sensorStatus bit 2 stays set
+    }
+    HealthScope checked(*this, SENSOR_ADXL);
+
     sensors_event_t event;
+    const uint64_t sampled_us = nowMicros();
     if (!ADXL.getEvent(&event)) {
         output.sensorStatus.set(2);
         return 1;
@@ -90,13 +174,134 @@ uint8_t FLIGHT::read_ADXL(Adafruit_ADXL375 &ADXL) {
     output.adxl_acc.x = event.acceleration.x;
     output.adxl_acc.y = event.acceleration.y;
     output.adxl_acc.z = event.acceleration.z;
+    calibrateVector(CAL_ADXL_ACC, output.adxl_acc);
 
-    output.adxl_temp = float(event.temperature);
+    // the ADXL375 has no temperature sensor; event.temperature would alias acceleration.x
+    output.adxl_temp = NAN;
 
+    output.sample_us[SENSOR_ADXL] = sampled_us;
     output.sensorStatus.reset(2);
     return 0;
 }
 
+/**
+ * Drains the ADXL375 FIFO into `samples().adxl`.
+ * It's index in sensor status is 2.
+ * The newest sample is also published to `output`; an empty FIFO
+ * leaves the last one in place.
+ * @param ADXL FIFO driver, after begin()
+ * @return Returns `true` if a bus transfer fails
+ */
+uint8_t FLIGHT::read_ADXL(ADXL375Fifo &ADXL) {
+    PHX_PROFILE_SCOPE(STAGE_ADXL);
+
+    if(!healthDue(SENSOR_ADXL)) {
+        return 1;                           // backed off; sensorStatus bit 2 stays set
+    }
+    HealthScope checked(*this, SENSOR_ADXL);
+
+    if(!ADXL.drain(batches.adxl, micros())) {
+        output.sensorStatus.set(2);
+        return 1;
+    }
+    calibrateBatch(batches.adxl, CAL_ADXL_ACC, -1);
+
+    if(batches.adxl.count) {
+        const ImuSample &s = batches.adxl.sample[batches.adxl.count - 1];
+        output.adxl_acc.x = s.acc[0];
+        output.adxl_acc.y = s.acc[1];
+        output.adxl_acc.z = s.acc[2];
+        output.sample_us[SENSOR_ADXL] = clock.widen(s.time_us);
+    }
+    output.adxl_temp = NAN;
+
+    output.sensorStatus.reset(2);
+    return 0;
+}
+
+/**
+ * Moves the samples queued by the data-ready ISRs into `samples()`.
+ * LSM6DSO32 samples go to `samples().lsm` and set sensorStatus bit 0 on a
+ * failed ISR read, ADXL375 samples to `samples().adxl` and bit 2.
+ * Both batches are restarted, as by a FIFO drain; once either is full
+ * the rest stay queued for the next call. The newest sample of each is
+ * published to `output`.
+ * @param IMU acquisition after begin()
+ * @returns Returns `true` if an ISR read failed since the last call
+ */
+uint8_t FLIGHT::read_IMU(DrdyAcquisition &IMU) {
+    PHX_PROFILE_SCOPE(STAGE_LSM);
+
+    // never backed off: the ISRs read the chips whatever this decides
+    HealthScope lsm_checked(*this, SENSOR_LSM), adxl_checked(*this, SENSOR_ADXL);
+
+    IMU.rearm();
+    SampleBatch *dest[3] = { nullptr, &batches.lsm, &batches.adxl };
+    for(int k = 1; k < 3; k++) {
+        dest[k]->first_seq += dest[k]->count;
+        dest[k]->count = 0;
+    }
+
+    RawSample raw[PHX_SAMPLE_BATCH_MAX];
+    for(;;) {
+        uint32_t room = PHX_SAMPLE_BATCH_MAX - (batches.lsm.count > batches.adxl.count ? batches.lsm.count : batches.adxl.count);
+        uint32_t n = room ? IMU.queue.pop(raw, room) : 0;
+        if(!n) {
+            break;
+        }
+        for(uint32_t i = 0; i < n; i++) {
+            const RawSample &r = raw[i];
+            if(r.source != RAW_LSM && r.source != RAW_ADXL) {
+                continue;
+            }
+            ImuSample &s = dest[r.source]->sample[dest[r.source]->count++];
+            s.time_us = r.time_us;
+            for(int a = 0; a < 3; a++) {
+                if(r.source == RAW_LSM) {
+                    s.gyro[a] = r.v[a] * LSM6DSO32_GYRO_RADS_PER_LSB;
+                    s.acc[a] = r.v[3 + a] * LSM6DSO32_ACC_MS2_PER_LSB;
+                } else {
+                    s.gyro[a] = NAN;
+                    s.acc[a] = r.v[a] * ADXL375_ACC_MS2_PER_LSB;
+                }
+            }
+            if(r.source == RAW_LSM) {
+                output.lsm_temp = r.temp / 256.0f + 25.0f;
+            }
+        }
+    }
+    calibrateBatch(batches.lsm, CAL_LSM_ACC, CAL_LSM_GYRO);
+    calibrateBatch(batches.adxl, CAL_ADXL_ACC, -1);
+
+    if(batches.lsm.count) {
+        const ImuSample &s = batches.lsm.sample[batches.lsm.count - 1];
+        output.lsm_acc.x = s.acc[0];
+        output.lsm_acc.y = s.acc[1];
+        output.lsm_acc.z = s.acc[2];
+        output.lsm_gyro.x = s.gyro[0];
+        output.lsm_gyro.y = s.gyro[1];
+        output.lsm_gyro.z = s.gyro[2];
+        output.sample_us[SENSOR_LSM] = clock.widen(s.time_us);
+    }
+    if(batches.adxl.count) {
+        const ImuSample &s = batches.adxl.sample[batches.adxl.count - 1];
+        output.adxl_acc.x = s.acc[0];
+        output.adxl_acc.y = s.acc[1];
+        output.adxl_acc.z = s.acc[2];
+        output.sample_us[SENSOR_ADXL] = clock.widen(s.time_us);
+    }
+    output.adxl_temp = NAN;
+
+    // the ISR only ever increments these
+    uint32_t lsm_err = IMU.lsm_errors, adxl_err = IMU.adxl_errors;
+    output.sensorStatus.set(0, lsm_err != drdy_lsm_errors);
+    output.sensorStatus.set(2, adxl_err != drdy_adxl_errors);
+    bool failed = lsm_err != drdy_lsm_errors || adxl_err != drdy_adxl_errors;
+    drdy_lsm_errors = lsm_err;
+    drdy_adxl_errors = adxl_err;
+    return failed ? 1 : 0;
+}
+
 /**
  * Returns Adafruit BNO055 Absolute Orientation Sensor
  * It's index in sensorStatus is 3.
@@ -104,12 +309,17 @@ uint8_t FLIGHT::read_ADXL(Adafruit_ADXL375 &ADXL) {
  * @return Returns `true` if operation succeeds
  */
 uint8_t FLIGHT::read_BNO(Adafruit_BNO055 &BNO) {
-    sensors_event_t orientationData, angVelocityData, magnetometerData, accelerometerData;
+    PHX_PROFILE_SCOPE(STAGE_BNO);
+    DrdyBusGuard bus;                       // on the data-ready chips' I2C bus, see SRAD_PHX_Isr.h
 
-    if (!BNO.getEvent(&orientationData, Adafruit_BNO055::VECTOR_EULER)) {
-        output.sensorStatus.set(3);
-        return 1;
+    if(!healthDue(SENSOR_BNO)) {
+        return 1;                           // backed off; sensorStatus bit 3 stays set
     }
+    HealthScope checked(*this, SENSOR_BNO);
+
+    sensors_event_t angVelocityData, magnetometerData, accelerometerData;
+    const uint64_t sampled_us = nowMicros();
+
     if (!BNO.getEvent(&angVelocityData, Adafruit_BNO055::VECTOR_GYROSCOPE)) {
         output.sensorStatus.set(3);
         return 1;
@@ -136,9 +346,78 @@ uint8_t FLIGHT::read_BNO(Adafruit_BNO055 &BNO) {
     output.bno_acc.x = accelerometerData.acceleration.x;
     output.bno_acc.y = accelerometerData.acceleration.y;
     output.bno_acc.z = accelerometerData.acceleration.z;
+    calibrateVector(CAL_BNO_GYRO, output.bno_gyro);
+    calibrateVector(CAL_BNO_ACC, output.bno_acc);
+
+    output.bno_mag.x = magnetometerData.magnetic.x;
+    output.bno_mag.y = magnetometerData.magnetic.y;
+    output.bno_mag.z = magnetometerData.magnetic.z;
 
     output.bno_temp = float(BNO.getTemp());
 
+    bno_seq++;
+    output.sample_us[SENSOR_BNO] = sampled_us;
+    output.sensorStatus.reset(3);
+    return 0;
+}
+
+/**
+ * Reads the BNO055 with a single burst (SRAD_PHX_Bno.h)
+ * It's index in sensorStatus is 3.
+ * Only the vectors chosen with setBnoFetch for the current state are
+ * read; the others are published as NAN. Temperature is read on every
+ * PHX_BNO_TEMP_DIVIDER-th call and held in between.
+ * @param BNO Burst reader, after begin()
+ * @return Returns `true` if the transfer fails
+ */
+uint8_t FLIGHT::read_BNO(BNO055Burst &BNO) {
+    PHX_PROFILE_SCOPE(STAGE_BNO);
+    DrdyBusGuard bus;                       // on the data-ready chips' I2C bus, see SRAD_PHX_Isr.h
+
+    if(!healthDue(SENSOR_BNO)) {
+        return 1;                           // backed off; sensorStatus bit 3 stays set
+    }
+    HealthScope checked(*this, SENSOR_BNO);
+
+    uint8_t fetch = bno_fetch[STATE];
+    if(bno_reads++ % PHX_BNO_TEMP_DIVIDER) {
+        fetch &= ~BNO_FETCH_TEMP;
+    }
+
+    BnoSample s;
+    const uint64_t sampled_us = nowMicros();
+    if(!BNO.read(s, fetch)) {
+        output.sensorStatus.set(3);
+        return 1;
+    }
+
+    output.bno_orientation.w = s.quat[0];
+    output.bno_orientation.x = s.quat[1];
+    output.bno_orientation.y = s.quat[2];
+    output.bno_orientation.z = s.quat[3];
+
+    output.bno_gyro.x = s.gyro[0];
+    output.bno_gyro.y = s.gyro[1];
+    output.bno_gyro.z = s.gyro[2];
+
+    output.bno_acc.x = s.acc[0];
+    output.bno_acc.y = s.acc[1];
+    output.bno_acc.z = s.acc[2];
+    calibrateVector(CAL_BNO_GYRO, output.bno_gyro);
+    calibrateVector(CAL_BNO_ACC, output.bno_acc);
+
+    output.bno_mag.x = s.mag[0];
+    output.bno_mag.y = s.mag[1];
+    output.bno_mag.z = s.mag[2];
+
+    if(s.fetched & BNO_FETCH_TEMP) {
+        output.bno_temp = s.temp;
+    } else if(!(bno_fetch[STATE] & BNO_FETCH_TEMP)) {
+        output.bno_temp = NAN;
+    }
+
+    bno_seq++;
+    output.sample_us[SENSOR_BNO] = sampled_us;
     output.sensorStatus.reset(3);
     return 0;
 }
@@ -146,36 +425,114 @@ uint8_t FLIGHT::read_BNO(Adafruit_BNO055 &BNO) {
 /**
  * Reads Adafruit Ultimate GPS Breakout V3
  * It's index in sensorStatus is 4.
+ * Never waits: consumes at most PHX_GPS_MAX_BYTES bytes already in the
+ * UART buffer, feeding the driver's incremental NMEA parser. Each complete
+ * sentence with a fix is copied into `output.gps`.
  * @param GPS Initialized Sensor instance
- * @return Returns `false` if GPS isn't ready in 500ms or no satellite fix, returns `true` otherwise
+ * @return Returns `false` if the last fix is younger than PHX_GPS_FIX_TIMEOUT_MS, returns `true` otherwise
  */
 uint8_t FLIGHT::read_GPS(Adafruit_GPS &GPS) {
-    last_gps = GPS;
-    
-    uint32_t startms = millis();
-    uint32_t timeout = startms + 500;
-
-    while (millis() < timeout) {
-        while (GPS.available()) {
-            GPS.read();
-
-            if (GPS.newNMEAreceived()) {
-                // Serial.println(GPS.lastNMEA());
-                if (!GPS.parse(GPS.lastNMEA())) {
-                    continue;
-                }
+    PHX_PROFILE_SCOPE(STAGE_GPS);
 
-                if (GPS.fix && GPS.satellites > 0) {
-                    // Serial.print("Satellites: ");
-                    // Serial.println(GPS.satellites);
-                    output.sensorStatus.reset(4);
-                    return 0;
-                }
-            }
+    if(!healthDue(SENSOR_GPS)) {
+        return 1;                           // backed off; sensorStatus bit 4 stays set
+    }
+    HealthScope checked(*this, SENSOR_GPS);
+
+    uint16_t budget = PHX_GPS_MAX_BYTES;
+
+    while (budget-- && GPS.available()) {
+        GPS.read();
+
+        if (!GPS.newNMEAreceived() || !GPS.parse(GPS.lastNMEA())) {
+            continue;
         }
+        if (GPS.fix && GPS.satellites > 0) {
+            output.gps.latitudeDegrees = GPS.latitudeDegrees;
+            output.gps.longitudeDegrees = GPS.longitudeDegrees;
+            output.gps.speed = GPS.speed;
+            output.gps.angle = GPS.angle;
+            output.gps.altitude = GPS.altitude;
+            output.gps.satellites = GPS.satellites;
+            output.gps.fix = true;
+            output.gps.time_ms = millis();
+            output.sample_us[SENSOR_GPS] = nowMicros();     // when the sentence finished arriving
+        }
+    }
+
+    if (output.gps.fix && millis() - output.gps.time_ms > PHX_GPS_FIX_TIMEOUT_MS) {
+        output.gps.fix = false;
+    }
+    if (!output.gps.fix) {
+        output.sensorStatus.set(4);
+        return 1;
+    }
+    output.sensorStatus.reset(4);
+    return 0;
+}
+
+/**
+ * @brief corrects one FlightData vector with its CalTable channel
+ *
+ * Does nothing until calibrate() has solved the table.
+ */
+void FLIGHT::calibrateVector(uint8_t channel, Vector3 &v) {
+    if(!cal_active) {
+        return;
+    }
+    float xyz[3] = { v.x, v.y, v.z };
+    calApply(cal, channel, xyz, 3, 1);
+    v.x = xyz[0];
+    v.y = xyz[1];
+    v.z = xyz[2];
+}
+
+/**
+ * @brief corrects every sample of a fresh batch in one kernel call per vector
+ * @param gyro_channel CAL_CHANNEL for the gyro, or -1 if the batch has none
+ */
+void FLIGHT::calibrateBatch(SampleBatch &b, uint8_t acc_channel, int gyro_channel) {
+    static_assert(sizeof(ImuSample) % sizeof(float) == 0, "ImuSample must be a whole number of floats");
+    const uint16_t stride = sizeof(ImuSample) / sizeof(float);
+    if(!cal_active || !b.count) {
+        return;
+    }
+    calApply(cal, acc_channel, b.sample[0].acc, stride, b.count);
+    if(gyro_channel >= 0) {
+        calApply(cal, gyro_channel, b.sample[0].gyro, stride, b.count);
     }
+}
+
+/**
+ * @brief registers what re-initializes a sensor before each retry after a back-off
+ *
+ * Typically the sketch's setup for that sensor (begin_I2C, ranges,
+ * FIFO begin()). Without one a retry is just another read.
+ */
+void FLIGHT::setSensorInit(SENSOR_ID sensor, bool (*init)()) {
+    sensor_init[sensor] = init;
+}
 
-    output.sensorStatus.set(4);
-    return 1;
+/**
+ * @brief false if `sensor` is backed off, or its retry's re-init failed
+ */
+bool FLIGHT::healthDue(SENSOR_ID sensor) {
+    if(!health.due(sensor, millis())) {
+        output.sensorStatus.set(sensor);
+        return false;
+    }
+    if(health.retrying(sensor) && sensor_init[sensor]) {
+        uint32_t start_us = micros();
+        if(!sensor_init[sensor]()) {
+            output.sensorStatus.set(sensor);
+            healthRecord(sensor, false, micros() - start_us);
+            return false;
+        }
+    }
+    return true;
 }
 
+void FLIGHT::healthRecord(SENSOR_ID sensor, bool ok, uint32_t latency_us) {
+    health.record(sensor, ok, latency_us, millis());
+    output.health[sensor] = health[sensor];
+}
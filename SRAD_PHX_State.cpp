@@ -16,13 +16,30 @@
  * 
  * The function uses a cascading switch case to determine which stage
  * of flight the rocket is in. At each stage, it calls a helper function
- * to determine if it should move to the next one.
+ * to determine if it should move to the next one. Liftoff is checked
+ * from PRE_NO_CAL on, so a launch during calibration goes straight to
+ * FLIGHT_ASCENT.
+ *
+ * The attitude and altitude estimate are advanced first so every check
+ * sees the same filtered signals. An attached SectorLogger is told about every
+ * transition so it can flush and switch in or out of realtime mode.
  */
 void FLIGHT::calculateState() {
+    PHX_PROFILE_SCOPE(STAGE_STATE);
+
+    STATES prevState = STATE;
+
+    updateAttitude();
+    updateEstimate();
+
     switch(STATE) {
         case(STATES::PRE_NO_CAL):
             AltitudeCalibrate(); //check altitude offset and set it
-            if(calibrate()) {
+            if(isAscent()) {
+                // launched before the pad average was done: fly uncorrected
+                calibrated = true;
+                STATE = STATES::FLIGHT_ASCENT;
+            } else if(calibrate()) {
                 STATE = STATES::PRE_CAL;
             }
             break;
@@ -45,6 +62,24 @@ void FLIGHT::calculateState() {
                 STATE = STATES::POST_LANDED;
             }
             break;
+
+        case STATES::POST_LANDED:
+            break;
+    }
+
+    output.state = STATE;
+    if(STATE != prevState) {
+        noteStateChange();
+    }
+}
+
+/**
+ * @brief bookkeeping for a new STATE, from calculateState or nextLinkRecord
+ */
+void FLIGHT::noteStateChange() {
+    state_entered_ms = runningTime_ms;
+    if(logger) {
+        logger->onStateChange(STATE == STATES::FLIGHT_ASCENT);
     }
 }
 /**
@@ -56,82 +91,359 @@ bool FLIGHT::isCal() {
 }
 
 /**
- * Helper function to check if rocket is ascending
- * Fault tolerant for failure of LSM or ADXL.
- * 1. If LSM fails, default to ADXL
- * 2. If ADXL fails, default to BMP
- * @return returns true if rocket is ascending
+ * @brief advances the altitude/velocity estimate by one tick
+ *
+ * Picks the accelerometer to trust (LSM, or the ADXL375 when the LSM
+ * has failed or is saturated during boost), removes the gravity reading
+ * learned on the pad, predicts with it and corrects with the baro if a
+ * new sample arrived since the last tick. Results go to `output.est_*`.
+ * When the chosen accelerometer is read through its FIFO, the predict
+ * runs once per new sample at that sample's time instead of once per tick,
+ * and not at all on a tick with no new sample.
+ * Accelerations are projected on the vertical with the latest attitude
+ * (updateAttitude), so a tilted rocket does not read its axial
+ * acceleration as climb; before the attitude is known that is the axis.
  */
-bool FLIGHT::isAscent() {
-    static uint32_t liftoffTimer_ms;
-    if(!output.sensorStatus.test(0)) {
-        if(output.lsm_acc.z > accel_liftoff_threshold) {
-            liftoffTimer_ms += deltaTime_ms;
+void FLIGHT::updateEstimate() {
+    uint32_t now = micros();
+    float dt = est_last_us ? (now - est_last_us) * 1e-6f : 0;
+    if(dt > PHX_EST_MAX_DT_S) {
+        dt = PHX_EST_MAX_DT_S;
+    }
 
-            if(liftoffTimer_ms  > accel_liftoff_time_threshold) {
-                return true;
+    bool lsm_ok = !output.sensorStatus.test(0);
+    bool adxl_ok = !output.sensorStatus.test(2);
+
+    const float lsm[3] = { output.lsm_acc.x, output.lsm_acc.y, output.lsm_acc.z };
+    const float adxl[3] = { output.adxl_acc.x, output.adxl_acc.y, output.adxl_acc.z };
+    const float lsm_up = attitude.up(lsm), adxl_up = attitude.up(adxl);
+
+    // learn each sensor's vertical reading of 1 g while sitting still on the pad
+    if(STATE < STATES::FLIGHT_ASCENT) {
+        const float k = dt > 0 ? dt / (dt + 2.0f) : 0;   // ~2 s time constant
+        if(lsm_ok && fabsf(lsm_up - PHX_GRAVITY) < 1.5f) {
+            g_lsm += (lsm_up - g_lsm) * k;
+        }
+        if(adxl_ok && fabsf(adxl_up - PHX_GRAVITY) < 1.5f) {
+            g_adxl += (adxl_up - g_adxl) * k;
+        }
+    }
+
+    float acc = 0, sigma = PHX_EST_NO_ACC_SIGMA;
+    if(lsm_ok && fabsf(output.lsm_acc.z) < PHX_LSM_SATURATION) {
+        output.acc_source = ACC_LSM;
+        acc_axial = output.lsm_acc.z;
+        acc = lsm_up - g_lsm;
+        sigma = PHX_EST_LSM_SIGMA;
+    } else if(adxl_ok) {
+        output.acc_source = ACC_ADXL;
+        acc_axial = output.adxl_acc.z;
+        acc = adxl_up - g_adxl;
+        sigma = PHX_EST_ADXL_SIGMA;
+    } else {
+        output.acc_source = ACC_NONE;
+    }
+
+    // new FIFO samples of that accelerometer, if it is read in batches
+    const SampleBatch *batch = nullptr;
+    float g = 0;
+    if(output.acc_source == ACC_LSM) {
+        batch = &batches.lsm;
+        g = g_lsm;
+    } else if(output.acc_source == ACC_ADXL) {
+        batch = &batches.adxl;
+        g = g_adxl;
+    }
+    uint32_t next_seq = batch == &batches.lsm ? lsm_est_seq : adxl_est_seq;
+
+    bool predicted = false;
+    for(uint16_t i = 0; batch && i < batch->count; i++) {
+        if((int32_t)(batch->first_seq + i - next_seq) < 0) {
+            continue;                       // used on an earlier tick
+        }
+        const ImuSample &s = batch->sample[i];
+        int32_t step_us = (int32_t)(s.time_us - est_last_us);
+        float step = est_last_us && step_us > 0 ? step_us * 1e-6f : 0;
+        if(step > PHX_EST_MAX_DT_S) {
+            step = PHX_EST_MAX_DT_S;
+        }
+        // the filter's noise is per predict, so spread one tick's worth over the samples
+        float step_sigma = step > 0 && dt > step ? sigma * sqrtf(dt / step) : sigma;
+        acc = attitude.up(s.acc) - g;
+        estimator.predict(acc, step, step_sigma);
+        est_last_us = s.time_us;
+        predicted = true;
+    }
+    lsm_est_seq = batches.lsm.first_seq + batches.lsm.count;
+    adxl_est_seq = batches.adxl.first_seq + batches.adxl.count;
+
+    // a batched accelerometer with nothing new is waiting on its FIFO; its next samples cover the gap
+    const bool batched = batch && batch->first_seq + batch->count != 0;
+    if(!predicted && !batched) {
+        estimator.predict(acc, dt, sigma);
+        est_last_us = now;
+    }
+    if(baro_seq != baro_seq_used && !output.sensorStatus.test(1)) {
+        baro_seq_used = baro_seq;
+        estimator.correct(baro_msl, PHX_EST_BARO_SIGMA);
+    }
+
+    output.att_acc_up = acc;
+    output.est_alt = estimator.altitude() - alt_offset;
+    output.est_vel = estimator.velocity();
+    output.est_acc = estimator.acceleration();
+}
+
+/**
+ * @brief advances the orientation by every new LSM gyro sample
+ *
+ * With the LSM read through its FIFO (or the data-ready queue) each
+ * sample is integrated at its own time, otherwise the latest reading once
+ * per tick. A new BNO055 quaternion replaces the integrated one (or pulls
+ * it by PHX_ATT_BNO_GAIN) only while the BNO can be trusted: it read
+ * cleanly, its health is HEALTH_OK, the quaternion is a unit one and the
+ * acceleration has stayed under PHX_ATT_BNO_MAX_ACC for the last
+ * PHX_ATT_BNO_HOLDOFF_MS. On the pad with no BNO the tilt comes from
+ * gravity. Results go to `output.att_*`.
+ */
+void FLIGHT::updateAttitude() {
+    uint32_t now = micros();
+    bool lsm_ok = !output.sensorStatus.test(0);
+    bool adxl_ok = !output.sensorStatus.test(2);
+
+    const Vector3 *acc = nullptr;
+    if(lsm_ok && fabsf(output.lsm_acc.z) < PHX_LSM_SATURATION) {
+        acc = &output.lsm_acc;
+    } else if(adxl_ok) {
+        acc = &output.adxl_acc;
+    }
+    const float a[3] = { acc ? acc->x : 0, acc ? acc->y : 0, acc ? acc->z : 0 };
+    const float a_mag = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    if(acc && a_mag > PHX_ATT_BNO_MAX_ACC) {
+        bno_trust_ms = runningTime_ms + PHX_ATT_BNO_HOLDOFF_MS;
+    }
+
+    const SampleBatch &b = batches.lsm;
+    if(!lsm_ok) {
+        att_last_us = 0;                    // hold; restart the step when it is back
+    } else if(b.first_seq + b.count) {
+        for(uint16_t i = 0; i < b.count; i++) {
+            if((int32_t)(b.first_seq + i - lsm_att_seq) < 0) {
+                continue;
             }
-        } else {
-            liftoffTimer_ms = 0;
+            const ImuSample &s = b.sample[i];
+            int32_t step_us = (int32_t)(s.time_us - att_last_us);
+            if(att_last_us && step_us > 0) {
+                attitude.propagate(s.gyro, fminf(step_us * 1e-6f, PHX_EST_MAX_DT_S));
+            }
+            att_last_us = s.time_us;
+        }
+        lsm_att_seq = b.first_seq + b.count;
+    } else {
+        const float w[3] = { output.lsm_gyro.x, output.lsm_gyro.y, output.lsm_gyro.z };
+        if(att_last_us) {
+            attitude.propagate(w, fminf((now - att_last_us) * 1e-6f, PHX_EST_MAX_DT_S));
         }
-    } else if (output.adxl_acc.z > accel_liftoff_threshold) {  // if primary accel is known to be bad, check secondary
-        if(output.lsm_acc.z > accel_liftoff_threshold) {
-            liftoffTimer_ms += deltaTime_ms;
+        att_last_us = now;
+    }
+
+    if(bno_seq != bno_seq_used) {
+        bno_seq_used = bno_seq;
+        const Quaternion &q = output.bno_orientation;
+        const float n2 = q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z;
+        // NAN (a burst that skipped the quaternion) fails the norm check
+        if(!output.sensorStatus.test(3) && health.state(SENSOR_BNO) == HEALTH_OK
+           && runningTime_ms >= bno_trust_ms && fabsf(n2 - 1.0f) < 0.1f) {
+            attitude.anchor(quatMultiply(q, bno_mount), PHX_ATT_BNO_GAIN);
+            bno_anchor_ms = runningTime_ms;
+        }
+    }
 
-            if(liftoffTimer_ms  > accel_liftoff_time_threshold) {
+    if(STATE < STATES::FLIGHT_ASCENT && acc && fabsf(a_mag - PHX_GRAVITY) < 1.5f
+       && (!attitude.valid() || runningTime_ms - bno_anchor_ms >= PHX_ATT_LEVEL_MS)) {
+        attitude.level(a);
+    }
+
+    output.att_orientation = attitude.orientation();
+    output.att_tilt = attitude.tilt() * (180.0f / (float)M_PI);
+}
+
+/**
+ * @brief SENSOR_HEALTH of the accelerometer feeding the estimator
+ *
+ * HEALTH_BACKOFF when there is none.
+ */
+uint8_t FLIGHT::accHealth() const {
+    if(output.acc_source == ACC_LSM) {
+        return health.state(SENSOR_LSM);
+    }
+    if(output.acc_source == ACC_ADXL) {
+        return health.state(SENSOR_ADXL);
+    }
+    return HEALTH_BACKOFF;
+}
+
+/**
+ * Helper function to check if rocket is ascending
+ * Fault tolerant for failure or saturation of the LSM:
+ * 1. Axial acceleration from the estimator's accelerometer
+ *    (LSM, or ADXL if the LSM is bad) held over the threshold for
+ *    `accel_liftoff_time_threshold` ms between its sample stamps
+ * 2. If that accelerometer is degraded, or both are bad, fused climb
+ *    rate and height from the BMP as well
+ * @return returns true if rocket is ascending
+ */
+bool FLIGHT::isAscent() {
+    if(output.acc_source != ACC_NONE) {
+        // timed on the accelerometer's own sample stamps, not the loop's
+        const uint64_t t = output.sample_us[output.acc_source == ACC_LSM ? SENSOR_LSM : SENSOR_ADXL];
+        if(acc_axial > accel_liftoff_threshold) {
+            if(liftoff_since_us == UINT64_MAX) {
+                liftoff_since_us = t;
+            }
+            if(t - liftoff_since_us >= (uint64_t)accel_liftoff_time_threshold * 1000) {
                 return true;
             }
         } else {
-            liftoffTimer_ms = 0;
+            liftoff_since_us = UINT64_MAX;  // a flaky accelerometer keeps restarting this; the baro check covers it
+        }
+    }
+    if(accHealth() != HEALTH_OK && !output.sensorStatus.test(1)) {
+        // climbing fast and clear of the pad
+        if(output.est_vel > PHX_ASCENT_BARO_VEL && output.est_alt > land_altitude_threshold) {
+            return true;
         }
-    } else {  // if both accelerometers are bad, use altimeter
-        // check if altitude is notably higher than 0 (or alt threshold)
     }
     return false;
 }
+/**
+ * Helper function to check if rocket is past apogee
+ * 1. Least-squares baro slope over PHX_APOGEE_WINDOW samples (see SRAD_PHX_Apogee.h)
+ * 2. If the BMP is bad, the fused vertical velocity, which then runs on
+ *    the accelerometers alone
+ * @return returns true if rocket is descending
+ */
 bool FLIGHT::isDescent() {
-    // use altimeter primarily to detect apogee based off of trend in data
     if(!output.sensorStatus.test(1)) {
-        uint8_t desc_samples;                                   // tracks the number of samples with a descending delta
-        for(int i = 0; i < 9; i++) {
-            uint8_t index1 = (altReadings_ind + i + 1) % 10;        // get an index, starting with our oldest value
-            uint8_t index2 = (altReadings_ind + i + 2) % 10;        // get the value after the first index
-            if(altReadings[index1] - altReadings[index2] > 0.5 ) {  // change 0.5 based on noise values from lab testing
-                desc_samples++;
-            }
-        }
-        if(desc_samples > 7) {
-            return true;
-        }
-    } // add backup sensor here
-    return false;
-
+        return apogee.descending();
+    }
+    // add backup sensor here
+    return output.acc_source != ACC_NONE && output.est_vel < -PHX_APOGEE_DESCENT_VEL;
 }
+/**
+ * Helper function to check if rocket has landed
+ * Landed once the fused altitude is near the pad and the vertical
+ * velocity near zero for `land_time_threshold` ms. Without the BMP the
+ * velocity estimate drifts, so a still accelerometer (1 g total) is used.
+ * A degraded BMP still returns data and keeps deciding; only a backed-off
+ * one hands over to the accelerometer.
+ * @return returns true if rocket has landed
+ */
 bool FLIGHT::isLanded() {
-    if(!output.sensorStatus.test(0)) {
-        if (output.adxl_acc.z < 2 && output.adxl_acc.z >= 0){
-            return true;
-        }
+    bool still;
+    const bool baro = !output.sensorStatus.test(1);
+    if(baro && (health.state(SENSOR_BMP) != HEALTH_BACKOFF || output.acc_source == ACC_NONE)) {
+        still = fabsf(output.est_vel) < PHX_LANDED_VEL && output.est_alt < land_altitude_threshold;
+    } else if(output.acc_source != ACC_NONE) {
+        const Vector3 &acc = output.acc_source == ACC_LSM ? output.lsm_acc : output.adxl_acc;
+        float g = sqrtf(acc.x * acc.x + acc.y * acc.y + acc.z * acc.z);
+        still = fabsf(g - PHX_GRAVITY) < 1.5f;
     } else {
-        if (output.bmp_alt <=  alt_offset + 10){    // if the current altitude is less than the offset altitude + 10m 
-                                                    // then return True to indicate the rocket is landed
-        return true;
-        }
+        still = false;
     }
-    
-    return false;
+
+    if(!still) {
+        land_since_us = UINT64_MAX;
+        return false;
+    }
+    if(land_since_us == UINT64_MAX) {
+        land_since_us = runningTime_us;
+    }
+    return runningTime_us - land_since_us >= (uint64_t)land_time_threshold * 1000;
 }
 
+/**
+ * @brief averages the IMUs on the pad and solves their CalTable
+ *
+ * Called every tick in PRE_NO_CAL. Each tick the rocket is still (LSM
+ * gyro under PHX_CAL_STILL_GYRO, the first working accelerometer within
+ * PHX_CAL_STILL_ACC of 1 g) adds the newest reading of every working
+ * sensor; any movement starts the average over. After PHX_CAL_SAMPLES
+ * still ticks the table is solved (see CalEstimator) and every later
+ * read is corrected with it. If the rocket is not still for that long
+ * within PHX_CAL_MAX_MS it carries on uncorrected. calculateState checks
+ * for liftoff before each call, so calibration never holds it off.
+ * @return returns true once calibration is finished, applied or not
+ */
 bool FLIGHT::calibrate() {
-    // calibrate for GPS offset, possibly of the earth spinning?
-    //
-    // additionally calibrate altitude offset
+    if(calibrated) {
+        return true;
+    }
+    if(cal_start_ms == UINT64_MAX) {
+        cal_start_ms = runningTime_ms;
+    }
 
+    const bool lsm_ok = !output.sensorStatus.test(0);
+    const bool adxl_ok = !output.sensorStatus.test(2);
+    const bool bno_ok = !output.sensorStatus.test(3);
+    const Vector3 *acc = lsm_ok ? &output.lsm_acc : adxl_ok ? &output.adxl_acc : bno_ok ? &output.bno_acc : nullptr;
 
+    bool still = acc != nullptr;
+    if(still) {
+        float g = sqrtf(acc->x * acc->x + acc->y * acc->y + acc->z * acc->z);
+        still = fabsf(g - PHX_GRAVITY) < PHX_CAL_STILL_ACC;
+    }
+    if(still && lsm_ok) {
+        const Vector3 &w = output.lsm_gyro;
+        still = sqrtf(w.x * w.x + w.y * w.y + w.z * w.z) < PHX_CAL_STILL_GYRO;
+    }
+
+    if(!still) {
+        cal_est.reset();
+    } else {
+        if(lsm_ok) {
+            cal_est.add(CAL_LSM_ACC, output.lsm_acc.x, output.lsm_acc.y, output.lsm_acc.z);
+            cal_est.add(CAL_LSM_GYRO, output.lsm_gyro.x, output.lsm_gyro.y, output.lsm_gyro.z);
+        }
+        if(adxl_ok) {
+            cal_est.add(CAL_ADXL_ACC, output.adxl_acc.x, output.adxl_acc.y, output.adxl_acc.z);
+        }
+        if(bno_ok) {
+            cal_est.add(CAL_BNO_ACC, output.bno_acc.x, output.bno_acc.y, output.bno_acc.z);
+            cal_est.add(CAL_BNO_GYRO, output.bno_gyro.x, output.bno_gyro.y, output.bno_gyro.z);
+        }
+        cal_est.tick();
+    }
+
+    if(cal_est.stillTicks() >= PHX_CAL_SAMPLES) {
+        cal_est.solve(cal);
+        cal_active = true;
+
+        // the BNO's quaternion is of its own frame; the body is reached through its alignment
+        float m[9];
+        for(int i = 0; i < 9; i++) {
+            m[i] = cal.m[i][CAL_BNO_ACC];
+        }
+        bno_mount = quatFromMatrix(m);
+        bno_mount.x = -bno_mount.x;
+        bno_mount.y = -bno_mount.y;
+        bno_mount.z = -bno_mount.z;
+        calibrated = true;
+    } else if(runningTime_ms - cal_start_ms > PHX_CAL_MAX_MS) {
+        calibrated = true;
+    }
+    return calibrated;
 }
 bool FLIGHT::AltitudeCalibrate(){
     // save the offset to the current altitude when the function is called
-    alt_offset = output.bmp_alt;   
-    
+    // the filtered altitude is used once it has seen the baro, it is far less noisy,
+    // and is held once it starts moving so the first metres of boost are not zeroed
+    if(!estimator.ready()) {
+        alt_offset = baro_msl;
+    } else if(fabsf(estimator.velocity()) < PHX_LANDED_VEL) {
+        alt_offset = estimator.altitude();
+    }
+    output.est_alt = estimator.altitude() - alt_offset;
+    return true;
 }
 
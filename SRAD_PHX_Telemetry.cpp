@@ -0,0 +1,227 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "SRAD_PHX_Telemetry.h"
+
+#define TLM_NAN INT64_MIN                   // quantized NaN
+
+static const double SCALE[10] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+// Fields become integers in 10^-tlm steps; integer fields are already.
+static int64_t quantize(float v, uint8_t precision) {
+    if(isnan(v)) {
+        return TLM_NAN;
+    }
+    double q = (double)v * SCALE[precision];
+    if(q > 9.0e18) q = 9.0e18;
+    if(q < -9.0e18) q = -9.0e18;
+    return llround(q);
+}
+template <class T> static int64_t quantize(T v, uint8_t) { return (int64_t)v; }
+
+static void dequantize(int64_t q, uint8_t precision, float &v) {
+    v = q == TLM_NAN ? NAN : (float)((double)q / SCALE[precision]);
+}
+template <class T> static void dequantize(int64_t q, uint8_t, T &v) { v = (T)q; }
+
+static void quantizeRecord(const FlightRecord &r, int64_t *q) {
+    int i = 0;
+#define PHX_TLM_QUANTIZE(name, type, precision, tlm, member, label, flags) q[i++] = quantize(r.name, tlm);
+    PHX_FLIGHT_FIELDS(PHX_TLM_QUANTIZE)
+#undef PHX_TLM_QUANTIZE
+}
+
+static void dequantizeRecord(const int64_t *q, FlightRecord &r) {
+    int i = 0;
+#define PHX_TLM_DEQUANTIZE(name, type, precision, tlm, member, label, flags) \
+    { PHX_CTYPE_##type v; dequantize(q[i++], tlm, v); r.name = v; }
+    PHX_FLIGHT_FIELDS(PHX_TLM_DEQUANTIZE)
+#undef PHX_TLM_DEQUANTIZE
+}
+
+// Deltas are taken modulo 2^64 so the NaN marker and clamped values never overflow.
+static uint64_t zigzag(uint64_t d) { return (d << 1) ^ (0 - (d >> 63)); }
+static uint64_t unzigzag(uint64_t z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+static uint8_t *putVarint(uint8_t *p, uint64_t v) {
+    while(v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static const uint8_t *getVarint(const uint8_t *p, const uint8_t *end, uint64_t &v) {
+    v = 0;
+    for(uint8_t shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if(!(b & 0x80)) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+void TelemetryEncoder::reset() {
+    memset(prev, 0, sizeof(prev));
+    memset(&stat, 0, sizeof(stat));
+    seq = 0;
+    since_key = 0;
+    force_key = true;
+}
+
+/**
+ * @brief writes the next frame for `rec` into `out`
+ * @return frame length, or 0 if `cap` cannot hold a keyframe
+ *
+ * A delta frame that would not be smaller than a keyframe (or not fit)
+ * is sent as a keyframe instead.
+ */
+size_t TelemetryEncoder::encode(const FlightRecord &rec, uint8_t *out, size_t cap) {
+    int64_t q[TLM_FIELD_COUNT];
+    quantizeRecord(rec, q);
+
+    bool key = force_key || since_key + 1 >= PHX_TLM_KEYFRAME_INTERVAL;
+    size_t len = 0;
+    if(!key && cap >= TLM_HEADER_SIZE + TLM_BITMAP_BYTES) {
+        uint8_t *bitmap = out + TLM_HEADER_SIZE;
+        uint8_t *p = bitmap + TLM_BITMAP_BYTES;
+        const uint8_t *limit = out + (cap < TLM_MAX_FRAME ? cap : TLM_MAX_FRAME);
+        memset(bitmap, 0, TLM_BITMAP_BYTES);
+        for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+            uint64_t d = (uint64_t)q[i] - (uint64_t)prev[i];
+            if(!d) {
+                continue;
+            }
+            if(limit - p < 10) {
+                key = true;
+                break;
+            }
+            bitmap[i >> 3] |= 1 << (i & 7);
+            p = putVarint(p, zigzag(d));
+        }
+        out[0] = TLM_DELTA;
+        len = p - out;
+    } else {
+        key = true;
+    }
+
+    if(key) {
+        if(cap < TLM_MAX_FRAME) {
+            return 0;
+        }
+        out[0] = TLM_KEYFRAME;
+        memcpy(out + TLM_HEADER_SIZE, &rec, sizeof(rec));
+        len = TLM_MAX_FRAME;
+        since_key = 0;
+        force_key = false;
+        stat.keyframes++;
+    } else {
+        since_key++;
+    }
+    out[1] = seq & 0xFF;
+    out[2] = seq >> 8;
+
+    memcpy(prev, q, sizeof(prev));
+    seq++;
+    stat.frames++;
+    stat.bytes += len;
+    return len;
+}
+
+void TelemetryDecoder::reset() {
+    memset(ref, 0, sizeof(ref));
+    memset(&stat, 0, sizeof(stat));
+    last_seq = 0;
+    have_seq = false;
+    have_chain = false;
+}
+
+/**
+ * @brief applies one frame
+ * @return true if `out` now holds the sender's record
+ *
+ * Gaps in the sequence are counted as lost frames and break the delta
+ * chain; deltas are then dropped until the next keyframe.
+ */
+bool TelemetryDecoder::decode(const uint8_t *in, size_t len, FlightRecord &out) {
+    if(len < TLM_HEADER_SIZE) {
+        stat.malformed++;
+        return false;
+    }
+    uint8_t kind = in[0];
+    uint16_t s = in[1] | (in[2] << 8);
+
+    bool in_order = have_seq && s == (uint16_t)(last_seq + 1);
+    if(have_seq && !in_order) {
+        uint16_t gap = s - last_seq - 1;
+        if(gap < 0x8000) {
+            stat.lost += gap;
+        }
+        have_chain = false;
+    }
+
+    if(kind == TLM_KEYFRAME) {
+        if(len != TLM_MAX_FRAME) {
+            stat.malformed++;
+            return false;
+        }
+        memcpy(&out, in + TLM_HEADER_SIZE, sizeof(out));
+        quantizeRecord(out, ref);
+        last_seq = s;
+        have_seq = true;
+        have_chain = true;
+        stat.frames++;
+        stat.keyframes++;
+        return true;
+    }
+    if(kind != TLM_DELTA || len < TLM_HEADER_SIZE + TLM_BITMAP_BYTES) {
+        stat.malformed++;
+        return false;
+    }
+
+    last_seq = s;
+    have_seq = true;
+    if(!have_chain) {
+        stat.dropped++;
+        return false;
+    }
+
+    int64_t next[TLM_FIELD_COUNT];
+    memcpy(next, ref, sizeof(next));
+    const uint8_t *bitmap = in + TLM_HEADER_SIZE;
+    const uint8_t *p = bitmap + TLM_BITMAP_BYTES;
+    const uint8_t *end = in + len;
+    for(int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if(!(bitmap[i >> 3] & (1 << (i & 7)))) {
+            continue;
+        }
+        uint64_t z;
+        if(!(p = getVarint(p, end, z))) {
+            break;
+        }
+        next[i] = (int64_t)((uint64_t)next[i] + unzigzag(z));
+    }
+    if(p != end) {
+        stat.malformed++;
+        have_chain = false;
+        return false;
+    }
+
+    memcpy(ref, next, sizeof(ref));
+    dequantizeRecord(ref, out);
+    stat.frames++;
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef SRAD_PHX_TELEMETRY_H
+#define SRAD_PHX_TELEMETRY_H
+
+// Compact frames for the Teensy-to-Teensy link. Like SRAD_PHX_Log.h
+// this header must not depend on Arduino.
+//
+// Every frame starts with
+//   u8  kind                 TLM_KEYFRAME or TLM_DELTA
+//   u16 seq                  little-endian, +1 per frame
+// A keyframe carries the whole FlightRecord as-is. A delta frame carries
+//   u8  present[TLM_BITMAP_BYTES]   bit i set if schema field i changed
+//   varint...                       zig-zag delta of each present field
+// where fields are quantized to their schema `tlm` digits (10^-tlm steps,
+// about one sensor LSB) and deltas are against the previous frame. A lost
+// frame breaks the chain, so the receiver drops deltas until the next
+// keyframe.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SRAD_PHX_Schema.h"
+
+#ifndef PHX_TLM_KEYFRAME_INTERVAL
+#define PHX_TLM_KEYFRAME_INTERVAL 25        // frames between keyframes
+#endif
+
+#define PHX_TLM_COUNT_FIELD(name, type, precision, tlm, member, label, flags) +1
+#define TLM_FIELD_COUNT (0 PHX_FLIGHT_FIELDS(PHX_TLM_COUNT_FIELD))
+#define TLM_BITMAP_BYTES ((TLM_FIELD_COUNT + 7) / 8)
+#define TLM_HEADER_SIZE 3
+#define TLM_MAX_FRAME (TLM_HEADER_SIZE + sizeof(FlightRecord))
+
+enum TLM_KIND : uint8_t {
+    TLM_KEYFRAME = 0x4B,
+    TLM_DELTA = 0x44,
+};
+
+struct TelemetryTxStats {
+    uint32_t frames;
+    uint32_t keyframes;
+    uint32_t bytes;                         // frame bytes, without link framing
+};
+
+struct TelemetryRxStats {
+    uint32_t frames;                        // frames applied to the output
+    uint32_t keyframes;
+    uint32_t lost;                          // frames missing from the sequence
+    uint32_t dropped;                       // deltas received with no chain to apply to
+    uint32_t malformed;
+};
+
+/**
+ * @brief builds keyframe and delta frames from successive FlightRecords
+ */
+class TelemetryEncoder {
+    public:
+        TelemetryEncoder() { reset(); }
+
+        void reset();
+        void requestKeyframe() { force_key = true; }
+        size_t encode(const FlightRecord &, uint8_t *out, size_t cap);
+
+        uint16_t sequence() const { return seq; }
+        const TelemetryTxStats& stats() const { return stat; }
+
+    private:
+        int64_t prev[TLM_FIELD_COUNT];      // quantized fields of the last frame sent
+        uint16_t seq;
+        uint16_t since_key;
+        bool force_key;
+        TelemetryTxStats stat;
+};
+
+/**
+ * @brief rebuilds FlightRecords from frames and tracks sequence gaps
+ */
+class TelemetryDecoder {
+    public:
+        TelemetryDecoder() { reset(); }
+
+        void reset();
+        bool decode(const uint8_t *in, size_t len, FlightRecord &out);
+
+        bool synced() const { return have_chain; }
+        uint16_t lastSequence() const { return last_seq; }
+        const TelemetryRxStats& stats() const { return stat; }
+
+    private:
+        int64_t ref[TLM_FIELD_COUNT];       // quantized fields of the last frame applied
+        uint16_t last_seq;
+        bool have_seq;
+        bool have_chain;
+        TelemetryRxStats stat;
+};
+
+#endif
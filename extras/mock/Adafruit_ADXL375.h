@@ -0,0 +1,33 @@
+#ifndef PHX_MOCK_ADAFRUIT_ADXL375_H
+#define PHX_MOCK_ADAFRUIT_ADXL375_H
+
+#include "Adafruit_Sensor.h"
+
+// ADXL375 stand-in; the SIL writes the next sample into `sim`.
+class Adafruit_ADXL375 {
+    public:
+        Adafruit_ADXL375(int32_t = -1) {}
+        bool begin(uint8_t = 0x53) { return true; }
+
+        bool getEvent(sensors_event_t *event) {
+            sim.reads++;
+            if(!sim.ok) {
+                sim::advanceMicros(sim.timeout_us);
+                return false;
+            }
+            memset(event, 0, sizeof(*event));
+            for(int i = 0; i < 3; i++) {
+                event->acceleration.v[i] = sim.acc[i];
+            }
+            return true;
+        }
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            bool ok = true;
+            uint32_t timeout_us = 0;        // clock time a failed read burns, as a driver waiting out a hung bus
+            uint32_t reads = 0;
+        } sim;
+};
+
+#endif
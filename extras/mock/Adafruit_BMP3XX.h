@@ -0,0 +1,41 @@
+#ifndef PHX_MOCK_ADAFRUIT_BMP3XX_H
+#define PHX_MOCK_ADAFRUIT_BMP3XX_H
+
+#include "Arduino.h"
+
+// BMP388 stand-in. Like the real driver, readAltitude() performs a
+// fresh reading, so `sim.reads` counts real bus transactions.
+class Adafruit_BMP3XX {
+    public:
+        bool begin_I2C(uint8_t = 0x77) { return true; }
+
+        bool performReading() {
+            sim.reads++;
+            if(!sim.ok) {
+                sim::advanceMicros(sim.timeout_us);
+                return false;
+            }
+            temperature = sim.temp;
+            pressure = 101325.0 * pow(1.0 - sim.alt / 44330.0, 1.0 / 0.1903);
+            return true;
+        }
+
+        float readAltitude(float seaLevel) {
+            performReading();
+            float atmospheric = pressure / 100.0F;
+            return 44330.0 * (1.0 - pow(atmospheric / seaLevel, 0.1903));
+        }
+
+        double temperature = 0;             // C
+        double pressure = 0;                // Pa
+
+        struct {
+            float alt = 0;                  // m above MSL (1013.25 hPa)
+            float temp = 25;
+            bool ok = true;
+            uint32_t timeout_us = 0;        // clock time a failed read burns, as a driver waiting out a hung bus
+            uint32_t reads = 0;
+        } sim;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef PHX_MOCK_ADAFRUIT_BNO055_H
+#define PHX_MOCK_ADAFRUIT_BNO055_H
+
+#include "Adafruit_Sensor.h"
+
+namespace imu {
+    class Quaternion {
+        public:
+            Quaternion(double w = 1, double x = 0, double y = 0, double z = 0) : _w(w), _x(x), _y(y), _z(z) {}
+            double w() const { return _w; }
+            double x() const { return _x; }
+            double y() const { return _y; }
+            double z() const { return _z; }
+        private:
+            double _w, _x, _y, _z;
+    };
+}
+
+// BNO055 stand-in; every getEvent/getQuat/getTemp counts as one bus
+// transaction of the size the real driver reads.
+class Adafruit_BNO055 {
+    public:
+        typedef enum {
+            VECTOR_ACCELEROMETER = 0x08,
+            VECTOR_MAGNETOMETER = 0x0E,
+            VECTOR_GYROSCOPE = 0x14,
+            VECTOR_EULER = 0x1A,
+            VECTOR_LINEARACCEL = 0x28,
+            VECTOR_GRAVITY = 0x2E
+        } adafruit_vector_type_t;
+
+        Adafruit_BNO055(int32_t = -1, uint8_t = 0x28) {}
+        bool begin() { return true; }
+
+        bool getEvent(sensors_event_t *event, adafruit_vector_type_t type) {
+            sim.reads++;
+            sim.bytes += 6;
+            if(!sim.ok) {
+                sim::advanceMicros(sim.timeout_us);
+                return false;
+            }
+            memset(event, 0, sizeof(*event));
+            const float *src = type == VECTOR_ACCELEROMETER ? sim.acc :
+                               type == VECTOR_MAGNETOMETER ? sim.mag :
+                               type == VECTOR_GYROSCOPE ? sim.gyro : sim.euler;
+            for(int i = 0; i < 3; i++) {
+                event->data[i] = src[i];
+            }
+            return true;
+        }
+
+        imu::Quaternion getQuat() {
+            sim.reads++;
+            sim.bytes += 8;
+            return imu::Quaternion(sim.quat[0], sim.quat[1], sim.quat[2], sim.quat[3]);
+        }
+
+        int8_t getTemp() {
+            sim.reads++;
+            sim.bytes += 1;
+            return (int8_t)sim.temp;
+        }
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            float mag[3] = {0, 0, 0};       // uT
+            float gyro[3] = {0, 0, 0};      // rad/s
+            float euler[3] = {0, 0, 0};     // degrees
+            float quat[4] = {1, 0, 0, 0};   // w, x, y, z
+            float temp = 25;
+            bool ok = true;
+            uint32_t timeout_us = 0;        // clock time a failed read burns, as a driver waiting out a hung bus
+            uint32_t reads = 0;
+            uint32_t bytes = 0;             // data bytes transferred
+        } sim;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PHX_MOCK_ADAFRUIT_GPS_H
+#define PHX_MOCK_ADAFRUIT_GPS_H
+
+#include "Arduino.h"
+
+#define MAXLINELENGTH 120
+
+// Ultimate GPS stand-in. Bytes come from the Stream given to the
+// constructor (a MockSerial in the SIL); read() and parse() follow the
+// real driver: one character per read(), newNMEAreceived() once a line
+// ends, parse() understands GGA and RMC.
+class Adafruit_GPS {
+    public:
+        Adafruit_GPS(Stream *s = nullptr) : port(s) {}
+        bool begin(uint32_t) { return true; }
+
+        size_t available() { return port ? port->available() : 0; }
+        char read();
+        bool newNMEAreceived() const { return recvdflag; }
+        char *lastNMEA() { recvdflag = false; return last; }
+        bool parse(char *nmea);
+
+        float latitudeDegrees = 0, longitudeDegrees = 0;
+        float altitude = 0, speed = 0, angle = 0;
+        uint8_t satellites = 0;
+        uint8_t fixquality = 0;
+        bool fix = false;
+
+    private:
+        Stream *port;
+        char line[2][MAXLINELENGTH] = {};
+        char *current = line[0];
+        char *last = line[1];
+        uint8_t lineidx = 0;
+        bool recvdflag = false;
+};
+
+#endif
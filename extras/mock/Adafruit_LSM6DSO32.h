@@ -0,0 +1,35 @@
+#ifndef PHX_MOCK_ADAFRUIT_LSM6DSO32_H
+#define PHX_MOCK_ADAFRUIT_LSM6DSO32_H
+
+#include "Adafruit_Sensor.h"
+
+// LSM6DSO32 stand-in; the SIL writes the next sample into `sim`.
+class Adafruit_LSM6DSO32 {
+    public:
+        bool begin_I2C(uint8_t = 0x6A) { return true; }
+
+        bool getEvent(sensors_event_t *accel, sensors_event_t *gyro, sensors_event_t *temp) {
+            sim.reads++;
+            if(!sim.ok) {
+                sim::advanceMicros(sim.timeout_us);
+                return false;
+            }
+            for(int i = 0; i < 3; i++) {
+                accel->acceleration.v[i] = sim.acc[i];
+                gyro->gyro.v[i] = sim.gyro[i];
+            }
+            temp->temperature = sim.temp;
+            return true;
+        }
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            float gyro[3] = {0, 0, 0};      // rad/s
+            float temp = 25;
+            bool ok = true;
+            uint32_t timeout_us = 0;        // clock time a failed read burns, as a driver waiting out a hung bus
+            uint32_t reads = 0;
+        } sim;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PHX_MOCK_ADAFRUIT_SENSOR_H
+#define PHX_MOCK_ADAFRUIT_SENSOR_H
+
+// Same layout as the unified sensor event: temperature shares storage
+// with the vectors, exactly like the real union.
+
+#include "Arduino.h"
+
+#define SENSORS_GRAVITY_STANDARD (9.80665F)
+#define SENSORS_DPS_TO_RADS      (0.017453293F)
+
+typedef struct {
+    union {
+        float v[3];
+        struct { float x, y, z; };
+    };
+    int8_t status;
+    uint8_t reserved[3];
+} sensors_vec_t;
+
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t reserved0;
+    int32_t timestamp;
+    union {
+        float data[4];
+        sensors_vec_t acceleration;
+        sensors_vec_t magnetic;
+        sensors_vec_t orientation;
+        sensors_vec_t gyro;
+        float temperature;
+        float pressure;
+    };
+} sensors_event_t;
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef PHX_MOCK_ARDUINO_H
+#define PHX_MOCK_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core SRAD_PHX uses.
+// Time comes from a simulated clock (sim::setMicros) so replays run
+// faster than real time; the clock is per thread so parallel harnesses
+// can run independent flights.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define RISING 3
+
+namespace sim {
+    void setMicros(uint64_t us);
+    void advanceMicros(uint64_t us);
+    uint64_t nowMicros();
+}
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// Pins read LOW and interrupts never fire; host tools call the ISR bodies
+// from their own threads.
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class String {
+    public:
+        String() {}
+        String(const char *s) : str(s ? s : "") {}
+        String(const std::string &s) : str(s) {}
+        unsigned int length() const { return str.size(); }
+        const char *c_str() const { return str.c_str(); }
+        String &operator+=(const String &o) { str += o.str; return *this; }
+        String operator+(const String &o) const { return String(str + o.str); }
+        bool operator==(const String &o) const { return str == o.str; }
+    private:
+        std::string str;
+};
+
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size);
+        size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+        virtual int availableForWrite() { return 0; }
+        virtual void flush() {}
+
+        size_t print(const char *s) { return write(s); }
+        size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+        size_t print(char c) { return write((uint8_t)c); }
+        size_t print(unsigned char n, int base = DEC) { return printNumber(n, base); }
+        size_t print(int n, int base = DEC) { return printSigned(n, base); }
+        size_t print(unsigned int n, int base = DEC) { return printNumber(n, base); }
+        size_t print(long n, int base = DEC) { return printSigned(n, base); }
+        size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+        size_t print(long long n, int base = DEC) { return printSigned(n, base); }
+        size_t print(unsigned long long n, int base = DEC) { return printNumber(n, base); }
+        size_t print(double n, int digits = 2) { return printFloat(n, digits); }
+
+        size_t println() { return write("\r\n"); }
+        template <typename T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+        template <typename T> size_t println(const T &v, int f) { size_t n = print(v, f); return n + println(); }
+
+    private:
+        size_t printSigned(long long n, int base);
+        size_t printNumber(unsigned long long n, int base);
+        size_t printFloat(double number, int digits);
+};
+
+class Stream : public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+        size_t readBytes(uint8_t *buffer, size_t length);
+};
+
+// Stream backed by two byte queues, used for serial ports in the SIL.
+class MockSerial : public Stream {
+    public:
+        size_t write(uint8_t b) override { tx += (char)b; return 1; }
+        size_t write(const uint8_t *buffer, size_t size) override { tx.append((const char *)buffer, size); return size; }
+        using Print::write;
+        int availableForWrite() override { return tx_room; }
+        int available() override { return rx.size() - rx_pos; }
+        int read() override { return rx_pos < rx.size() ? (uint8_t)rx[rx_pos++] : -1; }
+        int peek() override { return rx_pos < rx.size() ? (uint8_t)rx[rx_pos] : -1; }
+
+        void feed(const char *data, size_t n) { compact(); rx.append(data, n); }
+        std::string tx;                     // everything written so far
+        int tx_room = 1 << 16;              // what availableForWrite() reports
+    private:
+        void compact() { if(rx_pos) { rx.erase(0, rx_pos); rx_pos = 0; } }
+        std::string rx;
+        size_t rx_pos = 0;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef PHX_MOCK_QUATERNION_H
+#define PHX_MOCK_QUATERNION_H
+
+// Host stand-in for the Quaternion library: only the members SRAD_PHX touches.
+
+struct Vector3 {
+    float x = 0, y = 0, z = 0;
+};
+
+struct Quaternion {
+    float w = 1, x = 0, y = 0, z = 0;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef PHX_MOCK_SD_H
+#define PHX_MOCK_SD_H
+
+// Host stand-in for SD.h: files live on the host filesystem.
+// Pass a null path to SD.open() to get a sink that discards data
+// but still counts bytes, handy for timing the writers alone.
+
+#include "Arduino.h"
+
+#define FILE_READ  0
+#define FILE_WRITE 1
+
+class File : public Stream {
+    public:
+        File() {}
+        File(FILE *f) : fp(f) {}
+
+        size_t write(uint8_t b) override { return write(&b, 1); }
+        size_t write(const uint8_t *buffer, size_t size) override;
+        using Print::write;
+        int available() override;
+        int read() override { return fp ? fgetc(fp) : -1; }
+        int peek() override;
+        void flush() override { flushes++; if(fp) fflush(fp); }
+        void close() { if(fp) fclose(fp); fp = nullptr; }
+        explicit operator bool() const { return true; }
+
+        uint64_t bytes = 0;                 // bytes written, also counted for null sinks
+        uint32_t flushes = 0;
+    private:
+        FILE *fp = nullptr;
+};
+
+class SDClass {
+    public:
+        bool begin(uint8_t = 0) { return true; }
+        File open(const char *path, uint8_t mode = FILE_READ);
+};
+
+extern SDClass SD;
+
+#endif
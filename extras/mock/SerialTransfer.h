@@ -0,0 +1,59 @@
+#ifndef PHX_MOCK_SERIALTRANSFER_H
+#define PHX_MOCK_SERIALTRANSFER_H
+
+#include "Arduino.h"
+
+#define MAX_PACKET_SIZE 0xFE
+#define START_BYTE 0x7E
+#define STOP_BYTE  0x81
+
+// SerialTransfer stand-in with the same txObj/rxObj/sendData/available
+// interface. Frames are START, id, len, payload, crc8, STOP (no COBS);
+// both ends of a SIL link use this class, so the framing only has to
+// agree with itself.
+class SerialTransfer {
+    public:
+        void begin(Stream &s) { port = &s; }
+
+        template <typename T>
+        uint16_t txObj(const T &val, uint16_t index = 0, uint16_t len = sizeof(T)) {
+            if(index + len > MAX_PACKET_SIZE) {
+                len = MAX_PACKET_SIZE - index;
+            }
+            memcpy(packet.txBuff + index, &val, len);
+            return index + len;
+        }
+
+        template <typename T>
+        uint16_t rxObj(T &val, uint16_t index = 0, uint16_t len = sizeof(T)) {
+            if(index + len > MAX_PACKET_SIZE) {
+                len = MAX_PACKET_SIZE - index;
+            }
+            memcpy(&val, packet.rxBuff + index, len);
+            return index + len;
+        }
+
+        uint8_t sendData(uint16_t len, uint8_t id = 0);
+        uint8_t available();
+
+        uint8_t currentPacketID() const { return rx_id; }
+
+        struct {
+            uint8_t txBuff[MAX_PACKET_SIZE];
+            uint8_t rxBuff[MAX_PACKET_SIZE];
+        } packet = {};
+        uint8_t bytesRead = 0;
+        int8_t status = 0;
+        uint32_t crcErrors = 0;
+
+    private:
+        static uint8_t crc8(const uint8_t *data, uint16_t len);
+
+        Stream *port = nullptr;
+        uint8_t state = 0;
+        uint8_t rx_id = 0;
+        uint8_t rx_len = 0;
+        uint8_t rx_idx = 0;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef PHX_MOCK_WIRE_H
+#define PHX_MOCK_WIRE_H
+
+// TwoWire stand-in with no devices on the bus: every transfer fails.
+// The SIL drives register-level chips through RegisterBus instead.
+
+#include "Arduino.h"
+
+class TwoWire {
+    public:
+        void begin() {}
+        void beginTransmission(uint8_t) {}
+        size_t write(uint8_t) { return 1; }
+        uint8_t endTransmission(bool = true) { return 2; }     // address NACK
+        uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+        int available() { return 0; }
+        int read() { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,293 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// Implementations behind the host stand-ins in extras/mock.
+
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "SD.h"
+#include "Adafruit_GPS.h"
+#include "SerialTransfer.h"
+#include "Wire.h"
+
+TwoWire Wire;
+
+static thread_local uint64_t sim_us = 0;
+
+void sim::setMicros(uint64_t us) { sim_us = us; }
+void sim::advanceMicros(uint64_t us) { sim_us += us; }
+uint64_t sim::nowMicros() { return sim_us; }
+
+uint32_t millis() { return (uint32_t)(sim_us / 1000); }
+uint32_t micros() { return (uint32_t)sim_us; }
+void delay(uint32_t ms) { sim_us += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { sim_us += us; }
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while(size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::printSigned(long long n, int base) {
+    if(n < 0) {
+        size_t len = write('-');
+        return len + printNumber(-(unsigned long long)n, base);
+    }
+    return printNumber(n, base);
+}
+
+size_t Print::printNumber(unsigned long long n, int base) {
+    char buf[65];
+    char *p = buf + sizeof(buf);
+    if(base < 2) {
+        base = 10;
+    }
+    do {
+        unsigned d = n % base;
+        *--p = d < 10 ? '0' + d : 'A' + d - 10;
+        n /= base;
+    } while(n);
+    return write((const uint8_t *)p, buf + sizeof(buf) - p);
+}
+
+// digit generation copied from the Arduino core so output matches the board
+size_t Print::printFloat(double number, int digits) {
+    if(isnan(number)) return write("nan");
+    if(isinf(number)) return write("inf");
+    if(number > 4294967040.0) return write("ovf");
+    if(number < -4294967040.0) return write("ovf");
+
+    size_t n = 0;
+    if(number < 0.0) {
+        n += write('-');
+        number = -number;
+    }
+
+    double rounding = 0.5;
+    for(int i = 0; i < digits; i++) {
+        rounding /= 10.0;
+    }
+    number += rounding;
+
+    unsigned long int_part = (unsigned long)number;
+    double remainder = number - (double)int_part;
+    n += printNumber(int_part, 10);
+
+    if(digits > 0) {
+        n += write('.');
+    }
+    while(digits-- > 0) {
+        remainder *= 10.0;
+        unsigned int toPrint = (unsigned int)remainder;
+        n += write((uint8_t)('0' + toPrint));
+        remainder -= toPrint;
+    }
+    return n;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+    size_t n = 0;
+    while(n < length && available()) {
+        buffer[n++] = read();
+    }
+    return n;
+}
+
+SDClass SD;
+
+File SDClass::open(const char *path, uint8_t mode) {
+    if(!path) {
+        return File();
+    }
+    return File(fopen(path, mode == FILE_WRITE ? "wb" : "rb"));
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    bytes += size;
+    if(fp) {
+        return fwrite(buffer, 1, size, fp);
+    }
+    return size;
+}
+
+int File::available() {
+    if(!fp) {
+        return 0;
+    }
+    int c = fgetc(fp);
+    if(c == EOF) {
+        return 0;
+    }
+    ungetc(c, fp);
+    return 1;
+}
+
+int File::peek() {
+    if(!fp) {
+        return -1;
+    }
+    int c = fgetc(fp);
+    if(c != EOF) {
+        ungetc(c, fp);
+    }
+    return c;
+}
+
+char Adafruit_GPS::read() {
+    int c = port ? port->read() : -1;
+    if(c < 0) {
+        return 0;
+    }
+    if(c == '\n') {
+        current[lineidx] = 0;
+        char *t = current;
+        current = last;
+        last = t;
+        lineidx = 0;
+        recvdflag = true;
+    } else if(c != '\r' && lineidx < MAXLINELENGTH - 1) {
+        current[lineidx++] = c;
+    }
+    return c;
+}
+
+static float nmeaDegrees(const char *field, const char *hemisphere) {
+    double v = atof(field);
+    int deg = (int)(v / 100);
+    double degrees = deg + (v - deg * 100) / 60.0;
+    if(*hemisphere == 'S' || *hemisphere == 'W') {
+        degrees = -degrees;
+    }
+    return degrees;
+}
+
+// Splits a sentence into at most 20 comma separated fields, in place.
+static int nmeaFields(char *nmea, char *fields[20]) {
+    int n = 0;
+    char *star = strchr(nmea, '*');
+    if(star) {
+        *star = 0;
+    }
+    fields[n++] = nmea;
+    for(char *p = nmea; *p && n < 20; p++) {
+        if(*p == ',') {
+            *p = 0;
+            fields[n++] = p + 1;
+        }
+    }
+    return n;
+}
+
+bool Adafruit_GPS::parse(char *nmea) {
+    if(nmea[0] != '$' || strlen(nmea) < 6) {
+        return false;
+    }
+    char copy[MAXLINELENGTH];
+    strncpy(copy, nmea, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = 0;
+
+    char *f[20];
+    int n = nmeaFields(copy, f);
+    const char *type = f[0] + 3;
+
+    if(strcmp(type, "GGA") == 0 && n >= 10) {
+        fixquality = atoi(f[6]);
+        fix = fixquality > 0;
+        if(fix) {
+            latitudeDegrees = nmeaDegrees(f[2], f[3]);
+            longitudeDegrees = nmeaDegrees(f[4], f[5]);
+            altitude = atof(f[9]);
+        }
+        satellites = atoi(f[7]);
+        return true;
+    }
+    if(strcmp(type, "RMC") == 0 && n >= 9) {
+        fix = f[2][0] == 'A';
+        if(fix) {
+            latitudeDegrees = nmeaDegrees(f[3], f[4]);
+            longitudeDegrees = nmeaDegrees(f[5], f[6]);
+            speed = atof(f[7]);
+            angle = atof(f[8]);
+        }
+        return true;
+    }
+    return false;
+}
+
+uint8_t SerialTransfer::crc8(const uint8_t *data, uint16_t len) {
+    uint8_t crc = 0;
+    while(len--) {
+        crc ^= *data++;
+        for(int i = 0; i < 8; i++) {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x9B : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint8_t SerialTransfer::sendData(uint16_t len, uint8_t id) {
+    if(!port || len > MAX_PACKET_SIZE) {
+        return 0;
+    }
+    uint8_t head[3] = { START_BYTE, id, (uint8_t)len };
+    uint8_t tail[2] = { crc8(packet.txBuff, len), STOP_BYTE };
+    port->write(head, sizeof(head));
+    port->write(packet.txBuff, len);
+    port->write(tail, sizeof(tail));
+    return len;
+}
+
+// Consumes whatever bytes are waiting; returns the payload length once a
+// whole valid frame has arrived, 0 otherwise.
+uint8_t SerialTransfer::available() {
+    while(port && port->available()) {
+        uint8_t c = port->read();
+        switch(state) {
+            case 0:
+                if(c == START_BYTE) {
+                    state = 1;
+                }
+                break;
+            case 1:
+                rx_id = c;
+                state = 2;
+                break;
+            case 2:
+                rx_len = c;
+                rx_idx = 0;
+                state = rx_len ? 3 : 4;
+                break;
+            case 3:
+                packet.rxBuff[rx_idx++] = c;
+                if(rx_idx == rx_len) {
+                    state = 4;
+                }
+                break;
+            case 4:
+                state = c == crc8(packet.rxBuff, rx_len) ? 5 : 0;
+                if(!state) {
+                    crcErrors++;
+                }
+                break;
+            case 5:
+                state = 0;
+                if(c == STOP_BYTE) {
+                    bytesRead = rx_len;
+                    return bytesRead;
+                }
+                break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "sil_blockdev.h"
+
+SilBlockDevice::~SilBlockDevice() {
+    close();
+}
+
+/**
+ * @brief opens or creates an image of `sectors` sectors
+ *
+ * An existing image keeps its contents, like a card between boots, and
+ * is only ever extended; a new one reads as zeros.
+ */
+bool SilBlockDevice::open(const char *path, uint32_t sectors) {
+    close();
+    fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if(fd < 0) {
+        return false;
+    }
+    count = sectors;
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        return false;
+    }
+    // grow a short image, never shrink a card dump
+    return st.st_size >= (off_t)sectors * PHX_EXTENT_SECTOR || ftruncate(fd, (off_t)sectors * PHX_EXTENT_SECTOR) == 0;
+}
+
+void SilBlockDevice::close() {
+    if(fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+}
+
+void SilBlockDevice::cutAfter(uint32_t n, size_t torn_bytes) {
+    cut = true;
+    cut_left = n;
+    torn = torn_bytes < PHX_EXTENT_SECTOR ? torn_bytes : PHX_EXTENT_SECTOR;
+}
+
+bool SilBlockDevice::readSector(uint32_t lba, uint8_t *dst) {
+    if(fd < 0 || dead || lba >= count) {
+        return false;
+    }
+    reads++;
+    return pread(fd, dst, PHX_EXTENT_SECTOR, (off_t)lba * PHX_EXTENT_SECTOR) == PHX_EXTENT_SECTOR;
+}
+
+bool SilBlockDevice::writeSector(uint32_t lba, const uint8_t *src) {
+    if(fd < 0 || dead || lba >= count) {
+        return false;
+    }
+    sim::advanceMicros(write_us);
+    size_t n = PHX_EXTENT_SECTOR;
+    if(cut && cut_left-- == 0) {
+        n = torn;
+        dead = true;
+    }
+    if(n && pwrite(fd, src, n, (off_t)lba * PHX_EXTENT_SECTOR) != (ssize_t)n) {
+        return false;
+    }
+    writes++;
+    return !dead;
+}
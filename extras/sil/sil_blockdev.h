@@ -0,0 +1,41 @@
+#ifndef PHX_SIL_BLOCKDEV_H
+#define PHX_SIL_BLOCKDEV_H
+
+// A card image in a host file, behind the same BlockDevice the extent
+// log writes on the board. It can charge each sector write to the
+// simulated clock and cut the power after a chosen write, leaving that
+// sector torn the way a brownout would.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SRAD_PHX_Extent.h"
+
+class SilBlockDevice : public BlockDevice {
+    public:
+        ~SilBlockDevice();
+
+        bool open(const char *path, uint32_t sectors);
+        void close();
+
+        bool readSector(uint32_t lba, uint8_t *dst) override;
+        bool writeSector(uint32_t lba, const uint8_t *src) override;
+
+        // after `writes` more sector writes succeed, the next one stores only
+        // its first `torn_bytes` and every access fails until restore()
+        void cutAfter(uint32_t writes, size_t torn_bytes);
+        void restore() { cut = false; dead = false; }
+        bool powered() const { return !dead; }
+
+        uint32_t write_us = 0;              // simulated time per sector write
+        uint32_t reads = 0, writes = 0;     // sectors that reached the image
+
+    private:
+        int fd = -1;
+        uint32_t count = 0;
+        bool cut = false, dead = false;
+        uint32_t cut_left = 0;
+        size_t torn = 0;
+};
+
+#endif
@@ -0,0 +1,256 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "sil_regdev.h"
+
+static int16_t toRaw(float v, float per_lsb) {
+    float r = roundf(v / per_lsb);
+    if(r > 32767) return 32767;
+    if(r < -32768) return -32768;
+    return (int16_t)r;
+}
+
+// Moves a data-rate clock up to `now`, but never more than `limit` periods
+// behind, so a long jump of the simulated clock does not replay hours.
+static void catchUp(uint64_t &next_us, uint64_t now, uint32_t period_us, size_t limit) {
+    if(now > next_us + (uint64_t)period_us * limit) {
+        next_us = now - (uint64_t)period_us * limit;
+    }
+}
+
+SilLsm6dso32::SilLsm6dso32() {
+    memset(regs, 0, sizeof(regs));
+    regs[LSM6DSO32_WHO_AM_I] = LSM6DSO32_WHO_AM_I_VALUE;
+    regs[LSM6DSO32_CTRL3_C] = 0x04;         // IF_INC
+}
+
+void SilLsm6dso32::push(uint8_t tag, const int16_t v[3]) {
+    if(fifo.size() == SIL_LSM_FIFO_WORDS) {
+        fifo.pop_front();                   // continuous mode keeps the newest
+        overrun = true;
+    }
+    Word w;
+    w.b[0] = tag << 3;
+    for(int i = 0; i < 3; i++) {
+        w.b[1 + 2 * i] = (uint8_t)v[i];
+        w.b[2 + 2 * i] = (uint8_t)(v[i] >> 8);
+    }
+    fifo.push_back(w);
+}
+
+/**
+ * @brief writes the FIFO words due since the last bus access
+ */
+void SilLsm6dso32::produce() {
+    static const uint16_t RATES[] = { 104, 208, 416, 833, 1666, 3332, 6667 };
+    uint8_t bdr = regs[LSM6DSO32_FIFO_CTRL3] & 0x0F;
+    if((regs[LSM6DSO32_FIFO_CTRL4] & 0x07) != 0x06 || bdr < 4 || bdr > 10) {
+        return;
+    }
+    uint32_t period_us = 1000000UL / RATES[bdr - 4];
+    uint64_t now = sim::nowMicros();
+    catchUp(next_us, now, period_us, SIL_LSM_FIFO_WORDS);
+
+    while(next_us <= now) {
+        int16_t g[3], a[3];
+        for(int i = 0; i < 3; i++) {
+            g[i] = toRaw(sim.gyro[i], LSM6DSO32_GYRO_RADS_PER_LSB);
+            a[i] = toRaw(sim.acc[i], LSM6DSO32_ACC_MS2_PER_LSB);
+        }
+        if(regs[LSM6DSO32_FIFO_CTRL3] >> 4) {
+            push(LSM6DSO32_TAG_GYRO, g);
+        }
+        push(LSM6DSO32_TAG_ACC, a);
+        sim.produced++;
+
+        if((regs[LSM6DSO32_FIFO_CTRL4] & 0x30) && next_us >= next_temp_us) {
+            int16_t t[3] = { toRaw(sim.temp - 25.0f, 1 / 256.0f), 0, 0 };
+            push(LSM6DSO32_TAG_TEMP, t);
+            next_temp_us = next_us + 80000;  // 12.5 Hz
+        }
+        next_us += period_us;
+    }
+}
+
+bool SilLsm6dso32::readRegs(uint8_t reg, uint8_t *buf, size_t n) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    produce();
+
+    Word cur = {};
+    for(size_t i = 0; i < n; i++) {
+        if(reg >= LSM6DSO32_FIFO_DATA_OUT_TAG && reg < LSM6DSO32_FIFO_DATA_OUT_TAG + LSM6DSO32_FIFO_WORD) {
+            uint8_t k = reg - LSM6DSO32_FIFO_DATA_OUT_TAG;
+            if(k == 0) {
+                cur = Word();
+                if(!fifo.empty()) {
+                    cur = fifo.front();
+                    fifo.pop_front();
+                }
+            }
+            buf[i] = cur.b[k];
+            reg = k == LSM6DSO32_FIFO_WORD - 1 ? LSM6DSO32_FIFO_DATA_OUT_TAG : reg + 1;
+            continue;
+        }
+        switch(reg) {
+            case LSM6DSO32_FIFO_STATUS1:
+                buf[i] = fifo.size() & 0xFF;
+                break;
+            case LSM6DSO32_FIFO_STATUS2:
+                buf[i] = ((fifo.size() >> 8) & 0x03) | (overrun ? 0x40 : 0);
+                overrun = false;
+                break;
+            default:
+                buf[i] = regs[reg & 0x7F];
+        }
+        reg++;
+    }
+    return true;
+}
+
+bool SilLsm6dso32::writeReg(uint8_t reg, uint8_t value) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    regs[reg & 0x7F] = value;
+    if(reg == LSM6DSO32_FIFO_CTRL4) {
+        if((value & 0x07) == 0) {
+            fifo.clear();
+            overrun = false;
+        }
+        next_us = next_temp_us = sim::nowMicros();
+    }
+    return true;
+}
+
+SilAdxl375::SilAdxl375() {
+    memset(regs, 0, sizeof(regs));
+    regs[ADXL375_DEVID] = ADXL375_DEVID_VALUE;
+    regs[ADXL375_BW_RATE] = 0x0A;
+}
+
+void SilAdxl375::produce() {
+    if(!(regs[ADXL375_POWER_CTL] & 0x08) || (regs[ADXL375_FIFO_CTL] >> 6) != 0x02) {
+        return;
+    }
+    uint8_t rate = regs[ADXL375_BW_RATE] & 0x0F;
+    uint32_t period_us = 1000000UL / (3200 >> (0x0F - (rate < 0x06 ? 0x06 : rate)));
+    uint64_t now = sim::nowMicros();
+    catchUp(next_us, now, period_us, ADXL375_FIFO_DEPTH);
+
+    while(next_us <= now) {
+        if(fifo.size() == ADXL375_FIFO_DEPTH) {
+            fifo.pop_front();
+            overrun = true;
+        }
+        Entry e;
+        for(int i = 0; i < 3; i++) {
+            e.v[i] = toRaw(sim.acc[i], ADXL375_ACC_MS2_PER_LSB);
+        }
+        fifo.push_back(e);
+        sim.produced++;
+        next_us += period_us;
+    }
+}
+
+bool SilAdxl375::readRegs(uint8_t reg, uint8_t *buf, size_t n) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    produce();
+
+    Entry cur = {};
+    for(size_t i = 0; i < n; i++, reg++) {
+        if(reg >= ADXL375_DATAX0 && reg < ADXL375_DATAX0 + 6) {
+            if(reg == ADXL375_DATAX0 && !fifo.empty()) {
+                cur = fifo.front();         // a read of the data registers pops one entry
+                fifo.pop_front();
+            }
+            uint8_t k = reg - ADXL375_DATAX0;
+            buf[i] = (uint8_t)(cur.v[k / 2] >> (k & 1 ? 8 : 0));
+            continue;
+        }
+        switch(reg) {
+            case ADXL375_INT_SOURCE:
+                buf[i] = (fifo.empty() ? 0 : 0x80) | (overrun ? 0x01 : 0);
+                overrun = false;
+                break;
+            case ADXL375_FIFO_STATUS:
+                buf[i] = fifo.size();
+                break;
+            default:
+                buf[i] = regs[reg & 0x3F];
+        }
+    }
+    return true;
+}
+
+bool SilAdxl375::writeReg(uint8_t reg, uint8_t value) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    regs[reg & 0x3F] = value;
+    if(reg == ADXL375_FIFO_CTL && (value >> 6) == 0) {
+        fifo.clear();
+        overrun = false;
+    }
+    if(reg == ADXL375_FIFO_CTL || reg == ADXL375_POWER_CTL) {
+        next_us = sim::nowMicros();
+    }
+    return true;
+}
+
+SilBno055::SilBno055() {
+    memset(regs, 0, sizeof(regs));
+    regs[BNO055_CHIP_ID] = BNO055_CHIP_ID_VALUE;
+}
+
+static void putVector(uint8_t *p, const float *v, int n, float per_lsb) {
+    for(int i = 0; i < n; i++) {
+        int16_t r = toRaw(v[i], per_lsb);
+        p[2 * i] = (uint8_t)r;
+        p[2 * i + 1] = (uint8_t)(r >> 8);
+    }
+}
+
+bool SilBno055::readRegs(uint8_t reg, uint8_t *buf, size_t n) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    sim.bytes += n;
+    putVector(regs + BNO055_ACC_DATA, sim.acc, 3, 1 / 100.0f);
+    putVector(regs + BNO055_MAG_DATA, sim.mag, 3, 1 / 16.0f);
+    putVector(regs + BNO055_GYR_DATA, sim.gyro, 3, 0.017453293f / 16.0f);
+    putVector(regs + BNO055_QUA_DATA, sim.quat, 4, 1 / 16384.0f);
+    regs[BNO055_TEMP] = (uint8_t)(int8_t)roundf(sim.temp);
+    for(size_t i = 0; i < n; i++) {
+        buf[i] = regs[(reg + i) & 0x7F];
+    }
+    return true;
+}
+
+bool SilBno055::writeReg(uint8_t reg, uint8_t value) {
+    sim.reads++;
+    if(!sim.ok) {
+        return false;
+    }
+    regs[reg & 0x7F] = value;
+    return true;
+}
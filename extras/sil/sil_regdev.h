@@ -0,0 +1,96 @@
+#ifndef PHX_SIL_REGDEV_H
+#define PHX_SIL_REGDEV_H
+
+// Register-level stand-ins for the LSM6DSO32, ADXL375 and BNO055, behind
+// the same RegisterBus the drivers use on Wire. The LSM and ADXL fill
+// their FIFOs at the data rate they were configured for, on the
+// simulated clock, with whatever reading the SIL last wrote into `sim`
+// (held between trace samples). FIFO depth, overrun flags, the LSM's
+// tagged words and read-address rollback, and the ADXL's pop-per-read
+// follow the datasheets closely enough to exercise the drivers.
+
+#include <deque>
+#include <stdint.h>
+
+#include "SRAD_PHX_Bno.h"
+#include "SRAD_PHX_Fifo.h"
+
+#define SIL_LSM_FIFO_WORDS 438              // 3 kbytes of 7-byte words
+
+class SilLsm6dso32 : public RegisterBus {
+    public:
+        SilLsm6dso32();
+
+        bool readRegs(uint8_t reg, uint8_t *buf, size_t n) override;
+        bool writeReg(uint8_t reg, uint8_t value) override;
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            float gyro[3] = {0, 0, 0};      // rad/s
+            float temp = 25;
+            bool ok = true;
+            uint32_t reads = 0;             // bus transactions
+            uint32_t produced = 0;          // accelerometer words written to the FIFO
+        } sim;
+
+    private:
+        struct Word { uint8_t b[LSM6DSO32_FIFO_WORD]; };
+
+        void produce();
+        void push(uint8_t tag, const int16_t v[3]);
+
+        uint8_t regs[128];
+        std::deque<Word> fifo;
+        uint64_t next_us = 0, next_temp_us = 0;
+        bool overrun = false;
+};
+
+class SilAdxl375 : public RegisterBus {
+    public:
+        SilAdxl375();
+
+        bool readRegs(uint8_t reg, uint8_t *buf, size_t n) override;
+        bool writeReg(uint8_t reg, uint8_t value) override;
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            bool ok = true;
+            uint32_t reads = 0;             // bus transactions
+            uint32_t produced = 0;          // samples written to the FIFO
+        } sim;
+
+    private:
+        struct Entry { int16_t v[3]; };
+
+        void produce();
+
+        uint8_t regs[64];
+        std::deque<Entry> fifo;
+        uint64_t next_us = 0;
+        bool overrun = false;
+};
+
+// BNO055 data registers (page 0) filled from `sim` on every read.
+class SilBno055 : public RegisterBus {
+    public:
+        SilBno055();
+
+        bool readRegs(uint8_t reg, uint8_t *buf, size_t n) override;
+        bool writeReg(uint8_t reg, uint8_t value) override;
+
+        struct {
+            float acc[3] = {0, 0, 0};       // m/s^2
+            float mag[3] = {0, 0, 0};       // uT
+            float gyro[3] = {0, 0, 0};      // rad/s
+            float quat[4] = {1, 0, 0, 0};   // w, x, y, z
+            float temp = 25;
+            bool ok = true;
+            uint32_t reads = 0;             // bus transactions
+            uint32_t bytes = 0;             // data bytes read
+        } sim;
+
+    private:
+        uint8_t regs[128];
+};
+
+#endif
@@ -0,0 +1,168 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include "sil_rig.h"
+
+SilRig::SilRig(const SilThresholds &t, const char *header)
+: gps(&gpsPort), lsmFifo(lsmRegs), adxlFifo(adxlRegs), bnoBurst(bnoRegs), data(),
+  flight(t.accel_liftoff, t.accel_liftoff_time, t.land_time, t.land_altitude, header, gps, data) {
+    flight.setApogeeThresholds(t.apogee_arm, t.apogee_descent, t.apogee_confirm);
+}
+
+static void nmeaCoord(char *out, size_t n, float deg, bool lat) {
+    char hemi = lat ? (deg < 0 ? 'S' : 'N') : (deg < 0 ? 'W' : 'E');
+    deg = fabsf(deg);
+    int whole = (int)deg;
+    snprintf(out, n, lat ? "%02d%07.4f,%c" : "%03d%07.4f,%c", whole, (deg - whole) * 60.0f, hemi);
+}
+
+// Queues a GGA and RMC pair on the GPS port the way the receiver streams them at 1 Hz.
+static void feedGps(MockSerial &port, const TraceSample &s) {
+    char lat[24], lon[24], line[160];
+    nmeaCoord(lat, sizeof(lat), s.gps_lat, true);
+    nmeaCoord(lon, sizeof(lon), s.gps_lon, false);
+    int sats = (int)s.gps_sats;
+    int n = snprintf(line, sizeof(line), "$GPGGA,000000.000,%s,%s,%d,%02d,1.0,%.1f,M,0.0,M,,*00\r\n",
+                     lat, lon, sats > 0 ? 1 : 0, sats, s.gps_alt);
+    port.feed(line, n);
+    n = snprintf(line, sizeof(line), "$GPRMC,000000.000,%c,%s,%s,0.00,0.00,010125,,,A*00\r\n",
+                 sats > 0 ? 'A' : 'V', lat, lon);
+    port.feed(line, n);
+}
+
+/**
+ * @brief sets the clock and every mock sensor from one trace sample
+ *
+ * A NaN in a sensor's first channel makes that sensor's next read fail.
+ * The clock never runs backwards: if failed reads with a `sim.timeout_us`
+ * have pushed it past `s.time_us`, the sample is late instead.
+ */
+void SilRig::apply(const TraceSample &s) {
+    if(s.time_us > sim::nowMicros()) {
+        sim::setMicros(s.time_us);
+    }
+
+    lsm.sim.ok = !isnan(s.lsm_acc[0]);
+    adxl.sim.ok = !isnan(s.adxl_acc[0]);
+    bmp.sim.ok = !isnan(s.bmp_alt);
+    bno.sim.ok = !isnan(s.bno_acc[0]);
+    for(int i = 0; i < 3; i++) {
+        lsm.sim.acc[i] = s.lsm_acc[i];
+        lsm.sim.gyro[i] = s.lsm_gyro[i];
+        adxl.sim.acc[i] = s.adxl_acc[i];
+        bno.sim.acc[i] = s.bno_acc[i];
+        bno.sim.gyro[i] = s.bno_gyro[i];
+        bno.sim.mag[i] = s.bno_mag[i];
+        bnoRegs.sim.acc[i] = s.bno_acc[i];
+        bnoRegs.sim.gyro[i] = s.bno_gyro[i];
+        bnoRegs.sim.mag[i] = s.bno_mag[i];
+    }
+    for(int i = 0; i < 4; i++) {
+        bno.sim.quat[i] = s.bno_quat[i];
+        bnoRegs.sim.quat[i] = s.bno_quat[i];
+    }
+    lsmRegs.sim.ok = lsm.sim.ok;
+    adxlRegs.sim.ok = adxl.sim.ok;
+    for(int i = 0; i < 3; i++) {
+        lsmRegs.sim.acc[i] = s.lsm_acc[i];
+        lsmRegs.sim.gyro[i] = s.lsm_gyro[i];
+        adxlRegs.sim.acc[i] = s.adxl_acc[i];
+    }
+    lsmRegs.sim.temp = s.temp;
+    lsm.sim.temp = s.temp;
+    bno.sim.temp = s.temp;
+    bnoRegs.sim.temp = s.temp;
+    bnoRegs.sim.ok = bno.sim.ok;
+    bmp.sim.temp = s.temp;
+    bmp.sim.alt = s.bmp_alt;
+
+    if(s.time_us >= next_gps_us) {
+        next_gps_us = s.time_us + 1000000;
+        feedGps(gpsPort, s);
+    }
+}
+
+/**
+ * @brief one pass of the flight loop
+ */
+void SilRig::step() {
+    flight.incrementTime();
+    if(fifo) {
+        flight.read_LSM(lsmFifo);
+    } else {
+        flight.read_LSM(lsm);
+    }
+    flight.read_BMP(bmp);
+    if(fifo) {
+        flight.read_ADXL(adxlFifo);
+    } else {
+        flight.read_ADXL(adxl);
+    }
+    if(burst) {
+        flight.read_BNO(bnoBurst);
+    } else {
+        flight.read_BNO(bno);
+    }
+    flight.read_GPS(gps);
+    flight.calculateState();
+
+    if(sd) {
+        flight.writeSD(false, *sd);
+    }
+    if(sdBinary) {
+        flight.writeSDBinary(false, *sdBinary);
+        if(fifo) {
+            flight.writeSamplesBinary(*sdBinary);
+        }
+    }
+    if(serial) {
+        flight.writeSERIAL(false, *serial);
+    }
+    if(logger) {
+        logger->service();
+    }
+}
+
+/**
+ * @brief runs every scheduled task release up to `until_us`
+ *
+ * The clock jumps from one release to the next, so each task sees
+ * its own rate while the sensors hold the last applied sample.
+ */
+void SilRig::stepScheduled(TaskScheduler &sched, uint64_t until_us) {
+    for(;;) {
+        while(sched.service()) {}
+        uint64_t now = sim::nowMicros();
+        uint64_t due = now + (int32_t)(sched.nextDue() - (uint32_t)now);
+        if(due >= until_us) {
+            break;
+        }
+        sim::setMicros(due);
+    }
+}
+
+/**
+ * @brief configures both FIFO drivers and switches step() over to them
+ *
+ * Call with the clock at the start of the trace; the chips start
+ * filling their FIFOs from there.
+ */
+bool SilRig::beginFifo() {
+    fifo = lsmFifo.begin() && adxlFifo.begin();
+    return fifo;
+}
+
+/**
+ * @brief switches step() to the single-burst BNO055 reader
+ */
+bool SilRig::beginBnoBurst() {
+    burst = bnoBurst.begin();
+    return burst;
+}
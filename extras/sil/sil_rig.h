@@ -0,0 +1,65 @@
+#ifndef PHX_SIL_RIG_H
+#define PHX_SIL_RIG_H
+
+// One simulated avionics board: mock sensors wired to a FLIGHT instance.
+// apply() loads a trace sample into the sensors and the clock, step()
+// runs the same sequence of calls as the flight sketch's loop(), and
+// stepScheduled() runs FlightTasks on the simulated clock instead.
+// After beginFifo() the LSM and ADXL are read through their FIFO drivers,
+// and after beginBnoBurst() the BNO through BNO055Burst, on register-level
+// stand-ins (sil_regdev.h).
+
+#include "SRAD_PHX.h"
+#include "sil_regdev.h"
+#include "sil_trace.h"
+
+struct SilThresholds {
+    int accel_liftoff = 30;             // m/s^2
+    int accel_liftoff_time = 100;       // ms
+    int land_time = 5000;               // ms
+    int land_altitude = 10;             // m
+    float apogee_arm = PHX_APOGEE_ARM_VEL;          // m/s, see ApogeeDetector
+    float apogee_descent = PHX_APOGEE_DESCENT_VEL;  // m/s
+    uint8_t apogee_confirm = PHX_APOGEE_CONFIRM;    // baro samples
+};
+
+class SilRig {
+    public:
+        SilRig(const SilThresholds &t = SilThresholds(), const char *header = "");
+
+        void apply(const TraceSample &);
+        void step();
+        void stepScheduled(TaskScheduler &, uint64_t until_us);
+        bool beginFifo();
+        bool beginBnoBurst();
+
+        // optional sinks, left null to skip that writer
+        Print *sd = nullptr;                // writeSD
+        Print *sdBinary = nullptr;          // writeSDBinary
+        Stream *serial = nullptr;           // writeSERIAL
+        SectorLogger *logger = nullptr;     // serviced after the writers
+
+        Adafruit_LSM6DSO32 lsm;
+        Adafruit_BMP3XX bmp;
+        Adafruit_ADXL375 adxl;
+        Adafruit_BNO055 bno;
+        MockSerial gpsPort;
+        Adafruit_GPS gps;
+
+        SilLsm6dso32 lsmRegs;
+        SilAdxl375 adxlRegs;
+        LSM6DSO32Fifo lsmFifo;
+        ADXL375Fifo adxlFifo;
+        bool fifo = false;                  // set by beginFifo()
+        SilBno055 bnoRegs;
+        BNO055Burst bnoBurst;
+        bool burst = false;                 // set by beginBnoBurst()
+
+        FlightData data;
+        FLIGHT flight;
+
+    private:
+        uint64_t next_gps_us = 0;
+};
+
+#endif
@@ -0,0 +1,234 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <string>
+
+#include "sil_trace.h"
+
+#define COLUMN(name, member) { name, offsetof(TraceSample, member) }
+
+// CSV column names understood by loadTrace, written by saveTrace
+static const struct { const char *name; size_t offset; } COLUMNS[] = {
+    COLUMN("lsm_acc_x", lsm_acc[0]),   COLUMN("lsm_acc_y", lsm_acc[1]),   COLUMN("lsm_acc_z", lsm_acc[2]),
+    COLUMN("lsm_gyro_x", lsm_gyro[0]), COLUMN("lsm_gyro_y", lsm_gyro[1]), COLUMN("lsm_gyro_z", lsm_gyro[2]),
+    COLUMN("adxl_acc_x", adxl_acc[0]), COLUMN("adxl_acc_y", adxl_acc[1]), COLUMN("adxl_acc_z", adxl_acc[2]),
+    COLUMN("bno_acc_x", bno_acc[0]),   COLUMN("bno_acc_y", bno_acc[1]),   COLUMN("bno_acc_z", bno_acc[2]),
+    COLUMN("bno_gyro_x", bno_gyro[0]), COLUMN("bno_gyro_y", bno_gyro[1]), COLUMN("bno_gyro_z", bno_gyro[2]),
+    COLUMN("bno_mag_x", bno_mag[0]),   COLUMN("bno_mag_y", bno_mag[1]),   COLUMN("bno_mag_z", bno_mag[2]),
+    COLUMN("bno_quat_w", bno_quat[0]), COLUMN("bno_quat_x", bno_quat[1]),
+    COLUMN("bno_quat_y", bno_quat[2]), COLUMN("bno_quat_z", bno_quat[3]),
+    COLUMN("bmp_alt", bmp_alt),        COLUMN("temp", temp),
+    COLUMN("gps_lat", gps_lat),        COLUMN("gps_lon", gps_lon),
+    COLUMN("gps_alt", gps_alt),        COLUMN("gps_sats", gps_sats),
+    COLUMN("true_alt", true_alt),
+};
+static const int N_COLUMNS = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+static float &column(TraceSample &s, int i) {
+    return *(float *)((char *)&s + COLUMNS[i].offset);
+}
+
+static void blankSample(TraceSample &s) {
+    memset(&s, 0, sizeof(s));
+    s.bno_quat[0] = 1;
+    s.temp = 25;
+    s.true_alt = NAN;
+}
+
+/**
+ * @brief simulates a vertical flight at 1 kHz and samples it at profile.sample_hz
+ *
+ * Accelerometers report specific force along the body z axis (+g on the
+ * pad), so the LSM clips during boost exactly like the flight hardware.
+ */
+std::vector<TraceSample> makeSyntheticFlight(const FlightProfile &p, TruthEvents *truth) {
+    const double g = 9.80665;
+    const double dt = 0.001;
+    std::mt19937 rng(p.seed);
+    std::normal_distribution<float> unit(0, 1);
+    std::uniform_real_distribution<float> chance(0, 1);
+
+    std::vector<TraceSample> trace;
+    double t = 0, alt = 0, vel = 0, acc = 0;
+    double next_sample = 0;
+    bool launched = false, apogee = false, landed = false;
+    double t_landed = 0;
+    TruthEvents ev = { p.pad_s * 1000.0, -1, -1 };
+
+    while(!landed || t - t_landed < p.landed_s) {
+        // dynamics
+        if(t < p.pad_s) {
+            acc = 0;
+        } else if(t < p.pad_s + p.burn_s) {
+            launched = true;
+            acc = p.boost_acc;
+        } else if(!apogee) {
+            acc = -g - p.drag_k * vel * fabs(vel);
+            if(vel <= 0) {
+                apogee = true;
+                ev.apogee_ms = t * 1000.0;
+            }
+        } else if(!landed) {
+            double rate = alt > p.main_alt ? p.drogue_rate : p.main_rate;
+            acc = (-rate - vel) * 2.0;      // settle onto the canopy's descent rate
+        } else {
+            acc = 0;
+        }
+        vel += acc * dt;
+        alt += vel * dt;
+        if(launched && apogee && !landed && alt <= 0) {
+            landed = true;
+            t_landed = t;
+            ev.landed_ms = t * 1000.0;
+        }
+        if(landed || !launched) {
+            alt = 0;
+            vel = 0;
+            acc = 0;
+        }
+
+        if(t >= next_sample) {
+            next_sample += 1.0 / p.sample_hz;
+
+            TraceSample s;
+            blankSample(s);
+            s.time_us = (uint64_t)llround(t * 1e6);
+            float f = acc + g;              // specific force along the rocket axis
+            if(!launched && p.knock_t >= 0 && t >= p.knock_t && t < p.knock_t + p.knock_s) {
+                f += p.knock_acc;           // handled on the pad: felt, but the rocket does not move
+            }
+            for(int i = 0; i < 3; i++) {
+                float truth_f = i == 2 ? f : 0;
+                float lsm = truth_f + p.acc_noise * unit(rng);
+                s.lsm_acc[i] = fmaxf(-p.lsm_range, fminf(p.lsm_range, lsm));
+                s.adxl_acc[i] = truth_f + 4 * p.acc_noise * unit(rng);
+                s.bno_acc[i] = fmaxf(-156.9f, fminf(156.9f, truth_f + p.acc_noise * unit(rng)));
+                s.lsm_gyro[i] = p.gyro_noise * unit(rng);
+                s.bno_gyro[i] = p.gyro_noise * unit(rng);
+            }
+            s.bno_mag[0] = 25;
+            s.bno_mag[2] = -40;
+            s.bmp_alt = p.ground_alt + alt + p.baro_noise * unit(rng);
+            s.true_alt = alt;
+            s.gps_lat = 29.7199f;
+            s.gps_lon = -95.3422f;
+            s.gps_alt = p.ground_alt + alt;
+            s.gps_sats = 9;
+
+            if(p.dropout_rate > 0) {
+                if(chance(rng) < p.dropout_rate) s.lsm_acc[0] = NAN;
+                if(chance(rng) < p.dropout_rate) s.adxl_acc[0] = NAN;
+                if(chance(rng) < p.dropout_rate) s.bmp_alt = NAN;
+                if(chance(rng) < p.dropout_rate) s.bno_acc[0] = NAN;
+            }
+            trace.push_back(s);
+        }
+        t += dt;
+    }
+
+    if(truth) {
+        *truth = ev;
+    }
+    return trace;
+}
+
+/**
+ * @brief reads a trace CSV: a header row of column names, then one row per sample
+ *
+ * `time_ms` is required; any of the COLUMNS names may follow in any order.
+ * Missing accelerometers are filled from the ones that are present.
+ */
+bool loadTrace(const char *path, std::vector<TraceSample> &out) {
+    FILE *f = fopen(path, "r");
+    if(!f) {
+        return false;
+    }
+
+    char line[4096];
+    if(!fgets(line, sizeof(line), f)) {
+        fclose(f);
+        return false;
+    }
+
+    // map CSV columns to sample fields; -1 is time, -2 is unknown
+    std::vector<int> map;
+    bool have[N_COLUMNS] = {};
+    for(char *tok = strtok(line, ",\r\n"); tok; tok = strtok(nullptr, ",\r\n")) {
+        while(*tok == ' ') tok++;
+        int idx = -2;
+        if(strcmp(tok, "time_ms") == 0) {
+            idx = -1;
+        }
+        for(int i = 0; i < N_COLUMNS; i++) {
+            if(strcmp(tok, COLUMNS[i].name) == 0) {
+                idx = i;
+                have[i] = true;
+            }
+        }
+        map.push_back(idx);
+    }
+
+    const bool have_lsm = have[0], have_adxl = have[6], have_bno = have[9];
+
+    while(fgets(line, sizeof(line), f)) {
+        TraceSample s;
+        blankSample(s);
+        char *p = line;
+        for(size_t c = 0; c < map.size() && *p; c++) {
+            char *end;
+            double v = strtod(p, &end);
+            if(map[c] == -1) {
+                s.time_us = (uint64_t)llround(v * 1000.0);
+            } else if(map[c] >= 0) {
+                column(s, map[c]) = v;
+            }
+            p = strchr(end, ',');
+            if(!p) {
+                break;
+            }
+            p++;
+        }
+        for(int i = 0; i < 3; i++) {
+            if(!have_adxl && have_lsm) s.adxl_acc[i] = s.lsm_acc[i];
+            if(!have_lsm && have_adxl) s.lsm_acc[i] = s.adxl_acc[i];
+            if(!have_bno) s.bno_acc[i] = s.lsm_acc[i];
+        }
+        out.push_back(s);
+    }
+    fclose(f);
+    return true;
+}
+
+bool saveTrace(const char *path, const std::vector<TraceSample> &trace) {
+    FILE *f = fopen(path, "w");
+    if(!f) {
+        return false;
+    }
+    fputs("time_ms", f);
+    for(int i = 0; i < N_COLUMNS; i++) {
+        fprintf(f, ",%s", COLUMNS[i].name);
+    }
+    fputc('\n', f);
+    for(TraceSample s : trace) {
+        fprintf(f, "%.3f", s.time_us / 1000.0);
+        for(int i = 0; i < N_COLUMNS; i++) {
+            fprintf(f, ",%.6g", column(s, i));
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+    return true;
+}
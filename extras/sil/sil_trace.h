@@ -0,0 +1,53 @@
+#ifndef PHX_SIL_TRACE_H
+#define PHX_SIL_TRACE_H
+
+// Flight traces for the software-in-the-loop harness: one TraceSample
+// holds what every sensor would report at one instant.
+
+#include <stdint.h>
+#include <vector>
+
+struct TraceSample {
+    uint64_t time_us;
+    float lsm_acc[3], lsm_gyro[3];
+    float adxl_acc[3];
+    float bno_acc[3], bno_gyro[3], bno_mag[3], bno_quat[4];
+    float bmp_alt, temp;                // MSL metres, degrees C
+    float gps_lat, gps_lon, gps_alt, gps_sats;
+    float true_alt;                     // ground truth AGL for synthetic traces, NAN otherwise
+};
+
+// Event times of a synthetic flight, for scoring detection latency.
+struct TruthEvents {
+    double liftoff_ms, apogee_ms, landed_ms;
+};
+
+// Vertical single-axis flight with a boost, drag-limited coast, drogue and main.
+struct FlightProfile {
+    float sample_hz = 100;
+    float pad_s = 10;                   // time on the pad before ignition
+    float ground_alt = 30;              // launch site MSL altitude (m)
+    float boost_acc = 80;               // net acceleration during burn (m/s^2)
+    float burn_s = 3;
+    float drag_k = 0.0004f;             // coast drag, a = -k v|v|
+    float drogue_rate = 25;             // descent rate under drogue (m/s)
+    float main_alt = 250;               // main deploy altitude AGL (m)
+    float main_rate = 6;
+    float landed_s = 20;                // time recorded after touchdown
+    float knock_t = -1;                 // a bump on the pad at this time (s), none if negative
+    float knock_acc = 0;                // its extra axial specific force (m/s^2)
+    float knock_s = 0.05f;              // and how long it lasts
+
+    float baro_noise = 0.3f;            // 1 sigma, metres
+    float acc_noise = 0.2f;             // 1 sigma, m/s^2
+    float gyro_noise = 0.01f;           // 1 sigma, rad/s
+    float lsm_range = 313.8f;           // LSM6DSO32 saturates at 32 g
+    float dropout_rate = 0;             // chance per sample that a sensor read fails
+    uint32_t seed = 1;
+};
+
+std::vector<TraceSample> makeSyntheticFlight(const FlightProfile &, TruthEvents *truth = nullptr);
+bool loadTrace(const char *path, std::vector<TraceSample> &out);
+bool saveTrace(const char *path, const std::vector<TraceSample> &trace);
+
+#endif
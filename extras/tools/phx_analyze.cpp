@@ -0,0 +1,1028 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_analyze: post-flight summary of a flight log.
+//
+// The log (a binary log from FLIGHT::writeSDBinary, a CSV from writeSD,
+// or a CSV from the older firmware that printed the five status bits on
+// a second line after bmp_temp) is memory-mapped and converted once into
+// a columnar file next to it, <log>.phxcol: one contiguous array per
+// schema field. Later runs map that file directly. The summaries are
+// single passes over those arrays.
+//
+// The detection replay runs FLIGHT's own read_LSM/read_ADXL/read_BMP and
+// calculateState over every row, once per threshold set, one set per
+// thread. Lists of thresholds are expanded to every combination.
+//
+//   usage: phx_analyze [--rebuild] [--col out.phxcol] [--threads n]
+//                      [--liftoff-acc list] [--liftoff-ms list]
+//                      [--land-ms list] [--land-alt list] <log>
+//     lists are comma separated, e.g. --liftoff-acc 20,30,40
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "SRAD_PHX.h"
+#include "sil_rig.h"
+
+#define COL_MAGIC       "PHXCOL"
+#define COL_MAGIC_LEN   6
+#define COL_VERSION     1
+#define COL_ALIGN       64                  // every column starts on a cache line
+
+enum COL_SOURCE : uint8_t {
+    SOURCE_BINARY = 0,
+    SOURCE_CSV = 1,
+    SOURCE_LEGACY_CSV = 2,
+};
+
+struct __attribute__((packed)) ColFileHeader {
+    char magic[COL_MAGIC_LEN];              // COL_MAGIC, not null terminated
+    uint8_t version;                        // COL_VERSION
+    uint8_t source;                         // COL_SOURCE
+    uint32_t column_count;
+    uint64_t rows;
+    uint64_t source_size;                   // the log this was built from, to spot a stale file
+    int64_t source_mtime_ns;
+    uint64_t imu_records, events;           // counted, not stored
+};
+
+struct __attribute__((packed)) ColDesc {
+    char name[20];                          // null padded, as LogFieldDesc
+    uint8_t type;                           // LogFieldType
+    uint8_t precision;
+    uint8_t present;                        // 0 if the log had no such column; the array is then NaN or 0
+    uint8_t reserved;
+    uint64_t offset;                        // from the start of the file
+};
+
+// one index per schema field, in schema order
+enum COLUMN {
+#define PHX_COL_ENUM(name, type, precision, tlm, member, label, flags) COL_##name,
+    PHX_FLIGHT_FIELDS(PHX_COL_ENUM)
+#undef PHX_COL_ENUM
+    COL_COUNT
+};
+
+static const uint8_t TYPE_SIZE[] = { 1, 2, 8, 4, 4 };   // by LogFieldType
+
+static const int STATUS_COLS[5] = { COL_status_lsm, COL_status_bmp, COL_status_adxl, COL_status_bno, COL_status_gps };
+static const char *SENSOR_NAMES[5] = { "LSM", "BMP", "ADXL", "BNO", "GPS" };
+static const char *STATE_NAMES[5] = { "PRE_NO_CAL", "PRE_CAL", "ASCENT", "DESCENT", "LANDED" };
+
+/**
+ * @brief a whole file, mapped read-only
+ */
+class MappedFile {
+    public:
+        MappedFile() {}
+        MappedFile(const MappedFile &) = delete;
+        MappedFile& operator=(const MappedFile &) = delete;
+        ~MappedFile() { close(); }
+
+        void close() {
+            if(data) munmap((void *)data, size);
+            data = nullptr;
+            size = 0;
+        }
+
+        bool open(const char *path, struct stat *st = nullptr) {
+            close();
+            int fd = ::open(path, O_RDONLY);
+            if(fd < 0) {
+                return false;
+            }
+            struct stat s;
+            if(fstat(fd, &s) != 0 || s.st_size == 0) {
+                ::close(fd);
+                return false;
+            }
+            void *p = mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if(p == MAP_FAILED) {
+                return false;
+            }
+            madvise(p, s.st_size, MADV_SEQUENTIAL);
+            data = (const uint8_t *)p;
+            size = s.st_size;
+            if(st) *st = s;
+            return true;
+        }
+
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+};
+
+static int64_t mtimeNs(const struct stat &st) {
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+// ---------------------------------------------------------------------------
+// conversion: any log -> rows -> columnar file
+
+struct Rows {
+    std::vector<FlightRecord> rec;
+    bool present[COL_COUNT];
+    uint8_t source;
+    uint64_t imu_records = 0, events = 0;
+};
+
+static void clearRecord(FlightRecord &r) {
+#define PHX_CLEAR_FIELD(name, type, precision, tlm, member, label, flags) \
+    r.name = LOG_##type == LOG_F32 ? (PHX_CTYPE_##type)NAN : (PHX_CTYPE_##type)0;
+    PHX_FLIGHT_FIELDS(PHX_CLEAR_FIELD)
+#undef PHX_CLEAR_FIELD
+}
+
+// an empty or unparsable field stays as clearRecord left it
+static void setField(FlightRecord &r, int col, const char *tok) {
+    while(*tok == ' ') tok++;
+    if(!*tok) {
+        return;
+    }
+    char *end;
+    double v = strtod(tok, &end);
+    if(end == tok) {
+        return;
+    }
+    switch(col) {
+#define PHX_SET_FIELD(name, type, precision, tlm, member, label, flags) \
+        case COL_##name: r.name = (PHX_CTYPE_##type)v; break;
+        PHX_FLIGHT_FIELDS(PHX_SET_FIELD)
+#undef PHX_SET_FIELD
+    }
+}
+
+static int columnByName(const char *name) {
+    for(int c = 0; c < COL_COUNT; c++) {
+        if(strncmp(PHX_LOG_FIELDS[c].name, name, sizeof(PHX_LOG_FIELDS[c].name)) == 0 &&
+           strlen(name) <= sizeof(PHX_LOG_FIELDS[c].name)) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief walks a mapped text file one line at a time
+ *
+ * Each line is copied out, null terminated and split on commas in place,
+ * so strtod never runs off the end of the mapping.
+ */
+class LineReader {
+    public:
+        LineReader(const uint8_t *p, size_t n) : p((const char *)p), end((const char *)p + n) {}
+
+        bool next() {
+            if(p >= end) {
+                return false;
+            }
+            const char *nl = (const char *)memchr(p, '\n', end - p);
+            const char *stop = nl ? nl : end;
+            size_t n = stop - p;
+            if(n && stop[-1] == '\r') n--;
+            if(n >= sizeof(line)) n = sizeof(line) - 1;
+            memcpy(line, p, n);
+            line[n] = 0;
+            p = nl ? nl + 1 : end;
+
+            count = 0;
+            tok[count++] = line;
+            for(size_t i = 0; i < n; i++) {
+                if(line[i] == ',' && count < MAX_TOKENS) {
+                    line[i] = 0;
+                    tok[count++] = line + i + 1;
+                }
+            }
+            return true;
+        }
+
+        bool blank() const { return count == 1 && !tok[0][0]; }
+
+        static const int MAX_TOKENS = 64;
+        char *tok[MAX_TOKENS];
+        int count = 0;
+
+    private:
+        const char *p, *end;
+        char line[PHX_CSV_LINE_MAX + 1];
+};
+
+static bool isStatusLine(const LineReader &r) {
+    if(r.count != 5) {
+        return false;
+    }
+    for(int i = 0; i < 5; i++) {
+        const char *t = r.tok[i];
+        while(*t == ' ') t++;
+        if((t[0] != '0' && t[0] != '1') || t[1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readBinary(const MappedFile &f, Rows &rows) {
+    LogFileHeader hdr;
+    if(f.size < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, f.data, sizeof(hdr));
+    if(hdr.version < 2 || hdr.version > PHX_LOG_VERSION || hdr.record_size != sizeof(LogRecord) || !hdr.little_endian) {
+        fprintf(stderr, "unsupported log version %u (record %u bytes)\n", hdr.version, hdr.record_size);
+        return false;
+    }
+    rows.source = SOURCE_BINARY;
+    for(int c = 0; c < COL_COUNT; c++) {
+        rows.present[c] = true;
+    }
+    rows.rec.reserve((f.size - hdr.header_size) / sizeof(LogRecord));
+
+    // same resynchronization as phx_decode
+    size_t pos = hdr.header_size;
+    while(pos + sizeof(LogEventRecord) <= f.size) {
+        uint16_t sync;
+        memcpy(&sync, f.data + pos, sizeof(sync));
+        size_t left = f.size - pos;
+        if(sync == PHX_LOG_SYNC_EVENT) {
+            pos += sizeof(LogEventRecord);
+            rows.events++;
+        } else if(sync == PHX_LOG_SYNC_IMU && left >= sizeof(LogImuRecord)) {
+            pos += sizeof(LogImuRecord);
+            rows.imu_records++;
+        } else if(sync == PHX_LOG_SYNC && left >= sizeof(LogRecord)) {
+            LogRecord rec;
+            memcpy(&rec, f.data + pos, sizeof(rec));
+            rows.rec.push_back(rec.data);
+            pos += sizeof(rec);
+        } else {
+            pos++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief the older writeSD layout
+ *
+ * `time, GPS..., bno quat(4), bno gyro(3), bno acc(3), adxl acc(3),
+ * bmp_press, bmp_alt, lsm_temp, adxl_temp, bno_temp, bmp_temp` on one
+ * line, the five sensorStatus bits on the next. Without a fix the GPS
+ * part is the literal `-1,No fix,-1,No fix,0,-1,-1,-1` (8 fields, 6 with
+ * a fix). The LSM, magnetometer, state and estimate were not logged.
+ */
+static void readLegacyCsv(const MappedFile &f, Rows &rows) {
+    static const int AFTER_GPS[] = {
+        COL_bno_quat_w, COL_bno_quat_x, COL_bno_quat_y, COL_bno_quat_z,
+        COL_bno_gyro_x, COL_bno_gyro_y, COL_bno_gyro_z,
+        COL_bno_acc_x, COL_bno_acc_y, COL_bno_acc_z,
+        COL_adxl_acc_x, COL_adxl_acc_y, COL_adxl_acc_z,
+        COL_bmp_press, COL_bmp_alt, COL_lsm_temp, COL_adxl_temp, COL_bno_temp, COL_bmp_temp,
+    };
+    static const int GPS[] = { COL_gps_lat, COL_gps_lon, COL_gps_sats, COL_gps_speed, COL_gps_angle, COL_gps_alt };
+    const int n_after = sizeof(AFTER_GPS) / sizeof(AFTER_GPS[0]);
+
+    rows.source = SOURCE_LEGACY_CSV;
+    for(int c = 0; c < COL_COUNT; c++) {
+        rows.present[c] = false;
+    }
+    rows.present[COL_totalTime_ms] = rows.present[COL_gps_fix] = true;
+    for(int c : GPS) rows.present[c] = true;
+    for(int c : AFTER_GPS) rows.present[c] = true;
+    for(int c : STATUS_COLS) rows.present[c] = true;
+
+    LineReader in(f.data, f.size);
+    FlightRecord r;
+    bool pending = false;
+    while(in.next()) {
+        if(isStatusLine(in)) {
+            if(pending) {
+                for(int i = 0; i < 5; i++) {
+                    setField(r, STATUS_COLS[i], in.tok[i]);
+                }
+                rows.rec.push_back(r);
+                pending = false;
+            }
+            continue;
+        }
+        const char *gps2 = in.count > 2 ? in.tok[2] : "";
+        bool fix = !strstr(gps2, "No fix");
+        int first = fix ? 7 : 9;
+        char *end;
+        strtod(in.tok[0], &end);
+        if(in.count != first + n_after || end == in.tok[0]) {
+            pending = false;                // the header, or a torn line
+            continue;
+        }
+        clearRecord(r);
+        setField(r, COL_totalTime_ms, in.tok[0]);
+        r.gps_fix = fix;
+        for(int i = 0; fix && i < 6; i++) {
+            setField(r, GPS[i], in.tok[1 + i]);
+        }
+        for(int i = 0; i < n_after; i++) {
+            setField(r, AFTER_GPS[i], in.tok[first + i]);
+        }
+        for(int i = 0; i < 5; i++) {
+            setField(r, STATUS_COLS[i], "0");
+        }
+        pending = true;
+    }
+}
+
+/**
+ * @brief the schema CSV, one line per row
+ *
+ * Columns are matched by name; a custom header from older firmware, which
+ * printed FLIGHT's `data_header` in place of the column names, with as
+ * many columns as the schema is taken to be in schema order. `#event`
+ * lines are counted; they and other `#` lines are skipped.
+ */
+static void readCsv(const MappedFile &f, Rows &rows) {
+    LineReader in(f.data, f.size);
+    int map[LineReader::MAX_TOKENS];
+    rows.source = SOURCE_CSV;
+    for(int c = 0; c < COL_COUNT; c++) {
+        rows.present[c] = false;
+    }
+
+    bool header = false;
+    while(in.next()) {
+        if(in.blank()) {
+            continue;
+        }
+        if(in.tok[0][0] == '#') {
+            if(!strncmp(in.tok[0], "#event", 6)) {
+                rows.events++;
+            }
+            continue;
+        }
+        if(!header) {
+            header = true;
+            int named = 0;
+            for(int i = 0; i < in.count; i++) {
+                const char *t = in.tok[i];
+                while(*t == ' ') t++;
+                map[i] = columnByName(t);
+                named += map[i] >= 0;
+            }
+            if(named == 0 && in.count == COL_COUNT) {
+                for(int i = 0; i < in.count; i++) map[i] = i;
+            }
+            for(int i = 0; i < in.count; i++) {
+                if(map[i] >= 0) rows.present[map[i]] = true;
+            }
+            for(int i = in.count; i < LineReader::MAX_TOKENS; i++) {
+                map[i] = -1;
+            }
+            continue;
+        }
+        FlightRecord r;
+        clearRecord(r);
+        for(int i = 0; i < in.count; i++) {
+            if(map[i] >= 0) setField(r, map[i], in.tok[i]);
+        }
+        rows.rec.push_back(r);
+    }
+}
+
+static bool readLog(const MappedFile &f, Rows &rows) {
+    if(f.size >= PHX_LOG_MAGIC_LEN && memcmp(f.data, PHX_LOG_MAGIC, PHX_LOG_MAGIC_LEN) == 0) {
+        return readBinary(f, rows);
+    }
+    // the old layout is the only one with a line of just five 0/1 fields
+    LineReader probe(f.data, std::min(f.size, (size_t)64 * 1024));
+    for(int i = 0; i < 32 && probe.next(); i++) {
+        if(isStatusLine(probe)) {
+            readLegacyCsv(f, rows);
+            return true;
+        }
+    }
+    readCsv(f, rows);
+    return true;
+}
+
+static bool writeColumns(const char *path, const Rows &rows, const struct stat &src) {
+    ColFileHeader hdr;
+    memcpy(hdr.magic, COL_MAGIC, COL_MAGIC_LEN);
+    hdr.version = COL_VERSION;
+    hdr.source = rows.source;
+    hdr.column_count = COL_COUNT;
+    hdr.rows = rows.rec.size();
+    hdr.source_size = src.st_size;
+    hdr.source_mtime_ns = mtimeNs(src);
+    hdr.imu_records = rows.imu_records;
+    hdr.events = rows.events;
+
+    ColDesc desc[COL_COUNT];
+    uint64_t offset = sizeof(hdr) + sizeof(desc);
+    for(int c = 0; c < COL_COUNT; c++) {
+        memset(&desc[c], 0, sizeof(desc[c]));
+        memcpy(desc[c].name, PHX_LOG_FIELDS[c].name, sizeof(desc[c].name));
+        desc[c].type = PHX_LOG_FIELDS[c].type;
+        desc[c].precision = PHX_LOG_FIELDS[c].precision;
+        desc[c].present = rows.present[c];
+        offset = (offset + COL_ALIGN - 1) / COL_ALIGN * COL_ALIGN;
+        desc[c].offset = offset;
+        offset += hdr.rows * TYPE_SIZE[desc[c].type];
+    }
+
+    // written beside the target and renamed, so a reader never maps half a file
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *out = fopen(tmp.c_str(), "wb");
+    if(!out) {
+        perror(tmp.c_str());
+        return false;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, out);
+    fwrite(desc, sizeof(desc), 1, out);
+
+    static const char zeros[COL_ALIGN] = {};
+    const size_t n = rows.rec.size();
+#define PHX_WRITE_COLUMN(name, type, precision, tlm, member, label, flags) { \
+        fwrite(zeros, 1, desc[COL_##name].offset - ftell(out), out); \
+        std::vector<PHX_CTYPE_##type> v(n); \
+        for(size_t i = 0; i < n; i++) v[i] = rows.rec[i].name; \
+        fwrite(v.data(), sizeof(v[0]), n, out); \
+    }
+    PHX_FLIGHT_FIELDS(PHX_WRITE_COLUMN)
+#undef PHX_WRITE_COLUMN
+
+    bool ok = !ferror(out);
+    ok &= fclose(out) == 0;
+    if(!ok || rename(tmp.c_str(), path) != 0) {
+        perror(path);
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// the mapped columnar file
+
+struct Columns {
+    const ColFileHeader *hdr = nullptr;
+    size_t rows = 0;
+    const void *col[COL_COUNT] = {};
+    bool present[COL_COUNT] = {};
+
+    const float *f32(int c) const { return (const float *)col[c]; }
+    const uint8_t *u8(int c) const { return (const uint8_t *)col[c]; }
+    const uint64_t *time() const { return (const uint64_t *)col[COL_totalTime_ms]; }
+};
+
+static bool mapColumns(const MappedFile &f, Columns &cols) {
+    if(f.size < sizeof(ColFileHeader) || memcmp(f.data, COL_MAGIC, COL_MAGIC_LEN) != 0) {
+        return false;
+    }
+    const ColFileHeader *hdr = (const ColFileHeader *)f.data;
+    if(hdr->version != COL_VERSION || sizeof(ColFileHeader) + hdr->column_count * sizeof(ColDesc) > f.size) {
+        return false;
+    }
+    cols.hdr = hdr;
+    cols.rows = hdr->rows;
+    const ColDesc *desc = (const ColDesc *)(f.data + sizeof(ColFileHeader));
+    for(uint32_t i = 0; i < hdr->column_count; i++) {
+        char name[sizeof(desc[i].name) + 1] = {};
+        memcpy(name, desc[i].name, sizeof(desc[i].name));
+        int c = columnByName(name);
+        if(c < 0 || desc[i].type != PHX_LOG_FIELDS[c].type ||
+           desc[i].offset + hdr->rows * TYPE_SIZE[desc[i].type] > f.size) {
+            continue;
+        }
+        cols.col[c] = f.data + desc[i].offset;
+        cols.present[c] = desc[i].present;
+    }
+    for(int c = 0; c < COL_COUNT; c++) {
+        if(!cols.col[c]) {
+            fprintf(stderr, "columnar file is missing %s; rebuild it with --rebuild\n", PHX_LOG_FIELDS[c].name);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// summaries
+
+struct Peak {
+    float value = -INFINITY;
+    size_t index = 0;
+};
+
+// largest |v| of three columns; NaN rows never win
+static Peak peakMagnitude(const Columns &cols, int cx, int cy, int cz) {
+    const float *x = cols.f32(cx), *y = cols.f32(cy), *z = cols.f32(cz);
+    const size_t n = cols.rows;
+    float best = -INFINITY;
+#pragma omp simd reduction(max:best)
+    for(size_t i = 0; i < n; i++) {
+        float m = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        best = m > best ? m : best;
+    }
+    Peak p;
+    for(size_t i = 0; i < n; i++) {
+        if(x[i] * x[i] + y[i] * y[i] + z[i] * z[i] == best) {
+            p.value = sqrtf(best);
+            p.index = i;
+            break;
+        }
+    }
+    return p;
+}
+
+static Peak peakValue(const float *v, size_t n, size_t from = 0) {
+    float best = -INFINITY;
+#pragma omp simd reduction(max:best)
+    for(size_t i = from; i < n; i++) {
+        best = v[i] > best ? v[i] : best;
+    }
+    Peak p;
+    for(size_t i = from; i < n; i++) {
+        if(v[i] == best) {
+            p.value = best;
+            p.index = i;
+            break;
+        }
+    }
+    return p;
+}
+
+static double seconds(const Columns &cols, size_t i) {
+    return (cols.time()[i] - cols.time()[0]) / 1000.0;
+}
+
+static void summarizeAcceleration(const Columns &cols) {
+    struct { const char *name; int x, y, z; } sensors[] = {
+        { "LSM", COL_lsm_acc_x, COL_lsm_acc_y, COL_lsm_acc_z },
+        { "ADXL", COL_adxl_acc_x, COL_adxl_acc_y, COL_adxl_acc_z },
+        { "BNO", COL_bno_acc_x, COL_bno_acc_y, COL_bno_acc_z },
+    };
+    printf("\nmax acceleration\n");
+    for(const auto &s : sensors) {
+        if(!cols.present[s.x]) {
+            printf("  %-5s not logged\n", s.name);
+            continue;
+        }
+        Peak p = peakMagnitude(cols, s.x, s.y, s.z);
+        if(isinf(p.value)) {
+            printf("  %-5s no samples\n", s.name);
+            continue;
+        }
+        printf("  %-5s %8.2f m/s^2 (%5.2f g) at %.3f s\n", s.name, p.value, p.value / PHX_GRAVITY, seconds(cols, p.index));
+    }
+}
+
+/**
+ * @brief MSL altitude from the logged pressure
+ *
+ * bmp_alt switches from MSL to AGL at liftoff, and the legacy log's
+ * bmp_alt depends on the firmware, so the pressure is used instead,
+ * with read_BMP's formula.
+ */
+static std::vector<float> baroAltitude(const Columns &cols) {
+    const float *p = cols.f32(COL_bmp_press);
+    const uint8_t *bad = cols.u8(COL_status_bmp);
+    std::vector<float> alt(cols.rows);
+    for(size_t i = 0; i < cols.rows; i++) {
+        alt[i] = bad[i] || !(p[i] > 0) ? NAN : 44330.0f * (1.0f - powf(p[i] / 100.0f / 1013.25f, 0.1903f));
+    }
+    return alt;
+}
+
+static size_t rowAtOrAfter(const Columns &cols, uint64_t time_ms) {
+    const uint64_t *t = cols.time();
+    return std::lower_bound(t, t + cols.rows, time_ms) - t;
+}
+
+static void summarizeAltitude(const Columns &cols, const std::vector<float> &alt, float land_alt) {
+    const size_t n = cols.rows;
+    printf("\naltitude\n");
+
+    // pad altitude: mean of the first second of good baro samples
+    double sum = 0;
+    size_t count = 0;
+    size_t pad_end = std::max(rowAtOrAfter(cols, cols.time()[0] + 1000), (size_t)1);
+    for(size_t i = 0; i < pad_end && i < n; i++) {
+        if(!isnan(alt[i])) {
+            sum += alt[i];
+            count++;
+        }
+    }
+    if(!count) {
+        printf("  no barometer samples on the pad\n");
+        return;
+    }
+    float ground = sum / count;
+    Peak apogee = peakValue(alt.data(), n);
+    printf("  pad        %9.2f m MSL\n", ground);
+    printf("  apogee     %9.2f m AGL at %.3f s (baro)\n", apogee.value - ground, seconds(cols, apogee.index));
+    if(cols.present[COL_est_alt]) {
+        Peak est = peakValue(cols.f32(COL_est_alt), n);
+        if(!isinf(est.value)) {
+            printf("             %9.2f m AGL at %.3f s (estimate)\n", est.value, seconds(cols, est.index));
+        }
+    }
+
+    // touchdown: first good sample back within land_alt of the pad
+    size_t land = n;
+    for(size_t i = apogee.index; i < n; i++) {
+        if(alt[i] - ground < land_alt) {
+            land = i;
+            break;
+        }
+    }
+    if(land == n || land == apogee.index) {
+        printf("  descent    log ends before touchdown\n");
+        return;
+    }
+    double t_apo = seconds(cols, apogee.index), t_land = seconds(cols, land);
+    printf("  descent    %9.2f m/s mean over %.1f s\n", (apogee.value - alt[land]) / (t_land - t_apo), t_land - t_apo);
+
+    // the last 100 m, under the main on a nominal flight
+    float top = ground + land_alt + 100;
+    if(apogee.value > top) {
+        size_t from = apogee.index;
+        while(from < land && !(alt[from] < top)) from++;
+        if(from < land) {
+            double dt = seconds(cols, land) - seconds(cols, from);
+            printf("             %9.2f m/s over the last 100 m (%.1f s)\n", (alt[from] - alt[land]) / dt, dt);
+        }
+    }
+    printf("  touchdown  at %.3f s\n", t_land);
+}
+
+static void summarizeDropouts(const Columns &cols) {
+    const uint64_t *t = cols.time();
+    printf("\nsensor dropouts\n");
+    for(int s = 0; s < 5; s++) {
+        if(!cols.present[STATUS_COLS[s]]) {
+            continue;
+        }
+        const uint8_t *bad = cols.u8(STATUS_COLS[s]);
+        const size_t n = cols.rows;
+        size_t flagged = 0;
+#pragma omp simd reduction(+:flagged)
+        for(size_t i = 0; i < n; i++) {
+            flagged += bad[i] != 0;
+        }
+        if(!flagged) {
+            printf("  %-5s none\n", SENSOR_NAMES[s]);
+            continue;
+        }
+        // a span runs from its first bad row to the next good one
+        uint32_t spans = 0;
+        uint64_t total = 0, longest = 0, longest_at = 0;
+        for(size_t i = 0; i < n; ) {
+            if(!bad[i]) {
+                i++;
+                continue;
+            }
+            size_t j = i;
+            while(j < n && bad[j]) j++;
+            uint64_t len = (j < n ? t[j] : t[n - 1]) - t[i];
+            spans++;
+            total += len;
+            if(len >= longest) {
+                longest = len;
+                longest_at = t[i] - t[0];
+            }
+            i = j;
+        }
+        printf("  %-5s %u spans, %zu rows, %.3f s total, longest %.3f s at %.3f s\n", SENSOR_NAMES[s],
+               spans, flagged, total / 1000.0, longest / 1000.0, longest_at / 1000.0);
+    }
+}
+
+struct Jitter {
+    size_t n = 0;
+    double mean = 0, stddev = 0, median = 0, p99 = 0, max = 0;
+};
+
+static Jitter jitterOf(std::vector<float> &dt) {
+    Jitter j;
+    j.n = dt.size();
+    if(!j.n) {
+        return j;
+    }
+    const float *d = dt.data();
+    const size_t n = dt.size();
+    double sum = 0, sq = 0;
+    float mx = 0;
+#pragma omp simd reduction(+:sum, sq) reduction(max:mx)
+    for(size_t i = 0; i < n; i++) {
+        sum += d[i];
+        sq += (double)d[i] * d[i];
+        mx = d[i] > mx ? d[i] : mx;
+    }
+    j.mean = sum / n;
+    j.stddev = sqrt(std::max(0.0, sq / n - j.mean * j.mean));
+    j.max = mx;
+    std::nth_element(dt.begin(), dt.begin() + n / 2, dt.end());
+    j.median = dt[n / 2];
+    size_t k = std::min(n - 1, (size_t)(n * 0.99));
+    std::nth_element(dt.begin(), dt.begin() + k, dt.end());
+    j.p99 = dt[k];
+    return j;
+}
+
+/**
+ * @brief spacing of consecutive rows
+ *
+ * Per state when the state was logged: the rate policy logs some states
+ * at a fraction of the loop rate, which would otherwise read as jitter.
+ */
+static void summarizeJitter(const Columns &cols) {
+    const uint64_t *t = cols.time();
+    const uint8_t *state = cols.u8(COL_state);
+    const bool by_state = cols.present[COL_state];
+    std::vector<float> dt[6];
+    for(size_t i = 1; i < cols.rows; i++) {
+        float d = (float)(int64_t)(t[i] - t[i - 1]);
+        dt[5].push_back(d);
+        if(by_state && state[i] < 5 && state[i] == state[i - 1]) {
+            dt[state[i]].push_back(d);
+        }
+    }
+    printf("\nrow spacing (ms)      rows     mean   stddev   median      p99      max\n");
+    for(int s = 0; s < 6; s++) {
+        if(s < 5 && (!by_state || dt[s].empty())) {
+            continue;
+        }
+        Jitter j = jitterOf(dt[s]);
+        printf("  %-14s %9zu %8.2f %8.2f %8.2f %8.2f %8.2f\n", s < 5 ? STATE_NAMES[s] : "all",
+               j.n, j.mean, j.stddev, j.median, j.p99, j.max);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// detection replay
+
+struct Thresholds {
+    int accel_liftoff, accel_liftoff_time, land_time, land_altitude;
+};
+
+struct Replay {
+    Thresholds t;
+    uint64_t entered_ms[5];                 // first row in each state, UINT64_MAX if never
+};
+
+static void findTransitions(const Columns &cols, uint64_t entered_ms[5]) {
+    const uint8_t *state = cols.u8(COL_state);
+    for(int s = 0; s < 5; s++) entered_ms[s] = UINT64_MAX;
+    for(size_t i = 0; i < cols.rows; i++) {
+        uint8_t s = state[i];
+        if(s < 5 && entered_ms[s] == UINT64_MAX) {
+            entered_ms[s] = cols.time()[i];
+        }
+    }
+}
+
+/**
+ * @brief runs one threshold set through FLIGHT over every row
+ *
+ * The mock sensors are loaded from the columns and FLIGHT reads them as
+ * it would in flight, so the estimator, the apogee fit and every timer
+ * run unchanged. A set status bit or a missing column makes that read
+ * fail. The BNO is read for the attitude the estimator projects with;
+ * the GPS is not, no detector uses it.
+ */
+static void replay(const Columns &cols, const std::vector<float> &alt, Replay &out) {
+    Adafruit_LSM6DSO32 lsm;
+    Adafruit_ADXL375 adxl;
+    Adafruit_BMP3XX bmp;
+    Adafruit_BNO055 bno;
+    Adafruit_GPS gps;
+    FlightData data;
+    FLIGHT flight(out.t.accel_liftoff, out.t.accel_liftoff_time, out.t.land_time, out.t.land_altitude, "", gps, data);
+
+    const float *la[3] = { cols.f32(COL_lsm_acc_x), cols.f32(COL_lsm_acc_y), cols.f32(COL_lsm_acc_z) };
+    const float *lg[3] = { cols.f32(COL_lsm_gyro_x), cols.f32(COL_lsm_gyro_y), cols.f32(COL_lsm_gyro_z) };
+    const float *aa[3] = { cols.f32(COL_adxl_acc_x), cols.f32(COL_adxl_acc_y), cols.f32(COL_adxl_acc_z) };
+    const float *ba[3] = { cols.f32(COL_bno_acc_x), cols.f32(COL_bno_acc_y), cols.f32(COL_bno_acc_z) };
+    const float *bg[3] = { cols.f32(COL_bno_gyro_x), cols.f32(COL_bno_gyro_y), cols.f32(COL_bno_gyro_z) };
+    const float *bm[3] = { cols.f32(COL_bno_mag_x), cols.f32(COL_bno_mag_y), cols.f32(COL_bno_mag_z) };
+    const float *bq[4] = { cols.f32(COL_bno_quat_w), cols.f32(COL_bno_quat_x), cols.f32(COL_bno_quat_y), cols.f32(COL_bno_quat_z) };
+    const uint8_t *lsm_bad = cols.u8(COL_status_lsm), *adxl_bad = cols.u8(COL_status_adxl);
+    const uint8_t *bno_bad = cols.u8(COL_status_bno);
+    const uint64_t *t = cols.time();
+
+    for(int s = 0; s < 5; s++) out.entered_ms[s] = UINT64_MAX;
+    uint8_t last = 0xFF;
+    for(size_t i = 0; i < cols.rows; i++) {
+        sim::setMicros(t[i] * 1000);
+        lsm.sim.ok = !lsm_bad[i] && !isnan(la[0][i]);
+        adxl.sim.ok = !adxl_bad[i] && !isnan(aa[0][i]);
+        bmp.sim.ok = !isnan(alt[i]);
+        for(int k = 0; k < 3; k++) {
+            lsm.sim.acc[k] = la[k][i];
+            lsm.sim.gyro[k] = lg[k][i];
+            adxl.sim.acc[k] = aa[k][i];
+            bno.sim.acc[k] = ba[k][i];
+            bno.sim.gyro[k] = bg[k][i];
+            bno.sim.mag[k] = bm[k][i];
+        }
+        for(int k = 0; k < 4; k++) {
+            bno.sim.quat[k] = bq[k][i];
+        }
+        bno.sim.ok = !bno_bad[i] && !isnan(ba[0][i]);
+        bmp.sim.alt = alt[i];
+
+        flight.incrementTime();
+        flight.read_LSM(lsm);
+        flight.read_BMP(bmp);
+        flight.read_ADXL(adxl);
+        flight.read_BNO(bno);
+        flight.calculateState();
+
+        uint8_t s = flight.getState();
+        if(s != last) {
+            if(out.entered_ms[s] == UINT64_MAX) out.entered_ms[s] = t[i];
+            last = s;
+        }
+    }
+}
+
+static void printEvent(uint64_t ms, uint64_t logged_ms, uint64_t t0) {
+    if(ms == UINT64_MAX) {
+        printf(" %16s", "-");
+    } else if(logged_ms == UINT64_MAX) {
+        printf(" %16.3f", (ms - t0) / 1000.0);
+    } else {
+        printf(" %8.3f (%+5.0f)", (ms - t0) / 1000.0, (double)(int64_t)(ms - logged_ms));
+    }
+}
+
+static void runReplays(const Columns &cols, const std::vector<float> &alt,
+                       std::vector<Replay> &sets, unsigned threads) {
+    threads = std::max(1u, std::min(threads, (unsigned)sets.size()));
+    std::atomic<size_t> next(0);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned k = 0; k < threads; k++) {
+        pool.emplace_back([&]() {
+            for(size_t i; (i = next++) < sets.size(); ) {
+                replay(cols, alt, sets[i]);
+            }
+        });
+    }
+    for(std::thread &th : pool) th.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t logged[5];
+    findTransitions(cols, logged);
+    if(!cols.present[COL_state]) {
+        for(int s = 0; s < 5; s++) logged[s] = UINT64_MAX;
+    }
+    const uint64_t start = cols.time()[0];
+
+    printf("\ndetection replay: %zu threshold sets x %zu rows on %u thread%s, %.1f M rows/s\n",
+           sets.size(), cols.rows, threads, threads == 1 ? "" : "s", sets.size() * cols.rows / wall / 1e6);
+    printf("  acc m/s^2   ms  land ms  alt m      liftoff s (ms)     apogee s (ms)     landed s (ms)\n");
+    if(cols.present[COL_state]) {
+        printf("  %-30s", "logged");
+        printEvent(logged[FLIGHT_ASCENT], UINT64_MAX, start);
+        printEvent(logged[FLIGHT_DESCENT], UINT64_MAX, start);
+        printEvent(logged[POST_LANDED], UINT64_MAX, start);
+        printf("\n");
+    }
+    for(const Replay &r : sets) {
+        printf("  %9d %4d %8d %6d  ", r.t.accel_liftoff, r.t.accel_liftoff_time, r.t.land_time, r.t.land_altitude);
+        printEvent(r.entered_ms[FLIGHT_ASCENT], logged[FLIGHT_ASCENT], start);
+        printEvent(r.entered_ms[FLIGHT_DESCENT], logged[FLIGHT_DESCENT], start);
+        printEvent(r.entered_ms[POST_LANDED], logged[POST_LANDED], start);
+        printf("\n");
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static std::vector<int> parseList(const char *s) {
+    std::vector<int> v;
+    for(char *end; *s; s = *end ? end + 1 : end) {
+        v.push_back((int)strtol(s, &end, 10));
+        if(end == s) break;
+    }
+    return v;
+}
+
+int main(int argc, char **argv) {
+    bool rebuild = false;
+    const char *col_path = nullptr;
+    unsigned threads = std::thread::hardware_concurrency();
+    SilThresholds defaults;
+    std::vector<int> acc = { defaults.accel_liftoff }, acc_ms = { defaults.accel_liftoff_time };
+    std::vector<int> land_ms = { defaults.land_time }, land_alt = { defaults.land_altitude };
+
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++) {
+        const char *a = argv[arg];
+        bool has = arg + 1 < argc;
+        if(!strcmp(a, "--rebuild")) rebuild = true;
+        else if(!strcmp(a, "--col") && has) col_path = argv[++arg];
+        else if(!strcmp(a, "--threads") && has) threads = strtoul(argv[++arg], nullptr, 10);
+        else if(!strcmp(a, "--liftoff-acc") && has) acc = parseList(argv[++arg]);
+        else if(!strcmp(a, "--liftoff-ms") && has) acc_ms = parseList(argv[++arg]);
+        else if(!strcmp(a, "--land-ms") && has) land_ms = parseList(argv[++arg]);
+        else if(!strcmp(a, "--land-alt") && has) land_alt = parseList(argv[++arg]);
+        else break;
+    }
+    if(arg + 1 != argc || acc.empty() || acc_ms.empty() || land_ms.empty() || land_alt.empty()) {
+        fprintf(stderr, "usage: %s [--rebuild] [--col out.phxcol] [--threads n] [--liftoff-acc list]\n"
+                        "       [--liftoff-ms list] [--land-ms list] [--land-alt list] <log>\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[arg];
+
+    struct stat src;
+    MappedFile log;
+    if(!log.open(path, &src)) {
+        perror(path);
+        return 1;
+    }
+
+    // a .phxcol given directly is used as it is
+    std::string cache = col_path ? col_path : std::string(path) + ".phxcol";
+    MappedFile colFile;
+    Columns cols;
+    const char *mapped = path;
+    bool built = false;
+    if(!mapColumns(log, cols)) {
+        mapped = cache.c_str();
+        bool fresh = !rebuild && colFile.open(mapped) && mapColumns(colFile, cols) &&
+                     cols.hdr->source_size == (uint64_t)src.st_size && cols.hdr->source_mtime_ns == mtimeNs(src);
+        if(!fresh) {
+            auto t0 = std::chrono::steady_clock::now();
+            Rows rows;
+            if(!readLog(log, rows)) {
+                fprintf(stderr, "%s: not a flight log\n", path);
+                return 1;
+            }
+            if(rows.rec.empty()) {
+                fprintf(stderr, "%s: no rows\n", path);
+                return 1;
+            }
+            if(!writeColumns(mapped, rows, src)) {
+                return 1;
+            }
+            colFile.close();
+            cols = Columns();
+            if(!colFile.open(mapped) || !mapColumns(colFile, cols)) {
+                fprintf(stderr, "%s: could not map the columnar file\n", mapped);
+                return 1;
+            }
+            built = true;
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            printf("converted %s (%.1f MB) in %.2f s\n", path, src.st_size / 1e6, s);
+        }
+    }
+
+    static const char *sources[] = { "binary log", "CSV", "legacy two-line CSV" };
+    const ColFileHeader &hdr = *cols.hdr;
+    printf("%s: %s%s, %llu rows over %.3f s", mapped, hdr.source < 3 ? sources[hdr.source] : "?",
+           built ? "" : " (cached)", (unsigned long long)cols.rows,
+           cols.rows ? seconds(cols, cols.rows - 1) : 0.0);
+    if(hdr.imu_records || hdr.events) {
+        printf(", %llu FIFO samples, %llu events", (unsigned long long)hdr.imu_records, (unsigned long long)hdr.events);
+    }
+    printf("\n");
+    if(!cols.rows) {
+        return 0;
+    }
+
+    std::vector<float> alt = baroAltitude(cols);
+    summarizeAcceleration(cols);
+    summarizeAltitude(cols, alt, land_alt[0]);
+    summarizeDropouts(cols);
+    summarizeJitter(cols);
+
+    std::vector<Replay> sets;
+    for(int a : acc) for(int am : acc_ms) for(int lm : land_ms) for(int la : land_alt) {
+        Replay r;
+        r.t = Thresholds{ a, am, lm, la };
+        sets.push_back(r);
+    }
+    runReplays(cols, alt, sets, threads);
+    return 0;
+}
@@ -0,0 +1,289 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_att: checks the gyro attitude propagator (SRAD_PHX_Attitude.h).
+//
+// 1. AttitudePropagator alone at 1 kHz against closed-form rotations:
+//    constant rates about several axes, a fast roll, and coning (a spin
+//    whose axis precesses), which is where per-sample integration errs.
+// 2. The whole FLIGHT on a synthetic flight that pitches over and rolls
+//    after liftoff. The BNO055 quaternion is wrong from ignition until
+//    PHX_ATT_BNO_HOLDOFF_MS after burnout, as its fusion would be; the
+//    published tilt must follow the truth anyway, and the estimator must
+//    see vertical, not axial, acceleration.
+// 3. Cost of one propagate() step against a 1 kHz sample budget.
+//
+//   usage: phx_att [options]
+//     --seconds <n>         length of each closed-form rotation (default 60)
+//     --fifo                only fly the LSM through its FIFO, not once per tick as well
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sil_rig.h"
+
+// double-precision truth
+struct Qd {
+    double w, x, y, z;
+};
+
+static Qd mul(const Qd &a, const Qd &b) {
+    return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+             a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+static Qd axisAngle(double ax, double ay, double az, double angle) {
+    double n = sqrt(ax * ax + ay * ay + az * az);
+    double s = n > 0 ? sin(angle / 2) / n : 0;
+    return { cos(angle / 2), ax * s, ay * s, az * s };
+}
+
+// v rotated by conj(q): a world vector in the body frame when q is body to world
+static void toBody(const Qd &q, const double v[3], double out[3]) {
+    Qd p = { 0, v[0], v[1], v[2] };
+    Qd c = { q.w, -q.x, -q.y, -q.z };
+    Qd r = mul(mul(c, p), q);
+    out[0] = r.x;
+    out[1] = r.y;
+    out[2] = r.z;
+}
+
+// angle of the rotation between q and the truth, degrees; from the
+// vector part of conj(t) q, which keeps its precision near zero
+static double errorDeg(const Quaternion &q, const Qd &t) {
+    Qd e = mul({ t.w, -t.x, -t.y, -t.z }, { q.w, q.x, q.y, q.z });
+    double s = sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+    return 2 * asin(s > 1 ? 1 : s) * 180 / M_PI;
+}
+
+static double tiltDeg(const Qd &q) {
+    double c = 1 - 2 * (q.x * q.x + q.y * q.y);
+    return acos(c > 1 ? 1 : c < -1 ? -1 : c) * 180 / M_PI;
+}
+
+// One closed-form motion: truth(t) and the body rates at t
+struct Motion {
+    const char *name;
+    double wx, wy, wz;                      // constant part of the body rate
+    double precess, cone;                   // coning: precession rate and half-angle
+};
+
+static Qd motionTruth(const Motion &m, double t) {
+    if(m.precess == 0) {
+        return axisAngle(m.wx, m.wy, m.wz, sqrt(m.wx * m.wx + m.wy * m.wy + m.wz * m.wz) * t);
+    }
+    // axis precesses about world z at `precess`, body spins about its z at wz
+    return mul(mul(axisAngle(0, 0, 1, m.precess * t), axisAngle(1, 0, 0, m.cone)), axisAngle(0, 0, 1, m.wz * t));
+}
+
+static void motionRates(const Motion &m, double t, float w[3]) {
+    if(m.precess == 0) {
+        w[0] = m.wx;
+        w[1] = m.wy;
+        w[2] = m.wz;
+        return;
+    }
+    // precession about world z seen in the body, plus the spin
+    Qd inner = mul(axisAngle(1, 0, 0, m.cone), axisAngle(0, 0, 1, m.wz * t));
+    const double z[3] = { 0, 0, m.precess };
+    double b[3];
+    toBody(inner, z, b);
+    w[0] = b[0];
+    w[1] = b[1];
+    w[2] = b[2] + m.wz;
+}
+
+static bool checkMotions(double seconds) {
+    const Motion motions[] = {
+        { "pitch 0.5 rad/s", 0.5, 0, 0, 0, 0 },
+        { "yaw 1.0 rad/s",   0, 0, 1.0, 0, 0 },
+        { "oblique",         0.3, -0.7, 1.2, 0, 0 },
+        { "roll 20 rad/s",   0, 0, 20, 0, 0 },
+        { "coning 10 deg",   0, 0, 2.0, 3.0, 10 * M_PI / 180 },
+    };
+    const double dt = 0.001;
+    const double limit = 0.5;               // degrees after `seconds`
+    bool ok = true;
+
+    printf("propagator at 1 kHz for %.0f s (midpoint rates)\n", seconds);
+    for(const Motion &m : motions) {
+        AttitudePropagator att;
+        Qd t0 = motionTruth(m, 0);
+        Quaternion q0;
+        q0.w = t0.w;
+        q0.x = t0.x;
+        q0.y = t0.y;
+        q0.z = t0.z;
+        att.anchor(q0, 1.0f);
+
+        double worst = 0;
+        const long steps = lround(seconds / dt);
+        for(long i = 0; i < steps; i++) {
+            float w[3];
+            motionRates(m, (i + 0.5) * dt, w);
+            att.propagate(w, dt);
+            double e = errorDeg(att.orientation(), motionTruth(m, (i + 1) * dt));
+            worst = e > worst ? e : worst;
+        }
+        const Quaternion &q = att.orientation();
+        double norm = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+        bool pass = worst < limit && fabs(norm - 1) < 1e-5;
+        printf("  %-16s worst %.4f deg, |q| - 1 = %+.1e  %s\n", m.name, worst, norm - 1, pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+    return ok;
+}
+
+// pitch-over after liftoff: tilt ramps at `pitch_rate` to `max_tilt` about
+// world x while the airframe rolls about its own axis
+struct Manoeuvre {
+    double start_s, pitch_rate, max_tilt, roll_rate;
+};
+
+static Qd manoeuvreTruth(const Manoeuvre &m, double t) {
+    double dt = t > m.start_s ? t - m.start_s : 0;
+    double tilt = fmin(dt * m.pitch_rate, m.max_tilt);
+    return mul(axisAngle(1, 0, 0, tilt), axisAngle(0, 0, 1, dt * m.roll_rate));
+}
+
+static void manoeuvreRates(const Manoeuvre &m, double t, double w[3]) {
+    double dt = t > m.start_s ? t - m.start_s : 0;
+    double pitch = t > m.start_s && dt * m.pitch_rate < m.max_tilt ? m.pitch_rate : 0;
+    double roll = t > m.start_s ? m.roll_rate : 0;
+    double phi = dt * m.roll_rate;
+    w[0] = pitch * cos(phi);
+    w[1] = -pitch * sin(phi);
+    w[2] = roll;
+}
+
+static void rotateToBody(const Qd &q, float v[3]) {
+    const double world[3] = { v[0], v[1], v[2] };
+    double b[3];
+    toBody(q, world, b);
+    v[0] = b[0];
+    v[1] = b[1];
+    v[2] = b[2];
+}
+
+static bool checkFlight(bool fifo) {
+    FlightProfile p;
+    p.sample_hz = 100;
+    TruthEvents truth;
+    std::vector<TraceSample> trace = makeSyntheticFlight(p, &truth);
+
+    // the synthetic flight is vertical: rotate its sensors into a pitching, rolling body
+    const Manoeuvre m = { p.pad_s + 0.5, 6 * M_PI / 180, 30 * M_PI / 180, 1.0 };
+    const double burnout_s = p.pad_s + p.burn_s;
+    const Qd bad = axisAngle(0, 1, 0, 25 * M_PI / 180);
+    for(TraceSample &s : trace) {
+        double t = s.time_us * 1e-6;
+        Qd q = manoeuvreTruth(m, t);
+        rotateToBody(q, s.lsm_acc);
+        rotateToBody(q, s.adxl_acc);
+        rotateToBody(q, s.bno_acc);
+        double w[3];
+        manoeuvreRates(m, t, w);
+        for(int i = 0; i < 3; i++) {
+            s.lsm_gyro[i] += w[i];
+            s.bno_gyro[i] += w[i];
+        }
+        // fusion thrown off once the boost is under way, until it settles a while after
+        Qd b = t >= p.pad_s + 0.05 && t < burnout_s + 1.0 ? mul(q, bad) : q;
+        s.bno_quat[0] = b.w;
+        s.bno_quat[1] = b.x;
+        s.bno_quat[2] = b.y;
+        s.bno_quat[3] = b.z;
+    }
+
+    sim::setMicros(0);                      // each flight starts its own clock
+    SilRig rig;
+    if(fifo && !rig.beginFifo()) {
+        printf("FIFO mocks failed to start\n");
+        return false;
+    }
+    double worst_tilt = 0, sum_tilt2 = 0, worst_alt = 0, sum_alt2 = 0, bno_worst = 0;
+    long n = 0;
+    for(const TraceSample &s : trace) {
+        rig.apply(s);
+        rig.step();
+        double t = s.time_us * 1e-6;
+        if(t < p.pad_s || !(s.true_alt > 0)) {
+            continue;                       // score the flight, from ignition to touchdown
+        }
+        Qd q = manoeuvreTruth(m, t);
+        double e = fabs(rig.data.att_tilt - tiltDeg(q));
+        worst_tilt = e > worst_tilt ? e : worst_tilt;
+        sum_tilt2 += e * e;
+        double bno = fabs(errorDeg(rig.data.bno_orientation, q));
+        bno_worst = bno > bno_worst ? bno : bno_worst;
+        double a = fabs(rig.data.est_alt - s.true_alt);
+        worst_alt = a > worst_alt ? a : worst_alt;
+        sum_alt2 += a * a;
+        n++;
+    }
+
+    const double tilt_limit = 1.0, alt_limit = 10.0;    // degrees, metres
+    bool pass = worst_tilt < tilt_limit && worst_alt < alt_limit && rig.flight.getState() == POST_LANDED;
+    printf("flight, %s, pitch to %.0f deg at %.0f deg/s, roll %.1f rad/s\n", fifo ? "FIFO" : "per tick",
+           m.max_tilt * 180 / M_PI, m.pitch_rate * 180 / M_PI, m.roll_rate);
+    printf("  BNO quaternion   worst %.1f deg off (corrupted under boost)\n", bno_worst);
+    printf("  published tilt   rms %.3f deg, worst %.3f deg\n", sqrt(sum_tilt2 / n), worst_tilt);
+    printf("  est. altitude    rms %.2f m, worst %.2f m  %s\n", sqrt(sum_alt2 / n), worst_alt, pass ? "ok" : "FAIL");
+    return pass;
+}
+
+static void timePropagate() {
+    AttitudePropagator att;
+    Quaternion q0;
+    q0.w = 1;
+    q0.x = q0.y = q0.z = 0;
+    att.anchor(q0, 1.0f);
+    float w[3] = { 0.3f, -0.2f, 4.0f };
+    const long steps = 20000000;
+    auto t0 = std::chrono::steady_clock::now();
+    for(long i = 0; i < steps; i++) {
+        w[0] = -w[0];                       // keep the compiler from folding the loop
+        att.propagate(w, 0.001f);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / steps;
+    volatile float sink = att.orientation().w;
+    (void)sink;
+    printf("propagate          %.1f ns per sample, %.4f%% of a 1 kHz budget on this host\n", ns, ns / 1e4);
+}
+
+int main(int argc, char **argv) {
+    double seconds = 60;
+    bool fifo_only = false;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if(!strcmp(argv[i], "--fifo")) {
+            fifo_only = true;
+        } else {
+            fprintf(stderr, "usage: phx_att [--seconds n] [--fifo]\n");
+            return 2;
+        }
+    }
+
+    bool ok = checkMotions(seconds);
+    if(!fifo_only) {
+        ok &= checkFlight(false);
+    }
+    ok &= checkFlight(true);
+    timePropagate();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_cal: checks the calibration kernels (SRAD_PHX_Calibration.h).
+//
+// 1. calApplySimd and calApplyScalar on random tables and vectors, with
+//    NaN, infinities, denormals and signed zeros mixed in, at every count
+//    from 0 to 70 and at the strides FLIGHT uses (3, and ImuSample's 7).
+//    The results must match bit for bit (any NaN matching any NaN), and
+//    the floats between the vectors (ImuSample time and the other
+//    vector) must be untouched.
+// 2. CalEstimator on a synthetic pad: a tilted ADXL and BNO and biased
+//    gyros must come out aligned with the LSM and with no bias.
+// 3. A SIL flight launched before calibration can finish: FLIGHT must
+//    go from PRE_NO_CAL straight to FLIGHT_ASCENT, on time.
+// 4. Cost per vector of both kernels on a full SampleBatch.
+//
+//   usage: phx_cal [--seed n] [--rounds n]
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "SRAD_PHX.h"
+#include "sil_rig.h"
+
+static float special(std::mt19937 &rng, std::uniform_real_distribution<float> &u) {
+    switch(rng() % 16) {
+        case 0: return NAN;
+        case 1: return INFINITY;
+        case 2: return -INFINITY;
+        case 3: return 1e-40f;              // denormal
+        case 4: return -0.0f;
+        case 5: return 3e38f;               // overflows once scaled
+        default: return u(rng) * 400.0f;
+    }
+}
+
+static void randomTable(CalTable &cal, std::mt19937 &rng, bool extremes) {
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    for(int c = 0; c < CAL_CHANNELS; c++) {
+        for(int k = 0; k < 9; k++) {
+            cal.m[k][c] = extremes && rng() % 8 == 0 ? special(rng, u) : u(rng) * 2.0f;
+        }
+        for(int a = 0; a < 3; a++) {
+            cal.offset[a][c] = u(rng) * 20.0f;
+        }
+    }
+}
+
+// bit for bit, except that any NaN matches any NaN: which operand's
+// payload and sign a NaN result carries is up to the instruction
+static bool sameBits(float a, float b) {
+    return (isnan(a) && isnan(b)) || memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static bool kernelsAgree(uint32_t seed, uint32_t rounds) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    uint64_t vectors = 0, failures = 0;
+
+    for(uint32_t round = 0; round < rounds; round++) {
+        CalTable cal;
+        randomTable(cal, rng, round % 4 == 3);
+        uint8_t channel = rng() % CAL_CHANNELS;
+
+        for(uint16_t n = 0; n <= 70; n++) {
+            // stride 3: packed vectors, stride 7: acc or gyro inside ImuSample
+            for(uint16_t stride : { (uint16_t)3, (uint16_t)(sizeof(ImuSample) / sizeof(float)) }) {
+                uint16_t first = stride == 3 ? 0 : 1 + 3 * (rng() % 2);
+                std::vector<float> a(first + (size_t)stride * n + 3);
+                for(float &f : a) {
+                    f = special(rng, u);
+                }
+                std::vector<float> b = a, before = a;
+                calApplySimd(cal, channel, a.data() + first, stride, n);
+                calApplyScalar(cal, channel, b.data() + first, stride, n);
+                vectors += n;
+
+                bool same = true, untouched = true;
+                for(size_t i = 0; i < a.size(); i++) {
+                    if(!sameBits(a[i], b[i])) {
+                        same = false;
+                    }
+                    bool in_vector = i >= first && i < first + (size_t)stride * n && (i - first) % stride < 3;
+                    if(!in_vector && !sameBits(a[i], before[i])) {
+                        untouched = false;
+                    }
+                }
+                if(!same || !untouched) {
+                    if(failures++ < 5) {
+                        fprintf(stderr, "round %u channel %u n %u stride %u: %s\n", round, channel, n, stride,
+                                !same ? "SIMD and scalar differ" : "wrote outside the vectors");
+                    }
+                }
+            }
+        }
+    }
+    printf("kernels      %llu vectors in %u rounds, SIMD %s: %s\n", (unsigned long long)vectors, rounds,
+           PHX_CAL_SIMD ? "in use" : "off (scalar build)", failures ? "MISMATCH" : "identical");
+    return failures == 0;
+}
+
+// rotation of `deg` about a unit axis, row-major
+static void rotation(const float axis[3], float deg, float r[9]) {
+    float t = deg * (float)M_PI / 180.0f, c = cosf(t), s = sinf(t), k = 1 - c;
+    float x = axis[0], y = axis[1], z = axis[2];
+    float m[9] = { c + x * x * k, x * y * k - z * s, x * z * k + y * s,
+                   y * x * k + z * s, c + y * y * k, y * z * k - x * s,
+                   z * x * k - y * s, z * y * k + x * s, c + z * z * k };
+    memcpy(r, m, sizeof(m));
+}
+
+static void rotate(const float r[9], const float v[3], float out[3]) {
+    for(int i = 0; i < 3; i++) {
+        out[i] = r[3 * i] * v[0] + r[3 * i + 1] * v[1] + r[3 * i + 2] * v[2];
+    }
+}
+
+static float angleDeg(const float a[3], const float b[3]) {
+    float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    float la = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]), lb = sqrtf(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    float c = dot / (la * lb);
+    return acosf(c > 1 ? 1 : c < -1 ? -1 : c) * 180.0f / (float)M_PI;
+}
+
+/**
+ * The rail holds the rocket 4 degrees off vertical. The ADXL is mounted
+ * 3 degrees off the LSM's axes and reads 0.3 m/s^2 high, the BNO 6
+ * degrees off; both gyros have a bias. After solving, gravity and a
+ * thrust along the rocket axis must read the same on every sensor.
+ */
+static bool padEstimate(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    const float rail_axis[3] = { 0, 1, 0 }, adxl_axis[3] = { 0.6f, 0.8f, 0 }, bno_axis[3] = { 1, 0, 0 };
+    float rail[9], adxl_mount[9], bno_mount[9];
+    rotation(rail_axis, 4, rail);
+    rotation(adxl_axis, 3, adxl_mount);
+    rotation(bno_axis, 6, bno_mount);
+
+    const float up_world[3] = { 0, 0, PHX_GRAVITY };
+    float g_rocket[3], g_adxl[3], g_bno[3];
+    rotate(rail, up_world, g_rocket);
+    rotate(adxl_mount, g_rocket, g_adxl);
+    rotate(bno_mount, g_rocket, g_bno);
+    const float lsm_bias[3] = { 0.02f, -0.01f, 0.015f }, bno_bias[3] = { -0.004f, 0.003f, 0.002f };
+
+    CalEstimator est;
+    for(int i = 0; i < PHX_CAL_SAMPLES; i++) {
+        est.add(CAL_LSM_ACC, g_rocket[0] + 0.05f * noise(rng), g_rocket[1] + 0.05f * noise(rng), g_rocket[2] + 0.05f * noise(rng));
+        est.add(CAL_LSM_GYRO, lsm_bias[0] + 0.002f * noise(rng), lsm_bias[1] + 0.002f * noise(rng), lsm_bias[2] + 0.002f * noise(rng));
+        est.add(CAL_ADXL_ACC, g_adxl[0] + 0.3f * noise(rng), g_adxl[1] + 0.3f * noise(rng), g_adxl[2] + 0.3f + 0.3f * noise(rng));
+        est.add(CAL_BNO_ACC, g_bno[0] + 0.1f * noise(rng), g_bno[1] + 0.1f * noise(rng), g_bno[2] + 0.1f * noise(rng));
+        // the BNO gyro bias is in the BNO's own frame
+        est.add(CAL_BNO_GYRO, bno_bias[0] + 0.002f * noise(rng), bno_bias[1] + 0.002f * noise(rng), bno_bias[2] + 0.002f * noise(rng));
+        est.tick();
+    }
+    CalTable cal;
+    est.solve(cal);
+
+    // 50 m/s^2 of thrust along the rocket's z axis, on top of gravity
+    const float thrust_rocket[3] = { 0, 0, 50 };
+    float f_rocket[3] = { g_rocket[0] + thrust_rocket[0], g_rocket[1] + thrust_rocket[1], g_rocket[2] + thrust_rocket[2] };
+    float f_adxl[3], f_bno[3];
+    rotate(adxl_mount, f_rocket, f_adxl);
+    rotate(bno_mount, f_rocket, f_bno);
+    f_adxl[2] += 0.3f;
+
+    float lsm[3] = { f_rocket[0], f_rocket[1], f_rocket[2] };
+    calApply(cal, CAL_LSM_ACC, lsm, 3, 1);
+    calApply(cal, CAL_ADXL_ACC, f_adxl, 3, 1);
+    calApply(cal, CAL_BNO_ACC, f_bno, 3, 1);
+    float lsm_w[3] = { lsm_bias[0], lsm_bias[1], lsm_bias[2] }, bno_w[3] = { bno_bias[0], bno_bias[1], bno_bias[2] };
+    calApply(cal, CAL_LSM_GYRO, lsm_w, 3, 1);
+    calApply(cal, CAL_BNO_GYRO, bno_w, 3, 1);
+
+    float adxl_err = angleDeg(f_adxl, lsm), bno_err = angleDeg(f_bno, lsm);
+    float adxl_raw_err = angleDeg(g_adxl, g_rocket), bno_raw_err = angleDeg(g_bno, g_rocket);
+    float gyro_err = fmaxf(sqrtf(lsm_w[0] * lsm_w[0] + lsm_w[1] * lsm_w[1] + lsm_w[2] * lsm_w[2]),
+                           sqrtf(bno_w[0] * bno_w[0] + bno_w[1] * bno_w[1] + bno_w[2] * bno_w[2]));
+    // rotation about the gravity vector is not observable, so the thrust
+    // check is against the tilt part only: half a degree of slack
+    bool ok = adxl_err < 0.5f && bno_err < 0.5f && gyro_err < 0.001f;
+    printf("pad estimate ADXL %.2f -> %.2f deg, BNO %.2f -> %.2f deg from the LSM under thrust, gyro bias left %.5f rad/s: %s\n",
+           adxl_raw_err, adxl_err, bno_raw_err, bno_err, gyro_err, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/**
+ * @brief a launch half way through the pad average must not be missed
+ *
+ * The pad lasts half of PHX_CAL_SAMPLES ticks, and a knock before it
+ * restarts the average, so calibration is still running at ignition.
+ */
+static bool earlyLaunch(uint32_t seed) {
+    FlightProfile p;
+    p.seed = seed;
+    p.pad_s = PHX_CAL_SAMPLES / 2 / p.sample_hz;
+    p.knock_t = p.pad_s / 2;
+    p.knock_acc = 20;
+    TruthEvents truth;
+    std::vector<TraceSample> trace = makeSyntheticFlight(p, &truth);
+
+    sim::setMicros(trace.front().time_us);
+    SilRig rig;
+    double ascent_ms = NAN, descent_ms = NAN;
+    bool pre_cal = false;
+    for(const TraceSample &s : trace) {
+        rig.apply(s);
+        rig.step();
+        const uint8_t state = rig.flight.getState();
+        pre_cal |= state == PRE_CAL && isnan(ascent_ms);
+        if(state >= FLIGHT_ASCENT && isnan(ascent_ms)) {
+            ascent_ms = s.time_us / 1000.0;
+        }
+        if(state >= FLIGHT_DESCENT && isnan(descent_ms)) {
+            descent_ms = s.time_us / 1000.0;
+        }
+    }
+    const double liftoff_late = ascent_ms - truth.liftoff_ms, apogee_late = descent_ms - truth.apogee_ms;
+    // the detector's own hold time plus a couple of ticks
+    bool ok = !pre_cal && liftoff_late >= 0 && liftoff_late < 100 + 50 && apogee_late >= 0 && apogee_late < 1000;
+    printf("early launch liftoff at %.1f s, FLIGHT_ASCENT %.0f ms later, FLIGHT_DESCENT %.0f ms after apogee, %s: %s\n",
+           truth.liftoff_ms / 1000, liftoff_late, apogee_late, pre_cal ? "through PRE_CAL" : "uncalibrated", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+template <class Kernel>
+static double nsPerVector(Kernel kernel, const CalTable &cal, SampleBatch &batch) {
+    const int reps = 20000;
+    const uint16_t stride = sizeof(ImuSample) / sizeof(float);
+    auto t0 = std::chrono::steady_clock::now();
+    for(int r = 0; r < reps; r++) {
+        kernel(cal, CAL_LSM_ACC, batch.sample[0].acc, stride, batch.count);
+        kernel(cal, CAL_LSM_GYRO, batch.sample[0].gyro, stride, batch.count);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    return ns / (reps * 2.0 * batch.count);
+}
+
+int main(int argc, char **argv) {
+    uint32_t seed = 1, rounds = 400;
+    for(int i = 1; i < argc; i++) {
+        bool has = i + 1 < argc;
+        if(!strcmp(argv[i], "--seed") && has) seed = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--rounds") && has) rounds = strtoul(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "usage: %s [--seed n] [--rounds n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = kernelsAgree(seed, rounds);
+    ok &= padEstimate(seed);
+    ok &= earlyLaunch(seed);
+
+    // near-identity table, as after a real pad calibration, so timings see no denormals
+    CalTable cal;
+    cal.setIdentity();
+    for(int c = 0; c < CAL_CHANNELS; c++) {
+        cal.m[1][c] = 0.01f;
+        cal.offset[2][c] = 0.1f;
+    }
+    SampleBatch batch;
+    batch.count = PHX_SAMPLE_BATCH_MAX;
+    for(uint16_t i = 0; i < batch.count; i++) {
+        for(int a = 0; a < 3; a++) {
+            batch.sample[i].acc[a] = 9.8f + i * 0.001f;
+            batch.sample[i].gyro[a] = 0.01f * a;
+        }
+    }
+    double simd = nsPerVector(calApplySimd, cal, batch);
+    double scalar = nsPerVector(calApplyScalar, cal, batch);
+    printf("cost         %.2f ns/vector SIMD, %.2f ns/vector scalar, batches of %u\n", simd, scalar, batch.count);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_decode: converts a binary log written by FLIGHT::writeSDBinary
+// back into the CSV layout produced by FLIGHT::writeSD.
+//
+//   usage: phx_decode [-s] [-i imu.csv] <log.bin> [out.csv]
+//     -s   print the schema stored in the file header and exit
+//     -i   also write the FIFO samples (LogImuRecord) to imu.csv
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "SRAD_PHX_Format.h"
+#include "SRAD_PHX_Log.h"
+
+static void printSchema(const LogFileHeader &hdr, const std::vector<LogFieldDesc> &fields) {
+    static const char *types[] = { "u8", "u16", "u64", "f32", "u32" };
+    printf("version %u, record %u bytes, %u fields\n", hdr.version, hdr.record_size, hdr.field_count);
+    for(const LogFieldDesc &f : fields) {
+        char name[sizeof(f.name) + 1] = {};
+        memcpy(name, f.name, sizeof(f.name));
+        printf("  %4u  %-4s  %u  %s\n", f.offset, f.type < 5 ? types[f.type] : "?", f.precision, name);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool schemaOnly = false;
+    const char *imuPath = nullptr;
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++) {
+        if(strcmp(argv[arg], "-s") == 0) {
+            schemaOnly = true;
+        } else if(strcmp(argv[arg], "-i") == 0 && arg + 1 < argc) {
+            imuPath = argv[++arg];
+        } else {
+            break;
+        }
+    }
+    if(arg >= argc) {
+        fprintf(stderr, "usage: %s [-s] [-i imu.csv] <log.bin> [out.csv]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(argv[arg], "rb");
+    if(!in) {
+        perror(argv[arg]);
+        return 1;
+    }
+    FILE *out = stdout;
+    if(arg + 1 < argc && !(out = fopen(argv[arg + 1], "w"))) {
+        perror(argv[arg + 1]);
+        return 1;
+    }
+
+    LogFileHeader hdr;
+    if(fread(&hdr, sizeof(hdr), 1, in) != 1 || memcmp(hdr.magic, PHX_LOG_MAGIC, PHX_LOG_MAGIC_LEN) != 0) {
+        fprintf(stderr, "%s: not a PHX binary log\n", argv[arg]);
+        return 1;
+    }
+    if(hdr.version < 2 || hdr.version > PHX_LOG_VERSION || hdr.record_size != sizeof(LogRecord) || !hdr.little_endian) {
+        fprintf(stderr, "%s: unsupported log version %u (record %u bytes), expected %u (%u bytes)\n",
+                argv[arg], hdr.version, hdr.record_size, PHX_LOG_VERSION, (unsigned)sizeof(LogRecord));
+        return 1;
+    }
+
+    std::vector<LogFieldDesc> fields(hdr.field_count);
+    std::vector<char> text(hdr.text_len);
+    if(fread(fields.data(), sizeof(LogFieldDesc), fields.size(), in) != fields.size() ||
+       fread(text.data(), 1, text.size(), in) != text.size()) {
+        fprintf(stderr, "%s: truncated header\n", argv[arg]);
+        return 1;
+    }
+    if(schemaOnly) {
+        printSchema(hdr, fields);
+        return 0;
+    }
+    fseek(in, hdr.header_size, SEEK_SET);
+
+    FILE *imu = nullptr;
+    if(imuPath) {
+        if(!(imu = fopen(imuPath, "w"))) {
+            perror(imuPath);
+            return 1;
+        }
+        fprintf(imu, "source,time_us,acc_x,acc_y,acc_z,gyro_x,gyro_y,gyro_z\n");
+    }
+
+    // rows go through the same LineBuffer formatting as FLIGHT::writeSD
+    LineBuffer<PHX_CSV_LINE_MAX> line;
+    if(!text.empty()) {
+        fputc('#', out);
+        fwrite(text.data(), 1, text.size(), out);
+        line.println();
+    }
+    printCsvHeader(line);
+    fwrite(line.data(), 1, line.length(), out);
+
+    // records are read in bulk; on a bad sync word skip one byte at a time
+    // until the stream lines up again (e.g. after a torn write)
+    std::vector<uint8_t> buf(sizeof(LogRecord) * 4096);
+    size_t have = 0, pos = 0;
+    bool eof = false;
+    unsigned long rows = 0, imu_rows = 0, events = 0, skipped = 0;
+    for(;;) {
+        size_t left = have - pos;
+        if(!eof && left < sizeof(LogRecord)) {
+            memmove(buf.data(), buf.data() + pos, left);
+            have = left;
+            pos = 0;
+            size_t n = fread(buf.data() + have, 1, buf.size() - have, in);
+            eof = n == 0;
+            have += n;
+            continue;
+        }
+        if(left < sizeof(LogEventRecord)) {
+            break;
+        }
+        uint16_t sync;
+        memcpy(&sync, buf.data() + pos, sizeof(sync));
+        if(sync == PHX_LOG_SYNC_EVENT) {
+            LogEventRecord e;
+            memcpy(&e, buf.data() + pos, sizeof(e));
+            line.clear();
+            printLogEvent(line, e);
+            fwrite(line.data(), 1, line.length(), out);
+            pos += sizeof(e);
+            events++;
+            continue;
+        }
+        if(sync == PHX_LOG_SYNC_IMU && left >= sizeof(LogImuRecord)) {
+            LogImuRecord s;
+            memcpy(&s, buf.data() + pos, sizeof(s));
+            if(imu) {
+                fprintf(imu, "%s,%u,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f\n", s.source == LOG_IMU_LSM ? "lsm" : "adxl",
+                        s.time_us, s.acc[0], s.acc[1], s.acc[2], s.gyro[0], s.gyro[1], s.gyro[2]);
+            }
+            pos += sizeof(s);
+            imu_rows++;
+            continue;
+        }
+        if(sync != PHX_LOG_SYNC || left < sizeof(LogRecord)) {
+            pos++;
+            skipped++;
+            continue;
+        }
+        LogRecord rec;
+        memcpy(&rec, buf.data() + pos, sizeof(rec));
+        line.clear();
+        printCsvRow(line, rec.data);
+        fwrite(line.data(), 1, line.length(), out);
+        pos += sizeof(rec);
+        rows++;
+    }
+
+    if(have - pos != 0) {
+        skipped += have - pos;
+    }
+    if(imu) {
+        fclose(imu);
+    }
+    fprintf(stderr, "%lu rows decoded, %lu FIFO samples, %lu events, %lu bytes skipped\n", rows, imu_rows, events, skipped);
+    return 0;
+}
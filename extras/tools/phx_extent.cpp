@@ -0,0 +1,318 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_extent: the raw-sector extent log (SRAD_PHX_Extent.h) on a card
+// image in a host file.
+//
+// 1. A whole synthetic flight logs writeSDBinary through a SectorLogger
+//    into the extent, and the log is read back out of the image. The
+//    sector writes per service() and the longest service() show the
+//    latency bound, with each sector write charged --write-us.
+// 2. Power cuts: the same flight again, with the card dying in the middle
+//    of a random sector write, data or superblock, leaving that sector
+//    torn. Before each one the superblocks are wiped and a new nonce is
+//    used, so the previous trial's blocks are still in the image as stale
+//    data. Recovery must end the log exactly after the last whole block,
+//    and its contents must be a prefix of the clean log. The board then
+//    reboots onto the image and appends a second session, which must not
+//    disturb the first.
+// 3. --extract reads the logs out of an image, such as a dd of the card.
+//
+//   usage: phx_extent [options]
+//     --image <f.img>       card image (default build/extent.img)
+//     --sectors <n>         extent length (default 16384, 8 MB)
+//     --write-us <n>        simulated time per sector write (default 300)
+//     --cuts <n>            power-cut trials (default 20)
+//     --seed <n>            cut points and nonces
+//     --csv <out.csv>       writeSD output of the clean flight
+//     --bin <out.bin>       the clean flight's log, as read back out of the extent
+//     --extract <out>       only recover the image and write each session's log
+//                           to <out>, <out>.1, ...
+//     --first-lba <n>       where the extent starts in the image (default 0)
+
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "sil_blockdev.h"
+#include "sil_rig.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+struct Geometry {
+    uint32_t first_lba = 0;
+    uint32_t sectors = 16384;
+};
+
+/**
+ * @brief reads blocks [0, rec.end) and splits their payloads by session
+ * @return false if a block inside the recovered log does not verify
+ */
+static bool extract(BlockDevice &dev, const Geometry &g, const ExtentRecovery &rec, std::vector<Bytes> &sessions) {
+    uint8_t sector[PHX_EXTENT_SECTOR];
+    ExtentBlockHeader hdr;
+    uint32_t session = 0;
+    sessions.clear();
+    for(uint32_t i = 0; i < rec.end; i++) {
+        if(!dev.readSector(g.first_lba + PHX_EXTENT_SUPERS + i, sector) || !extentBlockValid(sector, i, hdr)) {
+            return false;
+        }
+        if(sessions.empty() || hdr.session != session) {
+            sessions.emplace_back();
+            session = hdr.session;
+        }
+        sessions.back().insert(sessions.back().end(), sector + sizeof(hdr), sector + sizeof(hdr) + hdr.used);
+    }
+    return true;
+}
+
+struct FlightRun {
+    uint32_t blocks = 0;                    // journal.next() when it ended
+    uint32_t device_writes = 0;
+    uint32_t worst_writes = 0;              // most sector writes in one step()
+    uint32_t worst_writes_rt = 0;           // the same, while realtime
+    uint32_t worst_service_us = 0;
+    uint32_t super_writes = 0;
+    uint32_t write_errors = 0;
+    uint32_t overruns = 0;
+    bool cut = false;                       // the device lost power before the end
+};
+
+/**
+ * @brief flies the trace, logging through an extent on `dev`, until the end or a power cut
+ */
+static FlightRun fly(const std::vector<TraceSample> &trace, SilBlockDevice &dev, const Geometry &g,
+                     uint32_t nonce, const char *csvPath) {
+    FlightRun run;
+    ExtentJournal journal;
+    SectorLogger logger;
+    SilRig rig;
+    sim::setMicros(trace.front().time_us);
+
+    if(!journal.begin(dev, g.first_lba, g.sectors, nonce)) {
+        run.cut = true;
+        return run;
+    }
+    File csvFile;
+    if(csvPath) {
+        csvFile = SD.open(csvPath, FILE_WRITE);
+        rig.flight.writeSD(true, csvFile);
+        rig.sd = &csvFile;
+    }
+    logger.begin(journal);
+    rig.flight.writeSDBinary(true, logger);
+    rig.flight.attachLogger(logger);
+    rig.sdBinary = &logger;
+    rig.logger = &logger;
+
+    for(const TraceSample &s : trace) {
+        rig.apply(s);
+        const uint32_t before = dev.writes;
+        rig.step();
+        const uint32_t n = dev.writes - before;
+        const bool realtime = rig.flight.getState() == STATES::FLIGHT_ASCENT;   // what service() ran under
+        if(n > run.worst_writes) run.worst_writes = n;
+        if(realtime && n > run.worst_writes_rt) run.worst_writes_rt = n;
+        if(!dev.powered()) {
+            run.cut = true;
+            break;
+        }
+    }
+    if(!run.cut) {
+        logger.close();
+    }
+    if(csvPath) {
+        csvFile.close();
+    }
+    run.blocks = journal.next();
+    run.device_writes = dev.writes;
+    run.worst_service_us = logger.stats().max_service_us;
+    run.super_writes = journal.stats().super_writes;
+    run.write_errors = journal.stats().write_errors;
+    run.overruns = logger.stats().overruns;
+    return run;
+}
+
+static bool writeFile(const char *path, const Bytes &b) {
+    FILE *f = fopen(path, "wb");
+    if(!f) {
+        return false;
+    }
+    bool ok = fwrite(b.data(), 1, b.size(), f) == b.size();
+    return fclose(f) == 0 && ok;
+}
+
+static int extractOnly(const char *image, const Geometry &g, const char *out) {
+    SilBlockDevice dev;
+    if(!dev.open(image, g.first_lba + g.sectors)) {
+        perror(image);
+        return 1;
+    }
+    ExtentRecovery rec;
+    uint8_t scratch[PHX_EXTENT_SECTOR];
+    if(!recoverExtent(dev, g.first_lba, g.sectors, rec, scratch)) {
+        fprintf(stderr, "%s: no valid superblock at sector %u for a %u-sector extent\n", image, g.first_lba, g.sectors);
+        return 1;
+    }
+    std::vector<Bytes> sessions;
+    if(!extract(dev, g, rec, sessions)) {
+        fprintf(stderr, "%s: a block before the recovered end does not verify\n", image);
+        return 1;
+    }
+    printf("%u blocks, %u past the superblock (generation %u), %zu sessions\n",
+           rec.end, rec.end - rec.super_next, rec.generation, sessions.size());
+    for(size_t i = 0; i < sessions.size(); i++) {
+        char path[512];
+        if(i == 0) snprintf(path, sizeof(path), "%s", out);
+        else snprintf(path, sizeof(path), "%s.%zu", out, i);
+        if(!writeFile(path, sessions[i])) {
+            perror(path);
+            return 1;
+        }
+        printf("%-24s %zu bytes\n", path, sessions[i].size());
+    }
+    return 0;
+}
+
+// a new preallocation over the same clusters: the old blocks stay, the superblocks do not
+static void wipeSupers(SilBlockDevice &dev, const Geometry &g) {
+    uint8_t zero[PHX_EXTENT_SECTOR] = {};
+    for(uint32_t i = 0; i < PHX_EXTENT_SUPERS; i++) {
+        dev.writeSector(g.first_lba + i, zero);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *image = "build/extent.img";
+    const char *csvPath = nullptr, *binPath = nullptr, *extractPath = nullptr;
+    Geometry g;
+    uint32_t write_us = 300;
+    int cuts = 20;
+    unsigned seed = 1;
+    for(int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool more = i + 1 < argc;
+        if(!strcmp(a, "--image") && more) image = argv[++i];
+        else if(!strcmp(a, "--sectors") && more) g.sectors = strtoul(argv[++i], nullptr, 0);
+        else if(!strcmp(a, "--first-lba") && more) g.first_lba = strtoul(argv[++i], nullptr, 0);
+        else if(!strcmp(a, "--write-us") && more) write_us = strtoul(argv[++i], nullptr, 0);
+        else if(!strcmp(a, "--cuts") && more) cuts = atoi(argv[++i]);
+        else if(!strcmp(a, "--seed") && more) seed = strtoul(argv[++i], nullptr, 0);
+        else if(!strcmp(a, "--csv") && more) csvPath = argv[++i];
+        else if(!strcmp(a, "--bin") && more) binPath = argv[++i];
+        else if(!strcmp(a, "--extract") && more) extractPath = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--image f.img] [--sectors n] [--write-us n] [--cuts n] [--seed n] "
+                            "[--csv out.csv] [--bin out.bin] [--extract out [--first-lba n]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(extractPath) {
+        return extractOnly(image, g, extractPath);
+    }
+
+    uint32_t crc_check = phxCrc32((const uint8_t *)"123456789", 9);
+    if(crc_check != 0xCBF43926) {
+        printf("FAILED: CRC-32 check value %08x, want cbf43926\n", crc_check);
+        return 1;
+    }
+
+    FlightProfile profile;
+    std::vector<TraceSample> trace = makeSyntheticFlight(profile, nullptr);
+    remove(image);
+    SilBlockDevice dev;
+    if(!dev.open(image, g.first_lba + g.sectors)) {
+        perror(image);
+        return 1;
+    }
+    dev.write_us = write_us;
+
+    // 1. clean flight
+    FlightRun clean = fly(trace, dev, g, seed, csvPath);
+    ExtentRecovery rec;
+    uint8_t scratch[PHX_EXTENT_SECTOR];
+    std::vector<Bytes> sessions;
+    bool ok = recoverExtent(dev, g.first_lba, g.sectors, rec, scratch) && extract(dev, g, rec, sessions)
+           && sessions.size() == 1 && rec.end == clean.blocks && !clean.cut;
+    if(!ok) {
+        printf("FAILED: the clean flight's log does not read back\n");
+        return 1;
+    }
+    const Bytes reference = sessions[0];
+    if(binPath && !writeFile(binPath, reference)) {
+        perror(binPath);
+        return 1;
+    }
+    printf("flight       %zu bytes in %u blocks of %u, %u superblock updates, %u overruns\n",
+           reference.size(), clean.blocks, (unsigned)PHX_EXTENT_PAYLOAD, clean.super_writes, clean.overruns);
+    printf("latency      at most %u sector writes per loop (%u while realtime), worst service() %u us at %u us per sector\n",
+           clean.worst_writes, clean.worst_writes_rt, clean.worst_service_us, write_us);
+    if(clean.worst_writes_rt > PHX_LOG_REALTIME_BLOCKS) {
+        printf("FAILED: more than PHX_LOG_REALTIME_BLOCKS sector writes in one realtime loop\n");
+        ok = false;
+    }
+
+    // 2. power cuts
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> at(1, clean.device_writes - 1);
+    std::uniform_int_distribution<uint32_t> torn(0, PHX_EXTENT_SECTOR - 1);
+    uint32_t worst_scan = 0, failures = 0;
+    for(int k = 0; k < cuts; k++) {
+        wipeSupers(dev, g);
+        dev.writes = 0;
+        const uint32_t cut_at = at(rng);
+        dev.cutAfter(cut_at, torn(rng));
+        FlightRun run = fly(trace, dev, g, seed * 7919 + k + 1, nullptr);
+        dev.restore();
+
+        bool trial_ok = recoverExtent(dev, g.first_lba, g.sectors, rec, scratch) && extract(dev, g, rec, sessions);
+        trial_ok = trial_ok && rec.end == run.blocks && (rec.end == 0 || sessions.size() == 1);
+        const Bytes got = rec.end ? sessions[0] : Bytes();
+        trial_ok = trial_ok && got.size() <= reference.size()
+                && memcmp(got.data(), reference.data(), got.size()) == 0;
+        if(rec.scanned > worst_scan) worst_scan = rec.scanned;
+
+        // reboot onto the same extent and log a second session after the first
+        ExtentJournal again;
+        SectorLogger logger;
+        trial_ok = trial_ok && again.begin(dev, g.first_lba, g.sectors, 0) && again.next() == rec.end;
+        logger.begin(again);
+        for(int i = 0; i < 2000; i++) {
+            logger.print("reboot ");
+            logger.println(i);
+            logger.service();
+        }
+        logger.close();
+        Bytes second;
+        {
+            char line[32];
+            for(int i = 0; i < 2000; i++) {
+                int n = snprintf(line, sizeof(line), "reboot %d\r\n", i);
+                second.insert(second.end(), line, line + n);
+            }
+        }
+        trial_ok = trial_ok && recoverExtent(dev, g.first_lba, g.sectors, rec, scratch) && extract(dev, g, rec, sessions)
+                && sessions.size() == (got.empty() ? 1u : 2u) && sessions.back() == second
+                && (got.empty() || sessions[0] == got);
+        if(!trial_ok) {
+            printf("FAILED: cut after %u writes: recovered %u blocks, %u were written\n", cut_at, rec.end, run.blocks);
+            failures++;
+        }
+    }
+    if(cuts > 0) {
+        printf("power cuts   %d, %u failed; recovery read at most %u blocks past the superblock\n",
+               cuts, failures, worst_scan);
+    }
+    ok = ok && failures == 0;
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
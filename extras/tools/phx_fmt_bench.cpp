@@ -0,0 +1,104 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_fmt_bench: rows per second of the CSV row formatter, Print::print
+// per field (as writeSD did) against one LineBuffer and a single write.
+// Also counts rows where the two texts differ.
+//
+//   usage: phx_fmt_bench [rows]
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "SRAD_PHX_Format.h"
+#include "SRAD_PHX_Schema.h"
+
+// Print sink with the cost profile of a real port: one virtual write per call
+class CountingPrint : public Print {
+    public:
+        size_t write(uint8_t) override { bytes++; return 1; }
+        size_t write(const uint8_t *, size_t n) override { bytes += n; return n; }
+        using Print::write;
+        uint64_t bytes = 0;
+};
+
+// Print that keeps the text, to compare the two formatters
+class StringPrint : public Print {
+    public:
+        size_t write(uint8_t b) override { text += (char)b; return 1; }
+        size_t write(const uint8_t *b, size_t n) override { text.append((const char *)b, n); return n; }
+        using Print::write;
+        std::string text;
+};
+
+template <class T> static void randomize(T &v, std::mt19937 &rng) { v = (T)rng(); }
+static void randomize(float &v, std::mt19937 &rng) {
+    // mostly sensor-sized values, with some large and negative ones
+    std::uniform_real_distribution<float> small(-50, 50), large(-1e5f, 1e5f);
+    v = rng() % 8 ? small(rng) : large(rng);
+}
+
+static std::vector<FlightRecord> makeRecords(size_t n) {
+    std::mt19937 rng(1);
+    std::vector<FlightRecord> recs(n);
+    for(FlightRecord &r : recs) {
+#define PHX_RANDOM_FIELD(name, type, precision, tlm, member, label, flags) \
+        { PHX_CTYPE_##type v; randomize(v, rng); r.name = v; }
+        PHX_FLIGHT_FIELDS(PHX_RANDOM_FIELD)
+#undef PHX_RANDOM_FIELD
+        r.gps_fix = rng() & 1;
+    }
+    return recs;
+}
+
+int main(int argc, char **argv) {
+    size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    std::vector<FlightRecord> recs = makeRecords(4096);
+    typedef std::chrono::steady_clock clock;
+
+    CountingPrint sink;
+    clock::time_point t0 = clock::now();
+    for(size_t i = 0; i < rows; i++) {
+        printCsvRow(sink, recs[i & 4095]);
+    }
+    double print_s = std::chrono::duration<double>(clock::now() - t0).count();
+    uint64_t print_bytes = sink.bytes;
+
+    sink.bytes = 0;
+    t0 = clock::now();
+    for(size_t i = 0; i < rows; i++) {
+        LineBuffer<PHX_CSV_LINE_MAX> line;
+        printCsvRow(line, recs[i & 4095]);
+        sink.write(line.bytes(), line.length());
+    }
+    double line_s = std::chrono::duration<double>(clock::now() - t0).count();
+
+    size_t differ = 0;
+    for(const FlightRecord &r : recs) {
+        StringPrint a;
+        printCsvRow(a, r);
+        LineBuffer<PHX_CSV_LINE_MAX> b;
+        printCsvRow(b, r);
+        if(a.text != std::string(b.data(), b.length())) {
+            differ++;
+        }
+    }
+
+    printf("rows         %zu, %.0f bytes/row\n", rows, (double)print_bytes / rows);
+    printf("Print        %10.0f rows/s  %6.0f ns/row\n", rows / print_s, print_s * 1e9 / rows);
+    printf("LineBuffer   %10.0f rows/s  %6.0f ns/row  (%.1fx)\n", rows / line_s, line_s * 1e9 / rows, print_s / line_s);
+    printf("text differs %zu of %zu rows (last-digit rounding ties)\n", differ, recs.size());
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_health: checks HealthMonitor (SRAD_PHX_Health.h) on a hand-driven
+// millisecond clock, one attempt per 10 ms tick.
+//
+// 1. Slow reads that return data: the sensor is degraded, never backed off.
+// 2. PHX_HEALTH_FAIL_AFTER failures in a row back it off; one fewer does not.
+// 3. While backed off due() is false until the retry time, and each failed
+//    retry doubles the interval up to PHX_HEALTH_BACKOFF_MAX_MS.
+// 4. A good read ends the back-off; 32 good reads clear the history.
+// 5. The GPS, and a sensor excluded with setBackoff(), are never backed off.
+//
+//   usage: phx_health
+
+#include <stdio.h>
+
+#include "SRAD_PHX_Health.h"
+
+static const char *HEALTH_NAMES[] = { "OK", "DEGRADED", "BACKOFF" };
+
+static bool check(const char *what, bool ok) {
+    printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// one tick: ask due(), and record the attempt if it was made
+static bool attempt(HealthMonitor &m, uint8_t sensor, bool ok, uint32_t latency_us, uint32_t &now_ms) {
+    now_ms += 10;
+    if(!m.due(sensor, now_ms)) {
+        return false;
+    }
+    m.record(sensor, ok, latency_us, now_ms);
+    return true;
+}
+
+static bool slowReads() {
+    HealthMonitor m;
+    uint32_t now_ms = 0;
+    bool ok = true, backed_off = false;
+    for(int i = 0; i < 50; i++) {
+        ok &= attempt(m, SENSOR_BMP, true, PHX_HEALTH_SLOW_US * 3, now_ms);
+        backed_off |= m.state(SENSOR_BMP) == HEALTH_BACKOFF;
+    }
+    const SensorHealth &h = m[SENSOR_BMP];
+    printf("slow reads   50 at %u us: %s, %u slow, %u errors\n",
+           (unsigned)(PHX_HEALTH_SLOW_US * 3), HEALTH_NAMES[h.state], (unsigned)h.slow, (unsigned)h.errors);
+    return check("slow reads degrade, never back off", ok && !backed_off && h.state == HEALTH_DEGRADED &&
+                 h.slow == 50 && h.errors == 0 && h.consecutive == 0);
+}
+
+static bool backoff() {
+    HealthMonitor m;
+    uint32_t now_ms = 0;
+    bool ok = true;
+
+    for(int i = 0; i < PHX_HEALTH_FAIL_AFTER - 1; i++) {
+        attempt(m, SENSOR_LSM, false, 100, now_ms);
+    }
+    ok &= check("one failure short of the limit: degraded", m.state(SENSOR_LSM) == HEALTH_DEGRADED);
+    attempt(m, SENSOR_LSM, false, 100, now_ms);
+    ok &= check("PHX_HEALTH_FAIL_AFTER failures: backed off", m.state(SENSOR_LSM) == HEALTH_BACKOFF &&
+                m[SENSOR_LSM].backoff_ms == PHX_HEALTH_BACKOFF_MIN_MS);
+
+    // fail every retry; the interval between attempts doubles to the cap
+    uint32_t last_ms = now_ms, expect_ms = PHX_HEALTH_BACKOFF_MIN_MS;
+    bool doubled = true;
+    uint32_t retries = 0;
+    while(now_ms < 20000) {
+        if(!attempt(m, SENSOR_LSM, false, 100, now_ms)) {
+            continue;
+        }
+        retries++;
+        doubled &= now_ms - last_ms == expect_ms;
+        expect_ms = expect_ms * 2 < PHX_HEALTH_BACKOFF_MAX_MS ? expect_ms * 2 : PHX_HEALTH_BACKOFF_MAX_MS;
+        last_ms = now_ms;
+    }
+    const SensorHealth &h = m[SENSOR_LSM];
+    printf("back-off     %u retries, %u skipped, interval now %u ms\n",
+           (unsigned)h.retries, (unsigned)h.skipped, (unsigned)h.backoff_ms);
+    ok &= check("retries double up to PHX_HEALTH_BACKOFF_MAX_MS", doubled && retries == h.retries &&
+                h.backoff_ms == PHX_HEALTH_BACKOFF_MAX_MS && h.reads + h.skipped == 20000 / 10);
+
+    while(!attempt(m, SENSOR_LSM, true, 100, now_ms)) {}
+    ok &= check("a good read ends the back-off", m.state(SENSOR_LSM) == HEALTH_DEGRADED &&
+                h.backoff_ms == 0 && h.consecutive == 0);
+    for(int i = 0; i < 32; i++) {
+        ok &= attempt(m, SENSOR_LSM, true, 100, now_ms);
+    }
+    ok &= check("32 good reads: OK again", m.state(SENSOR_LSM) == HEALTH_OK);
+    return ok;
+}
+
+static bool exempt() {
+    HealthMonitor m;
+    m.setBackoff(SENSOR_ADXL, false);
+    uint32_t now_ms = 0;
+    bool due = true;
+    for(int i = 0; i < 100; i++) {
+        due &= attempt(m, SENSOR_GPS, false, 100, now_ms);
+        due &= attempt(m, SENSOR_ADXL, false, 100, now_ms);
+    }
+    return check("GPS and setBackoff(false) sensors stay due", due &&
+                 m.state(SENSOR_GPS) == HEALTH_DEGRADED && m.state(SENSOR_ADXL) == HEALTH_DEGRADED);
+}
+
+int main(int argc, char **argv) {
+    if(argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 2;
+    }
+    bool ok = slowReads();
+    ok &= backoff();
+    ok &= exempt();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
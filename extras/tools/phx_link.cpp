@@ -0,0 +1,396 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_link: the two-board split as two Linux processes. The flight
+// process replays a synthetic flight through FLIGHT and only acquires,
+// estimates and calls writeDataToTeensy. The logging process runs
+// readDataFromTeensy and nextLinkRecord and does all the CSV and binary
+// logging. They talk over a pseudo-terminal (or two pipes) paced like a
+// UART, so acks, resyncs and backpressure go over a real byte stream.
+//
+//   usage: phx_link [options]
+//     --pipe                link the processes with two pipes instead of a pty
+//     --acquire <tty>       only run the flight side, on an existing tty or fifo
+//     --log <tty>           only run the logging side, on an existing tty or fifo
+//     --speed <x>           run the flight this many times faster than real time (default 10)
+//     --baud <rate>         link rate before --speed scaling (default 115200)
+//     --hz <rate>           synthetic sample rate (default 100)
+//     --slow <us>           logging side: extra time spent on each record, as a slow SD card
+//     --csv <out.csv>       logging side writeSD output
+//     --bin <out.bin>       logging side writeSDBinary output through a SectorLogger
+//
+// Without --acquire or --log it forks and runs both on one pty.
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#include "sil_rig.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+struct Options {
+    double speed = 10;
+    double baud = 115200;
+    double hz = 100;
+    uint32_t slow_us = 0;
+    const char *csv = nullptr;
+    const char *bin = nullptr;
+};
+
+static double secondsSince(clock_type::time_point t0) {
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+/**
+ * @brief a UART over a pair of non-blocking file descriptors
+ *
+ * Writes go into a `cap` byte transmit buffer, like a Teensy serial port
+ * after addMemoryForWrite(), and leave it at most `bytes_per_s` through
+ * pump(). availableForWrite() is the room left in that buffer.
+ */
+class FdStream : public Stream {
+    public:
+        FdStream(int in_fd, int out_fd, double bytes_per_s, size_t cap = 1024)
+        : in(in_fd), out(out_fd), rate(bytes_per_s), cap(cap), last(clock_type::now()) {}
+
+        size_t write(uint8_t b) override { return write(&b, 1); }
+        size_t write(const uint8_t *buffer, size_t n) override {
+            n = n < cap - tx.size() ? n : cap - tx.size();
+            tx.append((const char *)buffer, n);
+            return n;
+        }
+        using Print::write;
+        int availableForWrite() override { return cap - tx.size(); }
+
+        int available() override {
+            if(rx_pos == rx.size()) {
+                pumpRx();
+            }
+            return rx.size() - rx_pos;
+        }
+        int read() override { return available() ? (uint8_t)rx[rx_pos++] : -1; }
+        int peek() override { return available() ? (uint8_t)rx[rx_pos] : -1; }
+
+        void pump() {
+            pumpTx();
+            pumpRx();
+        }
+
+        bool eof() const { return closed && rx_pos == rx.size(); }
+        size_t pending() const { return tx.size(); }
+
+    private:
+        void pumpTx() {
+            clock_type::time_point now = clock_type::now();
+            credit += std::chrono::duration<double>(now - last).count() * rate;
+            last = now;
+            if(credit > cap) {
+                credit = cap;               // an idle line does not bank time
+            }
+            size_t n = tx.size() < (size_t)credit ? tx.size() : (size_t)credit;
+            if(!n) {
+                return;
+            }
+            ssize_t w = ::write(out, tx.data(), n);
+            if(w > 0) {
+                tx.erase(0, w);
+                credit -= w;
+            } else if(w < 0 && errno != EAGAIN) {
+                closed = true;
+                tx.clear();
+            }
+        }
+
+        void pumpRx() {
+            if(rx_pos == rx.size()) {
+                rx.clear();
+                rx_pos = 0;
+            }
+            char buf[4096];
+            for(;;) {
+                ssize_t r = ::read(in, buf, sizeof(buf));
+                if(r > 0) {
+                    rx.append(buf, r);
+                    continue;
+                }
+                if(r == 0 || errno != EAGAIN) {
+                    closed = true;          // EOF on a pipe, EIO on a pty whose other end closed
+                }
+                return;
+            }
+        }
+
+        int in, out;
+        double rate;
+        size_t cap;
+        clock_type::time_point last;
+        double credit = 0;
+        std::string tx, rx;
+        size_t rx_pos = 0;
+        bool closed = false;
+};
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static void setRaw(int fd) {
+    struct termios t;
+    if(tcgetattr(fd, &t) == 0) {
+        cfmakeraw(&t);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+}
+
+/**
+ * @brief the flight board: acquire, estimate, stream
+ */
+static int runFlight(FdStream &port, const Options &o) {
+    FlightProfile profile;
+    profile.sample_hz = o.hz;
+    TruthEvents truth;
+    std::vector<TraceSample> trace = makeSyntheticFlight(profile, &truth);
+
+    SilRig rig;
+    sim::setMicros(trace.front().time_us);
+    rig.flight.initTransferSerial(port);
+
+    clock_type::time_point start = clock_type::now();
+    uint64_t worst_ns = 0, total_ns = 0;
+    for(const TraceSample &s : trace) {
+        double due = (s.time_us - trace.front().time_us) / 1e6 / o.speed;
+        while(secondsSince(start) < due) {
+            port.pump();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        clock_type::time_point t0 = clock_type::now();
+        rig.apply(s);
+        rig.step();
+        rig.flight.writeDataToTeensy(port);
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - t0).count();
+        total_ns += ns;
+        worst_ns = ns > worst_ns ? ns : worst_ns;
+        port.pump();
+    }
+    // let the last frames out
+    clock_type::time_point end = clock_type::now();
+    while(secondsSince(end) < 0.5 && !port.eof()) {
+        port.pump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const LinkTxStats &st = rig.flight.linkTx();
+    printf("flight   %zu records in %.2f s; loop mean %.0f ns, worst %llu ns; final state %u\n",
+           trace.size(), secondsSince(start), (double)total_ns / trace.size(), (unsigned long long)worst_ns,
+           rig.flight.getState());
+    printf("flight   %u frames sent, %u thinned, %u blocked; %u acks, %u early keyframes, stride %u, %u in flight\n",
+           st.sent, st.thinned, st.blocked, st.acks, st.resyncs, st.stride, st.in_flight);
+    printf("flight   last ack: %u applied, %u lost, %u dropped, %u overflowed\n",
+           st.peer.applied, st.peer.lost, st.peer.dropped, st.peer.overflow);
+    return 0;
+}
+
+/**
+ * @brief the logging board: queue, format, write
+ */
+static int runLogger(FdStream &port, const Options &o) {
+    SilRig board;
+    board.flight.initTransferSerial(port);
+
+    File csvFile, binFile;
+    SectorLogger logger;
+    if(o.csv) {
+        csvFile = SD.open(o.csv, FILE_WRITE);
+        board.flight.writeSD(true, csvFile);
+    }
+    if(o.bin) {
+        binFile = SD.open(o.bin, FILE_WRITE);
+        logger.begin(binFile);
+        board.flight.writeSDBinary(true, logger);
+        board.flight.attachLogger(logger);
+    }
+
+    const uint64_t period_ms = (uint64_t)lround(1000 / o.hz);
+    uint32_t rows = 0, gaps = 0;
+    uint64_t missing = 0, last_ms = 0;
+    clock_type::time_point start = clock_type::now();
+    for(;;) {
+        port.pump();
+        board.flight.readDataFromTeensy(port);
+        bool any = false;
+        while(board.flight.nextLinkRecord()) {
+            any = true;
+            uint64_t t = board.data.totalTime_ms;
+            sim::setMicros(t * 1000);
+            if(rows && t - last_ms > period_ms + period_ms / 2) {
+                gaps++;
+                missing += (t - last_ms + period_ms / 2) / period_ms - 1;
+            }
+            last_ms = t;
+            rows++;
+            if(o.csv) {
+                board.flight.writeSD(false, csvFile);
+            }
+            if(o.bin) {
+                board.flight.writeSDBinary(false, logger);
+                logger.service();
+            }
+            if(o.slow_us) {
+                std::this_thread::sleep_for(std::chrono::microseconds(o.slow_us));
+            }
+            port.pump();
+        }
+        if(!any) {
+            if(port.eof()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    if(o.bin) {
+        logger.close();
+        binFile.close();
+    }
+    if(o.csv) {
+        csvFile.close();
+    }
+
+    const TelemetryRxStats &rx = board.flight.telemetryRx().stats();
+    const LinkRxStats &lr = board.flight.linkRx();
+    printf("logger   %u records in %.2f s, %u gaps totalling %llu records by totalTime_ms\n",
+           rows, secondsSince(start), gaps, (unsigned long long)missing);
+    printf("logger   %u frames applied, %u lost, %u dropped awaiting keyframe, %u malformed, %u overflowed;"
+           " queue high water %u/%u, %u acks sent\n",
+           rx.frames, rx.lost, rx.dropped, rx.malformed, lr.overflow, lr.high_water, PHX_LINK_QUEUE, lr.acks);
+    fflush(stdout);
+    return 0;
+}
+
+static int openTty(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0) {
+        perror(path);
+        return -1;
+    }
+    setRaw(fd);
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    Options o;
+    bool pipes = false;
+    const char *acquire = nullptr, *log = nullptr;
+    for(int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool more = i + 1 < argc;
+        if(!strcmp(a, "--pipe")) pipes = true;
+        else if(!strcmp(a, "--acquire") && more) acquire = argv[++i];
+        else if(!strcmp(a, "--log") && more) log = argv[++i];
+        else if(!strcmp(a, "--speed") && more) o.speed = atof(argv[++i]);
+        else if(!strcmp(a, "--baud") && more) o.baud = atof(argv[++i]);
+        else if(!strcmp(a, "--hz") && more) o.hz = atof(argv[++i]);
+        else if(!strcmp(a, "--slow") && more) o.slow_us = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--csv") && more) o.csv = argv[++i];
+        else if(!strcmp(a, "--bin") && more) o.bin = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--pipe] [--acquire tty | --log tty] [--speed x] [--baud rate] [--hz rate] "
+                            "[--slow us] [--csv out.csv] [--bin out.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(o.speed <= 0 || o.hz <= 0) {
+        fprintf(stderr, "--speed and --hz must be positive\n");
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    const double bytes_per_s = o.baud / 10 * o.speed;
+
+    if(acquire || log) {
+        int fd = openTty(acquire ? acquire : log);
+        if(fd < 0) {
+            return 1;
+        }
+        FdStream port(fd, fd, bytes_per_s);
+        return acquire ? runFlight(port, o) : runLogger(port, o);
+    }
+
+    // flight side fds, logging side fds
+    int f_in, f_out, l_in, l_out;
+    if(pipes) {
+        int to_log[2], to_flight[2];
+        if(pipe(to_log) || pipe(to_flight)) {
+            perror("pipe");
+            return 1;
+        }
+        f_in = to_flight[0];
+        f_out = to_log[1];
+        l_in = to_log[0];
+        l_out = to_flight[1];
+    } else {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if(master < 0 || grantpt(master) || unlockpt(master)) {
+            perror("posix_openpt");
+            return 1;
+        }
+        int slave = openTty(ptsname(master));
+        if(slave < 0) {
+            return 1;
+        }
+        f_in = f_out = master;
+        l_in = l_out = slave;
+    }
+
+    fflush(stdout);
+    pid_t child = fork();
+    if(child < 0) {
+        perror("fork");
+        return 1;
+    }
+    if(child == 0) {
+        if(pipes) {
+            close(f_in);
+            close(f_out);
+        } else {
+            close(f_in);
+        }
+        setNonBlocking(l_in);
+        setNonBlocking(l_out);
+        FdStream port(l_in, l_out, bytes_per_s);
+        _exit(runLogger(port, o));
+    }
+    if(pipes) {
+        close(l_in);
+        close(l_out);
+    } else {
+        close(l_in);
+    }
+    setNonBlocking(f_in);
+    setNonBlocking(f_out);
+    FdStream port(f_in, f_out, bytes_per_s);
+    runFlight(port, o);
+    fflush(stdout);
+    close(f_in);
+    if(f_out != f_in) {
+        close(f_out);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,286 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_mc: Monte Carlo sweep of the flight-state thresholds.
+//
+// Draws `--profiles` synthetic flights with random motors, drag, recovery,
+// pad time, launch site, sensor noise and dropouts. Some boost hard enough
+// to saturate the LSM and some are knocked on the pad. Every pad outlasts
+// PHX_CAL_MAX_MS, so calibration is over by ignition (phx_cal flies a
+// launch during it). Every threshold set (every combination of the lists
+// given) flies every profile through FLIGHT's read_* and calculateState,
+// so the estimator, the apogee fit and every timer run unchanged. Each worker thread takes whole profiles: it
+// builds the trace once and runs every set over it.
+//
+// For each set and event (liftoff, apogee, landed) it reports how often the
+// event fired before the truth (false), never fired (missed), and the
+// latency distribution of the rest. The profile numbers of the first few
+// false or missed runs are listed; `--first n --profiles 1 --save-trace f`
+// writes that flight for phx_sil --trace.
+//
+//   usage: phx_mc [options]
+//     --profiles <n>        flights per set (default 500)
+//     --first <n>           number of the first profile (default 0)
+//     --seed <n>            base seed (default 1)
+//     --threads <n>         worker threads (default: every core)
+//     --liftoff-acc <list>  accel_liftoff_threshold, m/s^2
+//     --liftoff-ms <list>   accel_liftoff_time_threshold, ms
+//     --land-ms <list>      land_time_threshold, ms
+//     --land-alt <list>     land_altitude_threshold, m
+//     --apogee-vel <list>   ApogeeDetector sink rate, m/s
+//     --apogee-n <list>     ApogeeDetector consecutive fits
+//     --save-trace <f.csv>  write the first profile's trace
+//   lists are comma separated, e.g. --liftoff-acc 20,30,40
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "sil_rig.h"
+
+enum MC_EVENT { EV_LIFTOFF = 0, EV_APOGEE, EV_LANDED, EV_COUNT };
+static const char *EVENT_NAMES[EV_COUNT] = { "liftoff", "apogee", "landed" };
+static const uint8_t EVENT_STATE[EV_COUNT] = { FLIGHT_ASCENT, FLIGHT_DESCENT, POST_LANDED };
+
+#define MC_EXAMPLES 4                       // profile numbers listed per set and event
+
+// one draw of the flight and the sensors
+static FlightProfile randomProfile(uint32_t seed, uint32_t index, float landed_s) {
+    std::mt19937 rng(seed * 2654435761u + index);
+    std::uniform_real_distribution<float> u(0, 1);
+    auto range = [&](float lo, float hi) { return lo + (hi - lo) * u(rng); };
+
+    FlightProfile p;
+    p.seed = rng();
+    p.pad_s = range(PHX_CAL_MAX_MS / 1000.0f + 1, 30);    // calibration is over by ignition
+    p.ground_alt = range(0, 1500);
+    p.boost_acc = u(rng) < 0.15f ? range(310, 450) : range(40, 250);    // some saturate the LSM
+    p.burn_s = range(0.8f, 5);
+    p.drag_k = range(0.0002f, 0.0015f);
+    p.drogue_rate = range(15, 35);
+    p.main_alt = range(150, 400);
+    p.main_rate = range(4, 9);
+    p.landed_s = landed_s;
+    p.baro_noise = range(0.1f, 1.5f);
+    p.acc_noise = range(0.05f, 0.8f);
+    p.gyro_noise = range(0.002f, 0.03f);
+    p.dropout_rate = u(rng) < 0.3f ? range(0, 0.05f) : 0;
+    if(u(rng) < 0.5f) {
+        p.knock_t = range(1, p.pad_s - 0.5f);
+        p.knock_acc = range(10, 80);
+        p.knock_s = range(0.01f, 0.3f);
+    }
+    return p;
+}
+
+struct Outcome {
+    float latency_ms[EV_COUNT];             // after the truth; negative if early, NAN if missed
+};
+
+/**
+ * @brief flies one trace with one threshold set
+ *
+ * The loop is SilRig::step without the GPS and the writers, which no
+ * detector reads. It stops once POST_LANDED is reached.
+ * @return samples flown
+ */
+static size_t fly(const std::vector<TraceSample> &trace, const TruthEvents &truth,
+                const SilThresholds &t, Outcome &out) {
+    sim::setMicros(0);
+    SilRig rig(t);
+    double entered_ms[EV_COUNT] = { NAN, NAN, NAN };
+    uint8_t last = PRE_NO_CAL;
+    size_t n = 0;
+    for(const TraceSample &s : trace) {
+        n++;
+        rig.apply(s);
+        rig.flight.incrementTime();
+        rig.flight.read_LSM(rig.lsm);
+        rig.flight.read_BMP(rig.bmp);
+        rig.flight.read_ADXL(rig.adxl);
+        rig.flight.read_BNO(rig.bno);
+        rig.flight.calculateState();
+
+        uint8_t state = rig.flight.getState();
+        if(state != last) {
+            for(int e = 0; e < EV_COUNT; e++) {
+                if(state >= EVENT_STATE[e] && isnan(entered_ms[e])) {
+                    entered_ms[e] = s.time_us / 1000.0;
+                }
+            }
+            last = state;
+            if(state == POST_LANDED) {
+                break;
+            }
+        }
+    }
+    const double truth_ms[EV_COUNT] = { truth.liftoff_ms, truth.apogee_ms, truth.landed_ms };
+    for(int e = 0; e < EV_COUNT; e++) {
+        out.latency_ms[e] = entered_ms[e] - truth_ms[e];
+    }
+    return n;
+}
+
+struct SetResult {
+    SilThresholds t;
+    std::vector<Outcome> runs;              // one per profile
+};
+
+static std::vector<float> parseFloats(const char *s) {
+    std::vector<float> v;
+    for(char *end; *s; s = *end ? end + 1 : end) {
+        v.push_back(strtof(s, &end));
+        if(end == s) break;
+    }
+    return v;
+}
+
+static float percentile(std::vector<float> &v, double p) {
+    if(v.empty()) {
+        return NAN;
+    }
+    size_t k = std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static void report(const SetResult &r, uint32_t first) {
+    const SilThresholds &t = r.t;
+    printf("\nliftoff %d m/s^2 for %d ms, apogee %.1f m/s x%u, landed %d ms under %d m\n",
+           t.accel_liftoff, t.accel_liftoff_time, t.apogee_descent, t.apogee_confirm, t.land_time, t.land_altitude);
+    printf("  %-8s %6s %6s %8s %8s %8s %8s   %s\n", "event", "false", "missed", "p50 ms", "p95 ms", "p99 ms", "max ms",
+           "false/missed profiles");
+    for(int e = 0; e < EV_COUNT; e++) {
+        std::vector<float> late;
+        std::vector<uint32_t> bad;
+        uint32_t early = 0, missed = 0;
+        for(size_t i = 0; i < r.runs.size(); i++) {
+            float l = r.runs[i].latency_ms[e];
+            if(isnan(l)) {
+                missed++;
+            } else if(l < 0) {
+                early++;
+            } else {
+                late.push_back(l);
+                continue;
+            }
+            if(bad.size() < MC_EXAMPLES) {
+                bad.push_back(first + i);
+            }
+        }
+        float p50 = percentile(late, 0.50), p95 = percentile(late, 0.95), p99 = percentile(late, 0.99);
+        float worst = late.empty() ? NAN : *std::max_element(late.begin(), late.end());
+        printf("  %-8s %6u %6u %8.0f %8.0f %8.0f %8.0f  ", EVENT_NAMES[e], early, missed, p50, p95, p99, worst);
+        for(uint32_t b : bad) {
+            printf(" %u", b);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t profiles = 500, first = 0, seed = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+    const char *save_path = nullptr;
+    SilThresholds d;
+    std::vector<float> acc = { (float)d.accel_liftoff }, acc_ms = { (float)d.accel_liftoff_time };
+    std::vector<float> land_ms = { (float)d.land_time }, land_alt = { (float)d.land_altitude };
+    std::vector<float> apo_vel = { d.apogee_descent }, apo_n = { (float)d.apogee_confirm };
+
+    for(int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has = i + 1 < argc;
+        if(!strcmp(a, "--profiles") && has) profiles = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--first") && has) first = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--seed") && has) seed = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--threads") && has) threads = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--liftoff-acc") && has) acc = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--liftoff-ms") && has) acc_ms = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--land-ms") && has) land_ms = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--land-alt") && has) land_alt = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--apogee-vel") && has) apo_vel = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--apogee-n") && has) apo_n = parseFloats(argv[++i]);
+        else if(!strcmp(a, "--save-trace") && has) save_path = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--profiles n] [--first n] [--seed n] [--threads n] [--liftoff-acc list]\n"
+                            "       [--liftoff-ms list] [--land-ms list] [--land-alt list] [--apogee-vel list]\n"
+                            "       [--apogee-n list] [--save-trace f.csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(!profiles || acc.empty() || acc_ms.empty() || land_ms.empty() || land_alt.empty() || apo_vel.empty() || apo_n.empty()) {
+        fprintf(stderr, "%s: nothing to run\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<SetResult> sets;
+    float longest_land_ms = 0;
+    for(float a : acc) for(float am : acc_ms) for(float av : apo_vel) for(float an : apo_n)
+    for(float lm : land_ms) for(float la : land_alt) {
+        SetResult r;
+        r.t.accel_liftoff = (int)a;
+        r.t.accel_liftoff_time = (int)am;
+        r.t.apogee_descent = av;
+        r.t.apogee_confirm = (uint8_t)an;
+        r.t.land_time = (int)lm;
+        r.t.land_altitude = (int)la;
+        r.runs.resize(profiles);
+        sets.push_back(r);
+        longest_land_ms = std::max(longest_land_ms, lm);
+    }
+    // record long enough after touchdown for the slowest landing timer to run out
+    const float landed_s = std::max(20.0f, longest_land_ms / 1000.0f + 10.0f);
+
+    if(save_path) {
+        FlightProfile p = randomProfile(seed, first, landed_s);
+        if(!saveTrace(save_path, makeSyntheticFlight(p))) {
+            perror(save_path);
+            return 1;
+        }
+        printf("profile %u: pad %.1f s, boost %.0f m/s^2 for %.1f s, knock %.0f m/s^2 for %.0f ms at %.1f s\n",
+               first, p.pad_s, p.boost_acc, p.burn_s, p.knock_acc, p.knock_s * 1000, p.knock_t);
+    }
+
+    threads = std::max(1u, std::min(threads, profiles));
+    std::atomic<uint32_t> next(0);
+    std::atomic<uint64_t> samples(0);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned k = 0; k < threads; k++) {
+        pool.emplace_back([&]() {
+            for(uint32_t i; (i = next++) < profiles; ) {
+                TruthEvents truth;
+                std::vector<TraceSample> trace = makeSyntheticFlight(randomProfile(seed, first + i, landed_s), &truth);
+                size_t n = 0;
+                for(SetResult &r : sets) {
+                    n += fly(trace, truth, r.t, r.runs[i]);
+                }
+                samples += n;
+            }
+        });
+    }
+    for(std::thread &th : pool) th.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("%zu threshold set%s x %u profiles on %u thread%s in %.1f s: %.0f flights/s, %.1f M samples/s\n",
+           sets.size(), sets.size() == 1 ? "" : "s", profiles, threads, threads == 1 ? "" : "s", wall,
+           sets.size() * profiles / wall, samples / wall / 1e6);
+    for(const SetResult &r : sets) {
+        report(r, first);
+    }
+    return 0;
+}
@@ -0,0 +1,457 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_sil: replays a flight trace through the real FLIGHT code on Linux.
+//
+//   usage: phx_sil [options]
+//     --trace <in.csv>      replay a recorded trace (default: synthetic flight)
+//     --save-trace <f.csv>  write the trace being replayed
+//     --hz <rate>           synthetic sample rate (default 100)
+//     --seed <n>            synthetic noise seed
+//     --boost <m/s^2>       synthetic boost acceleration (> 304 saturates the LSM)
+//     --pad <s>             synthetic time on the pad before ignition (default 10);
+//                           under 2 s launches before calibration is done
+//     --csv <out.csv>       writeSD output
+//     --bin <out.bin>       writeSDBinary output through a SectorLogger
+//     --serial              also run writeSERIAL into a byte counter
+//     --link [loss]         send writeDataToTeensy frames to a second board, dropping
+//                           each frame with probability `loss` (default 0)
+//     --sched               run the loop as FlightTasks at their PHX_RATE_* rates
+//     --fifo                read the LSM and ADXL through their FIFOs (register-level mocks)
+//     --burst [mask]        read the BNO055 in one burst; `mask` (BNO_FETCH bits) is
+//                           fetched during ascent and descent (default all)
+//     --pretrigger [ms]     hold pad rows in RAM, log a heartbeat every `ms` until
+//                           liftoff (default PHX_PRETRIGGER_HEARTBEAT_MS)
+//     --rates               use the default state rate policy (useDefaultRatePolicy)
+//     --fail <s>:<from>:<to>[:us]
+//                           sensor `s` (lsm, bmp, adxl, bno) fails from `from` to `to`
+//                           seconds into the trace, each failed read taking `us` of
+//                           clock (Adafruit driver mocks); may be repeated
+//     --profile             print per-stage timing histograms
+//     -q                    only print the summary
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sil_rig.h"
+
+static const char *STATE_NAMES[] = { "PRE_NO_CAL", "PRE_CAL", "FLIGHT_ASCENT", "FLIGHT_DESCENT", "POST_LANDED" };
+static const char *SENSOR_NAMES[] = { "lsm", "bmp", "adxl", "bno", "gps" };
+static const char *HEALTH_NAMES[] = { "OK", "DEGRADED", "BACKOFF" };
+
+// --fail: a window of failed reads on one sensor
+struct SensorFault {
+    int sensor;                             // SENSOR_ID
+    double from_s, to_s;
+    uint32_t timeout_us;
+};
+
+static bool parseFault(const char *arg, SensorFault &f) {
+    char name[8];
+    f.timeout_us = 0;
+    if(sscanf(arg, "%7[a-z]:%lf:%lf:%u", name, &f.from_s, &f.to_s, &f.timeout_us) < 3) {
+        return false;
+    }
+    for(f.sensor = 0; f.sensor < SENSOR_GPS; f.sensor++) {
+        if(!strcmp(name, SENSOR_NAMES[f.sensor])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// NaNs the sensor's first channel inside the window; SilRig::apply turns that into failed reads
+static void applyFault(std::vector<TraceSample> &trace, const SensorFault &f) {
+    const uint64_t t0 = trace.front().time_us;
+    for(TraceSample &s : trace) {
+        double t = (s.time_us - t0) / 1e6;
+        if(t < f.from_s || t >= f.to_s) {
+            continue;
+        }
+        float *v = f.sensor == SENSOR_LSM ? s.lsm_acc : f.sensor == SENSOR_BMP ? &s.bmp_alt :
+                   f.sensor == SENSOR_ADXL ? s.adxl_acc : s.bno_acc;
+        v[0] = NAN;
+    }
+}
+
+// Print that goes to stdout, for reports
+class StdoutPrint : public Print {
+    public:
+        size_t write(uint8_t b) override { return fputc(b, stdout) == EOF ? 0 : 1; }
+        size_t write(const uint8_t *buffer, size_t n) override { return fwrite(buffer, 1, n, stdout); }
+        using Print::write;
+};
+
+// Stream that throws data away, for timing writeSERIAL without a port
+class NullStream : public Stream {
+    public:
+        size_t write(uint8_t) override { bytes++; return 1; }
+        size_t write(const uint8_t *, size_t n) override { bytes += n; return n; }
+        using Print::write;
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+        uint64_t bytes = 0;
+};
+
+#define PHX_SIL_LINK_FRAMING 5             // mock SerialTransfer: start, id, len, crc, stop
+
+// Checks the receiving board's FlightData against the sender's, field by field,
+// to within the schema `tlm` digits the link quantizes to.
+struct LinkCheck {
+    uint64_t wire_bytes = 0;
+    uint32_t sent = 0;
+    uint32_t mismatches = 0;
+
+    static bool close(float a, float b, int precision) {
+        if(isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+        return fabs((double)a - b) <= 0.5 * pow(10, -precision) + 1e-6 * fabs(a);
+    }
+    template <class T> static bool close(T a, T b, int) { return a == b; }
+
+    void compare(const FlightData &sent_data, const FlightData &got_data) {
+        FlightRecord a, b;
+        packFlightRecord(sent_data, a);
+        packFlightRecord(got_data, b);
+        bool ok = true;
+#define PHX_LINK_CHECK(name, type, precision, tlm, member, label, flags) \
+        ok = ok && close((PHX_CTYPE_##type)a.name, (PHX_CTYPE_##type)b.name, tlm);
+        PHX_FLIGHT_FIELDS(PHX_LINK_CHECK)
+#undef PHX_LINK_CHECK
+        if(!ok) {
+            mismatches++;
+        }
+    }
+};
+
+int main(int argc, char **argv) {
+    const char *tracePath = nullptr, *saveTracePath = nullptr, *csvPath = nullptr, *binPath = nullptr;
+    bool serial = false, quiet = false, profile_report = false, scheduled = false, link = false, fifo = false;
+    double link_loss = 0;
+    bool burst = false;
+    int burst_mask = BNO_FETCH_ALL;
+    bool pretrigger = false, rates = false;
+    uint32_t heartbeat_ms = PHX_PRETRIGGER_HEARTBEAT_MS;
+    FlightProfile profile;
+    std::vector<SensorFault> faults;
+
+    for(int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool more = i + 1 < argc;
+        if(!strcmp(a, "--trace") && more) tracePath = argv[++i];
+        else if(!strcmp(a, "--save-trace") && more) saveTracePath = argv[++i];
+        else if(!strcmp(a, "--hz") && more) profile.sample_hz = atof(argv[++i]);
+        else if(!strcmp(a, "--seed") && more) profile.seed = atoi(argv[++i]);
+        else if(!strcmp(a, "--boost") && more) profile.boost_acc = atof(argv[++i]);
+        else if(!strcmp(a, "--pad") && more) profile.pad_s = atof(argv[++i]);
+        else if(!strcmp(a, "--csv") && more) csvPath = argv[++i];
+        else if(!strcmp(a, "--bin") && more) binPath = argv[++i];
+        else if(!strcmp(a, "--serial")) serial = true;
+        else if(!strcmp(a, "--sched")) scheduled = true;
+        else if(!strcmp(a, "--fifo")) fifo = true;
+        else if(!strcmp(a, "--burst")) {
+            burst = true;
+            if(more && argv[i + 1][0] != '-') burst_mask = strtol(argv[++i], nullptr, 0);
+        }
+        else if(!strcmp(a, "--link")) {
+            link = true;
+            if(more && argv[i + 1][0] != '-') link_loss = atof(argv[++i]);
+        }
+        else if(!strcmp(a, "--pretrigger")) {
+            pretrigger = true;
+            if(more && argv[i + 1][0] != '-') heartbeat_ms = strtoul(argv[++i], nullptr, 10);
+        }
+        else if(!strcmp(a, "--rates")) rates = true;
+        else if(!strcmp(a, "--profile")) profile_report = true;
+        else if(!strcmp(a, "--fail") && more) {
+            SensorFault f;
+            if(!parseFault(argv[++i], f)) {
+                fprintf(stderr, "bad --fail %s, want lsm|bmp|adxl|bno:<from s>:<to s>[:timeout us]\n", argv[i]);
+                return 2;
+            }
+            faults.push_back(f);
+        }
+        else if(!strcmp(a, "-q")) quiet = true;
+        else {
+            fprintf(stderr, "usage: %s [--trace in.csv] [--save-trace f.csv] [--hz n] [--seed n] [--boost a] [--pad s] "
+                            "[--csv out.csv] [--bin out.bin] [--serial] [--link [loss]] [--sched] [--fifo] [--burst [mask]] [--pretrigger [ms]] [--rates] [--fail s:from:to[:us]] [--profile] [-q]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<TraceSample> trace;
+    TruthEvents truth = { -1, -1, -1 };
+    if(tracePath) {
+        if(!loadTrace(tracePath, trace)) {
+            perror(tracePath);
+            return 1;
+        }
+    } else {
+        trace = makeSyntheticFlight(profile, &truth);
+    }
+    for(const SensorFault &f : faults) {
+        applyFault(trace, f);
+    }
+    if(saveTracePath && !saveTrace(saveTracePath, trace)) {
+        perror(saveTracePath);
+        return 1;
+    }
+    if(trace.empty()) {
+        fprintf(stderr, "empty trace\n");
+        return 1;
+    }
+
+    SilRig rig;
+    sim::setMicros(trace.front().time_us);
+    for(const SensorFault &f : faults) {
+        uint32_t &timeout = f.sensor == SENSOR_LSM ? rig.lsm.sim.timeout_us : f.sensor == SENSOR_BMP ? rig.bmp.sim.timeout_us :
+                            f.sensor == SENSOR_ADXL ? rig.adxl.sim.timeout_us : rig.bno.sim.timeout_us;
+        timeout = f.timeout_us > timeout ? f.timeout_us : timeout;
+    }
+    if(fifo && !rig.beginFifo()) {
+        fprintf(stderr, "FIFO setup failed\n");
+        return 1;
+    }
+    if(burst) {
+        if(!rig.beginBnoBurst()) {
+            fprintf(stderr, "BNO055 setup failed\n");
+            return 1;
+        }
+        rig.flight.setBnoFetch(STATES::FLIGHT_ASCENT, burst_mask);
+        rig.flight.setBnoFetch(STATES::FLIGHT_DESCENT, burst_mask);
+    }
+    static FlightRecord pad_rows[PHX_PRETRIGGER_ROWS];
+    if(pretrigger) {
+        rig.flight.enablePretrigger(pad_rows, heartbeat_ms);
+    }
+    if(rates) {
+        rig.flight.useDefaultRatePolicy();
+    }
+    File csvFile, binFile;
+    SectorLogger logger;
+    NullStream serialSink;
+    if(csvPath) {
+        csvFile = SD.open(csvPath, FILE_WRITE);
+        rig.flight.writeSD(true, csvFile);
+        rig.sd = &csvFile;
+    }
+    if(binPath) {
+        binFile = SD.open(binPath, FILE_WRITE);
+        logger.begin(binFile);
+        rig.flight.writeSDBinary(true, logger);
+        rig.flight.attachLogger(logger);
+        rig.sdBinary = &logger;
+        rig.logger = &logger;
+    }
+    if(serial) {
+        rig.serial = &serialSink;
+    }
+
+    // second board on the other end of the SerialTransfer link
+    SilRig ground;
+    MockSerial linkTx, linkRx;
+    LinkCheck check;
+    std::mt19937 linkRng(profile.seed);
+    std::uniform_real_distribution<double> chance(0, 1);
+    if(link) {
+        rig.flight.initTransferSerial(linkTx);
+        ground.flight.initTransferSerial(linkRx);
+    }
+
+    TaskScheduler sched;
+    FlightTasks tasks(rig.flight);
+    if(scheduled) {
+        tasks.lsm = &rig.lsm;
+        tasks.bmp = &rig.bmp;
+        tasks.adxl = &rig.adxl;
+        tasks.bno = &rig.bno;
+        tasks.gps = &rig.gps;
+        if(burst) {
+            tasks.bnoBurst = &rig.bnoBurst;
+        }
+        if(fifo) {
+            tasks.lsmFifo = &rig.lsmFifo;
+            tasks.adxlFifo = &rig.adxlFifo;
+        }
+        tasks.sd = rig.sd;
+        tasks.sdBinary = rig.sdBinary;
+        tasks.serial = rig.serial;
+        tasks.logger = rig.logger;
+        tasks.attach(sched);
+    }
+
+    typedef std::chrono::steady_clock clock;
+    STATES state = rig.flight.getState();
+    uint64_t worst_ns = 0, total_ns = 0;
+    double est_sq = 0, est_worst = 0, vel_worst = 0;
+    size_t est_n = 0;
+    double prev_true_alt = NAN;
+    uint64_t pad_csv_bytes = 0, pad_bin_bytes = 0;  // log size before liftoff
+
+    for(size_t i = 0; i < trace.size(); i++) {
+        const TraceSample &s = trace[i];
+        rig.apply(s);
+        clock::time_point t0 = clock::now();
+        if(scheduled) {
+            rig.stepScheduled(sched, i + 1 < trace.size() ? trace[i + 1].time_us : s.time_us + 1);
+        } else {
+            rig.step();
+        }
+        if(link) {
+            rig.flight.writeDataToTeensy(linkTx);
+            check.wire_bytes += linkTx.tx.size();
+            check.sent++;
+            if(chance(linkRng) >= link_loss) {
+                linkRx.feed(linkTx.tx.data(), linkTx.tx.size());
+            }
+            linkTx.tx.clear();
+            ground.flight.readDataFromTeensy(linkRx);
+            while(ground.flight.nextLinkRecord()) {
+                check.compare(rig.data, ground.data);
+            }
+            if(chance(linkRng) >= link_loss) {
+                linkTx.feed(linkRx.tx.data(), linkRx.tx.size());
+            }
+            linkRx.tx.clear();
+        }
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+        total_ns += ns;
+        if(ns > worst_ns) {
+            worst_ns = ns;
+        }
+
+        // estimator against the synthetic truth, once the pad offset is set
+        if(!isnan(s.true_alt) && rig.flight.getState() != STATES::PRE_NO_CAL) {
+            double err = rig.data.est_alt - s.true_alt;
+            est_sq += err * err;
+            est_n++;
+            if(fabs(err) > est_worst) {
+                est_worst = fabs(err);
+            }
+            if(!isnan(prev_true_alt) && i > 0) {
+                double true_vel = (s.true_alt - prev_true_alt) / ((s.time_us - trace[i - 1].time_us) / 1e6);
+                if(fabs(rig.data.est_vel - true_vel) > vel_worst) {
+                    vel_worst = fabs(rig.data.est_vel - true_vel);
+                }
+            }
+        }
+        prev_true_alt = s.true_alt;
+        if(rig.flight.getState() < STATES::FLIGHT_ASCENT) {
+            pad_csv_bytes = csvFile.bytes;
+            pad_bin_bytes = binFile.bytes + (binPath ? logger.pending() * PHX_LOG_BLOCK_SIZE : 0);
+        }
+
+        if(rig.flight.getState() != state) {
+            state = rig.flight.getState();
+            if(!quiet) {
+                printf("%10.3f s  -> %s  (baro %.1f m)\n", s.time_us / 1e6, STATE_NAMES[state], rig.data.bmp_alt);
+            }
+        }
+    }
+
+    if(binPath) {
+        logger.close();
+        binFile.close();
+    }
+    if(csvPath) {
+        csvFile.close();
+    }
+
+    double flight_s = (trace.back().time_us - trace.front().time_us) / 1e6;
+    printf("samples      %zu over %.1f s of flight\n", trace.size(), flight_s);
+    printf("final state  %s\n", STATE_NAMES[state]);
+    if(truth.apogee_ms >= 0) {
+        printf("truth        liftoff %.3f s, apogee %.3f s, landed %.3f s\n",
+               truth.liftoff_ms / 1e3, truth.apogee_ms / 1e3, truth.landed_ms / 1e3);
+    }
+    printf("loop cost    mean %.0f ns, worst %llu ns, %.0fx faster than real time\n",
+           (double)total_ns / trace.size(), (unsigned long long)worst_ns, flight_s / (total_ns / 1e9));
+    if(est_n) {
+        printf("estimator    alt rms %.2f m, worst %.2f m; worst velocity error %.2f m/s\n",
+               sqrt(est_sq / est_n), est_worst, vel_worst);
+    }
+    printf("bus reads    lsm %u, bmp %u, adxl %u, bno %u\n",
+           fifo ? rig.lsmRegs.sim.reads : rig.lsm.sim.reads, rig.bmp.sim.reads,
+           fifo ? rig.adxlRegs.sim.reads : rig.adxl.sim.reads, burst ? rig.bnoRegs.sim.reads : rig.bno.sim.reads);
+    {
+        double txns = burst ? rig.bnoRegs.sim.reads : rig.bno.sim.reads;
+        double bytes = burst ? rig.bnoRegs.sim.bytes : rig.bno.sim.bytes;
+        // register read at 400 kHz: address, register, address again, 9 bits a byte, start/stop
+        double bus_s = (txns * (3 * 9 + 2) + bytes * 9) / 400e3;
+        printf("bno bus      %.0f transactions/s, %.0f bytes/s, %.1f%% of a 400 kHz bus\n",
+               txns / flight_s, bytes / flight_s, 100 * bus_s / flight_s);
+    }
+    if(!faults.empty()) {
+        const HealthMonitor &hm = rig.flight.sensorHealth();
+        for(int i = 0; i < SENSOR_COUNT; i++) {
+            const SensorHealth &h = hm[i];
+            printf("health %-5s %-8s %u reads, %u errors, %u slow, %u skipped, %u retries; latency mean %.0f us, peak %u us\n",
+                   SENSOR_NAMES[i], HEALTH_NAMES[h.state], h.reads, h.errors, h.slow, h.skipped, h.retries,
+                   h.mean_us, h.max_us);
+        }
+    }
+    if(fifo) {
+        const FlightSamples &fs = rig.flight.samples();
+        const SampleBatch *b[2] = { &fs.lsm, &fs.adxl };
+        uint32_t produced[2] = { rig.lsmRegs.sim.produced, rig.adxlRegs.sim.produced };
+        const char *name[2] = { "lsm", "adxl" };
+        for(int i = 0; i < 2; i++) {
+            uint32_t drained = b[i]->first_seq + b[i]->count;
+            printf("fifo %-7s %u of %u samples drained in %u transactions, %u overruns, %u dropped\n",
+                   name[i], drained, produced[i], b[i]->bursts, b[i]->overruns, b[i]->dropped);
+        }
+    }
+    if(csvPath) {
+        printf("writeSD      %llu bytes, %u flushes\n", (unsigned long long)csvFile.bytes, csvFile.flushes);
+    }
+    if(binPath) {
+        const SectorLoggerStats &st = logger.stats();
+        printf("logger       %llu bytes, %u sectors, %u flushes, high water %u/%u, %u overruns\n",
+               (unsigned long long)binFile.bytes, st.blocks_written, st.flushes, st.high_water,
+               PHX_LOG_BLOCK_COUNT, st.overruns);
+    }
+    if(csvPath || binPath) {
+        printf("pad log      %llu CSV bytes, %llu binary bytes before liftoff\n",
+               (unsigned long long)pad_csv_bytes, (unsigned long long)pad_bin_bytes);
+    }
+    if(pretrigger) {
+        const PretriggerCursor &c = rig.flight.pretriggerCsv(), &b = rig.flight.pretriggerBinary();
+        printf("pretrigger   %u rows held, heartbeat %u ms; csv %u rows logged, %u lost; binary %u rows logged, %u lost\n",
+               PHX_PRETRIGGER_ROWS, heartbeat_ms, c.written, c.lost, b.written, b.lost);
+    }
+    if(serial) {
+        printf("writeSERIAL  %llu bytes\n", (unsigned long long)serialSink.bytes);
+    }
+    if(link) {
+        const TelemetryTxStats &tx = rig.flight.telemetryTx().stats();
+        const TelemetryRxStats &rx = ground.flight.telemetryRx().stats();
+        double frame = (double)check.wire_bytes / check.sent;
+        double full = sizeof(FlightRecord) + PHX_SIL_LINK_FRAMING;
+        printf("link         %.1f bytes/frame on the wire (%u keyframes), full record %.0f: %.1fx frames/s;"
+               " %.0f frames/s at 115200 baud\n", frame, tx.keyframes, full, full / frame, 11520 / frame);
+        printf("link rx      %u applied, %u lost, %u dropped awaiting keyframe, %u malformed, %u out of tolerance\n",
+               rx.frames, rx.lost, rx.dropped, rx.malformed, check.mismatches);
+        const LinkTxStats &lt = rig.flight.linkTx();
+        printf("link acks    %u received, %u early keyframes, %u in flight, stride %u, %u thinned, %u blocked\n",
+               lt.acks, lt.resyncs, lt.in_flight, lt.stride, lt.thinned, lt.blocked);
+    }
+    if(scheduled) {
+        StdoutPrint out;
+        sched.report(out);
+    }
+    if(profile_report) {
+        StdoutPrint out;
+        PHX_PROFILER.report(out);
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_spsc: the data-ready queue between two real threads. A producer
+// thread stands in for the ISRs, a consumer loop with periodic stalls
+// stands in for loop() blocked on the SD card. Every sample carries a
+// sequence number, so the consumer checks that what it receives is in
+// order and that every gap is accounted for by the overflow counter.
+//
+// First a bare SpscQueue at several capacities, then DrdyAcquisition
+// feeding FLIGHT::read_IMU at PHX_ISR_QUEUE_LEN. Last, on one thread,
+// interrupts that arrive while the loop holds the bus (DrdyBusGuard)
+// must not touch it and must be read, with their stamps, at the release.
+//
+//   usage: phx_spsc [--rate hz] [--seconds s] [--loop us] [--stall ms] [--every loops]
+
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "Arduino.h"
+#include "SRAD_PHX.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+struct Options {
+    double rate = 1633;                     // samples/s, LSM 833 Hz + ADXL 800 Hz
+    double seconds = 3;
+    uint32_t loop_us = 1000;                // consumer period between stalls
+    uint32_t stall_ms = 100;
+    uint32_t every = 250;                   // loops between stalls
+};
+
+struct Result {
+    uint64_t received = 0, missing = 0, disorder = 0;
+    uint32_t overflows = 0, high_water = 0;
+    uint32_t max_latency_us = 0;
+};
+
+static uint64_t elapsedMicros(clock_type::time_point t0) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t0).count();
+}
+
+// Runs `produce(i)` at opts.rate on its own thread while `consume()` runs
+// the loop/stall pattern on this one, then drains until `consume` reports
+// nothing left.
+template <class Produce, class Consume>
+static void run(const Options &opts, Produce produce, Consume consume) {
+    std::atomic<bool> done(false);
+    clock_type::time_point t0 = clock_type::now();
+    uint64_t total = (uint64_t)(opts.rate * opts.seconds);
+
+    std::thread producer([&]() {
+        for(uint64_t i = 0; i < total; i++) {
+            std::this_thread::sleep_until(t0 + std::chrono::duration<double>(i / opts.rate));
+            sim::setMicros(elapsedMicros(t0));
+            produce(i);
+        }
+        done = true;
+    });
+
+    for(uint32_t loops = 1; ; loops++) {
+        sim::setMicros(elapsedMicros(t0));
+        bool more = consume();
+        if(done && !more) {
+            break;
+        }
+        uint32_t wait = loops % opts.every ? opts.loop_us : opts.stall_ms * 1000;
+        std::this_thread::sleep_for(std::chrono::microseconds(wait));
+    }
+    producer.join();
+    sim::setMicros(elapsedMicros(t0));
+    consume();
+}
+
+// Checks one received sequence number against the next one expected.
+static void account(Result &r, uint64_t &expect, uint64_t seq) {
+    if(seq < expect) {
+        r.disorder++;
+        return;
+    }
+    r.missing += seq - expect;
+    r.received++;
+    expect = seq + 1;
+}
+
+template <uint32_t N>
+static Result bareQueue(const Options &opts) {
+    struct Item { uint64_t seq; uint32_t time_us; };
+    SpscQueue<Item, N> q;
+    Result r;
+    uint64_t expect = 0;
+
+    run(opts,
+        [&](uint64_t i) { q.push(Item{ i, micros() }); },
+        [&]() {
+            Item buf[64];
+            uint32_t n = q.pop(buf, 64);
+            for(uint32_t k = 0; k < n; k++) {
+                account(r, expect, buf[k].seq);
+                uint32_t lat = micros() - buf[k].time_us;
+                if(lat > r.max_latency_us) r.max_latency_us = lat;
+            }
+            return n != 0;
+        });
+    r.missing += (uint64_t)(opts.rate * opts.seconds) - expect;
+    r.overflows = q.overflows();
+    r.high_water = q.highWater();
+    return r;
+}
+
+// Register stand-in whose data registers count samples: the sequence
+// number sits in the first two axes, low half first.
+class SeqBus : public RegisterBus {
+    public:
+        SeqBus(uint8_t id_reg, uint8_t id_value, uint8_t data_reg, uint8_t data_offset)
+        : id_reg(id_reg), id_value(id_value), data_reg(data_reg), data_offset(data_offset) {}
+
+        bool readRegs(uint8_t reg, uint8_t *buf, size_t n) override {
+            memset(buf, 0, n);
+            if(reg == id_reg && n == 1) {
+                buf[0] = id_value;
+                return true;
+            }
+            if(reg != data_reg) {
+                return false;
+            }
+            uint8_t *p = buf + data_offset;
+            p[0] = (uint8_t)seq;
+            p[1] = (uint8_t)(seq >> 8);
+            p[2] = (uint8_t)(seq >> 16);
+            p[3] = (uint8_t)(seq >> 24);
+            seq++;
+            return true;
+        }
+        bool writeReg(uint8_t, uint8_t) override { return true; }
+
+        uint32_t reads() const { return seq; }   // data register reads so far
+
+    private:
+        uint8_t id_reg, id_value, data_reg, data_offset;
+        uint32_t seq = 0;
+};
+
+static uint32_t seqFrom(float lo, float hi, float per_lsb) {
+    uint16_t a = (uint16_t)(int16_t)lroundf(lo / per_lsb);
+    uint16_t b = (uint16_t)(int16_t)lroundf(hi / per_lsb);
+    return a | (uint32_t)b << 16;
+}
+
+static Result flightQueue(const Options &opts, Result &adxl) {
+    SeqBus lsm_bus(LSM6DSO32_WHO_AM_I, LSM6DSO32_WHO_AM_I_VALUE, LSM6DSO32_OUT_TEMP_L, 2);
+    SeqBus adxl_bus(ADXL375_DEVID, ADXL375_DEVID_VALUE, ADXL375_DATAX0, 0);
+    DrdyAcquisition imu(lsm_bus, adxl_bus);
+    Adafruit_GPS gps;
+    FlightData data;
+    FLIGHT flight(30, 100, 5000, 5, "", gps, data);
+    Result lsm;
+    uint64_t lsm_expect = 0, adxl_expect = 0;
+
+    if(!imu.begin(2, 3)) {
+        fprintf(stderr, "DrdyAcquisition::begin failed\n");
+        exit(1);
+    }
+    run(opts,
+        [&](uint64_t i) {
+            if(i & 1) imu.adxlReady();
+            else imu.lsmReady();
+        },
+        [&]() {
+            flight.read_IMU(imu);
+            const FlightSamples &s = flight.samples();
+            uint32_t now = micros();
+            for(uint16_t k = 0; k < s.lsm.count; k++) {
+                const ImuSample &x = s.lsm.sample[k];
+                account(lsm, lsm_expect, seqFrom(x.gyro[0], x.gyro[1], LSM6DSO32_GYRO_RADS_PER_LSB));
+                if(now - x.time_us > lsm.max_latency_us) lsm.max_latency_us = now - x.time_us;
+            }
+            for(uint16_t k = 0; k < s.adxl.count; k++) {
+                const ImuSample &x = s.adxl.sample[k];
+                account(adxl, adxl_expect, seqFrom(x.acc[0], x.acc[1], ADXL375_ACC_MS2_PER_LSB));
+                if(now - x.time_us > adxl.max_latency_us) adxl.max_latency_us = now - x.time_us;
+            }
+            return s.lsm.count || s.adxl.count || imu.queue.size();
+        });
+    imu.end();
+    lsm.overflows = imu.queue.overflows();
+    lsm.high_water = imu.queue.highWater();
+    return lsm;
+}
+
+/**
+ * @brief interrupts while the loop holds the bus are read at the release, not inside it
+ */
+static bool busHold() {
+    SeqBus lsm_bus(LSM6DSO32_WHO_AM_I, LSM6DSO32_WHO_AM_I_VALUE, LSM6DSO32_OUT_TEMP_L, 2);
+    SeqBus adxl_bus(ADXL375_DEVID, ADXL375_DEVID_VALUE, ADXL375_DATAX0, 0);
+    DrdyAcquisition imu(lsm_bus, adxl_bus);
+    if(!imu.begin(2, 3)) {
+        fprintf(stderr, "DrdyAcquisition::begin failed\n");
+        exit(1);
+    }
+    bool touched = false;
+    sim::setMicros(1000);
+    {
+        DrdyBusGuard outer;
+        DrdyBusGuard inner;                 // nested, as a read_* inside a sketch's own guard
+        imu.lsmReady();
+        sim::setMicros(1200);
+        imu.adxlReady();
+        sim::setMicros(1400);
+        imu.lsmReady();                     // replaces the first LSM sample
+        touched = lsm_bus.reads() || adxl_bus.reads() || imu.queue.size();
+    }
+    RawSample raw[4];
+    uint32_t n = imu.queue.pop(raw, 4);
+    imu.end();
+    bool ok = !touched && n == 2 && imu.held_drops == 1
+        && raw[0].source == RAW_LSM && raw[0].time_us == 1400
+        && raw[1].source == RAW_ADXL && raw[1].time_us == 1200;
+    printf("bus hold     %s\n", ok ? "deferred reads ok" : "MISMATCH");
+    return ok;
+}
+
+static bool report(const char *name, uint32_t capacity, const Result &r, uint64_t missing, uint32_t overflows) {
+    bool ok = r.disorder == 0 && missing == overflows;
+    printf("%-12s %5u  %8llu %7llu %9u %6u %8.1f  %s\n", name, capacity,
+           (unsigned long long)r.received, (unsigned long long)missing, overflows,
+           r.high_water, r.max_latency_us / 1000.0, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    Options opts;
+    for(int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has = i + 1 < argc;
+        if(!strcmp(a, "--rate") && has) opts.rate = atof(argv[++i]);
+        else if(!strcmp(a, "--seconds") && has) opts.seconds = atof(argv[++i]);
+        else if(!strcmp(a, "--loop") && has) opts.loop_us = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--stall") && has) opts.stall_ms = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(a, "--every") && has) opts.every = strtoul(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "usage: %s [--rate hz] [--seconds s] [--loop us] [--stall ms] [--every loops]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(opts.every < 1) opts.every = 1;
+
+    printf("%.0f samples/s for %.1f s, consumer every %u us, %u ms stall every %u loops\n",
+           opts.rate, opts.seconds, opts.loop_us, opts.stall_ms, opts.every);
+    printf("%-12s %5s  %8s %7s %9s %6s %8s\n", "queue", "len", "received", "missed", "overflows", "peak", "max ms");
+
+    bool ok = true;
+    Result r;
+    r = bareQueue<64>(opts);
+    ok &= report("bare", 64, r, r.missing, r.overflows);
+    r = bareQueue<256>(opts);
+    ok &= report("bare", 256, r, r.missing, r.overflows);
+    r = bareQueue<1024>(opts);
+    ok &= report("bare", 1024, r, r.missing, r.overflows);
+
+    // both sources share one queue and one overflow counter
+    Result adxl;
+    Result lsm = flightQueue(opts, adxl);
+    uint32_t produced = (uint32_t)(opts.rate * opts.seconds);
+    uint64_t missing = (produced - lsm.received - adxl.received);
+    Result both = lsm;
+    both.received += adxl.received;
+    both.disorder += adxl.disorder;
+    if(adxl.max_latency_us > both.max_latency_us) both.max_latency_us = adxl.max_latency_us;
+    ok &= report("read_IMU", RawSampleQueue::capacity(), both, missing, lsm.overflows);
+    ok &= busHold();
+
+    return ok ? 0 : 1;
+}
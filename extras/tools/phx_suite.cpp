@@ -0,0 +1,166 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_suite: what a vehicle with fewer sensors saves by calling less, on
+// the SIL flight.
+//
+// 1. FLIGHT with every sensor, CSV and binary logs, against the sketch
+//    reading only the LSM, BMP and ADXL into a binary log: both must
+//    reach every state. Without the BNO the attitude, and so the
+//    landing time, may differ by a few ticks.
+// 2. Loop time of each: reads, calculateState and writers, each the
+//    fastest of --runs interleaved runs.
+//
+// Code size is measured by `make suite` on phx_suite_size, built once per
+// variant with unused sections dropped. See "Vehicle-specific builds" in
+// the README for why there is no compile-time FLIGHT to compare against.
+//
+//   usage: phx_suite [options]
+//     --runs <n>            timed runs per variant (default 9)
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sil_rig.h"
+
+static const char *STATE_NAMES[] = { "PRE_NO_CAL", "PRE_CAL", "FLIGHT_ASCENT", "FLIGHT_DESCENT", "POST_LANDED" };
+
+// sensors the sketch reads, one bit per SENSOR_ID
+#define READ_ALL ((1 << SENSOR_COUNT) - 1)
+#define READ_IMU_BARO (1 << SENSOR_LSM | 1 << SENSOR_BMP | 1 << SENSOR_ADXL)
+
+// writers into discarding Files, so the time is the flight code's
+struct Logs {
+    File csv = SD.open(nullptr);
+    File file = SD.open(nullptr);
+    SectorLogger binary;
+    Logs() { binary.begin(file); }
+};
+
+enum { LOOP_READ, LOOP_STATE, LOOP_WRITE, LOOP_PARTS };
+
+struct Run {
+    double ns[LOOP_PARTS] = { 0, 0, 0 };        // per loop
+    uint64_t entered_us[5] = { 0, 0, 0, 0, 0 };
+};
+
+static void noteState(Run &r, uint8_t &state, uint8_t now, uint64_t t_us) {
+    if(now != state) {
+        state = now;
+        r.entered_us[now] = t_us;
+    }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t since(Clock::time_point &t) {
+    Clock::time_point now = Clock::now();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - t).count();
+    t = now;
+    return ns;
+}
+
+/**
+ * @brief the sketch's loop, calling read_* for `sensors` (READ_* bits)
+ */
+static Run flyFlight(const std::vector<TraceSample> &trace, uint8_t sensors, bool csv) {
+    Run r;
+    SilRig rig;
+    Logs logs;
+    sim::setMicros(trace.front().time_us);
+    uint8_t state = 0;
+    uint64_t ns[LOOP_PARTS] = { 0, 0, 0 };
+    for(const TraceSample &s : trace) {
+        rig.apply(s);
+        Clock::time_point t = Clock::now();
+        FLIGHT &f = rig.flight;
+        f.incrementTime();
+        if(sensors & 1 << SENSOR_LSM) f.read_LSM(rig.lsm);
+        if(sensors & 1 << SENSOR_BMP) f.read_BMP(rig.bmp);
+        if(sensors & 1 << SENSOR_ADXL) f.read_ADXL(rig.adxl);
+        if(sensors & 1 << SENSOR_BNO) f.read_BNO(rig.bno);
+        if(sensors & 1 << SENSOR_GPS) f.read_GPS(rig.gps);
+        ns[LOOP_READ] += since(t);
+        f.calculateState();
+        ns[LOOP_STATE] += since(t);
+        if(csv) f.writeSD(false, logs.csv);
+        f.writeSDBinary(false, logs.binary);
+        logs.binary.service();
+        ns[LOOP_WRITE] += since(t);
+        noteState(r, state, f.getState(), s.time_us);
+    }
+    for(int k = 0; k < LOOP_PARTS; k++) {
+        r.ns[k] = (double)ns[k] / trace.size();
+    }
+    return r;
+}
+
+static bool allStates(const Run &full, const Run &trimmed) {
+    bool ok = true;
+    printf("%-20s %14s %14s\n", "entered at s", "all, CSV+bin", "LSM/BMP/ADXL");
+    for(int s = 1; s < 5; s++) {
+        printf("  %-18s %14.3f %14.3f\n", STATE_NAMES[s], full.entered_us[s] / 1e6, trimmed.entered_us[s] / 1e6);
+        ok &= full.entered_us[s] != 0 && trimmed.entered_us[s] != 0;
+    }
+    return ok;
+}
+
+static void report(const Run &full, const Run &trimmed) {
+    static const char *PART_NAMES[] = { "reads", "calculateState", "writers" };
+    double total_f = 0, total_t = 0;
+    printf("%-20s %14s %14s\n", "ns/loop", "all, CSV+bin", "LSM/BMP/ADXL");
+    for(int k = 0; k < LOOP_PARTS; k++) {
+        printf("  %-18s %14.0f %14.0f (%+.1f%%)\n", PART_NAMES[k],
+               full.ns[k], trimmed.ns[k], 100.0 * (trimmed.ns[k] / full.ns[k] - 1));
+        total_f += full.ns[k];
+        total_t += trimmed.ns[k];
+    }
+    printf("  %-18s %14.0f %14.0f (%+.1f%%)\n", "loop", total_f, total_t, 100.0 * (total_t / total_f - 1));
+}
+
+// fastest of the runs, stage by stage
+static void keepBest(Run &best, const Run &r) {
+    for(int k = 0; k < LOOP_PARTS; k++) {
+        if(best.ns[k] == 0 || r.ns[k] < best.ns[k]) {
+            best.ns[k] = r.ns[k];
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int runs = 9;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "--runs") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: phx_suite [--runs n]\n");
+            return 2;
+        }
+    }
+
+    FlightProfile profile;
+    std::vector<TraceSample> trace = makeSyntheticFlight(profile, nullptr);
+
+    Run full = flyFlight(trace, READ_ALL, true);
+    Run trimmed = flyFlight(trace, READ_IMU_BARO, false);
+    bool ok = allStates(full, trimmed);
+
+    Run best[2];
+    for(int i = 0; i < runs; i++) {
+        keepBest(best[0], flyFlight(trace, READ_ALL, true));
+        keepBest(best[1], flyFlight(trace, READ_IMU_BARO, false));
+    }
+    report(best[0], best[1]);
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
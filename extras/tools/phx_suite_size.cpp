@@ -0,0 +1,76 @@
+/* SRAD Avionics Flight Software for AIAA-UH
+ *
+ * Copyright (c) 2025 Nathan Samuell + Dedah + Thanh! (www.github.com/nathansamuell, www.github.com/UH-AIAA)
+ *
+ * More information on the MIT license as well as a complete copy
+ * of the license can be found here: https://choosealicense.com/licenses/mit/
+ *
+ * All above text must be included in any redistribution.
+ */
+
+// phx_suite_size: the smallest sketch around each loop phx_suite times,
+// built once per PHX_SUITE_VARIANT so `size` shows what each one links.
+//
+//   0  every sensor, CSV and binary logs (today's build)
+//   1  the sketch reading only the LSM, BMP and ADXL, binary log
+//
+//   usage: phx_suite_size_<variant> [ticks]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SRAD_PHX.h"
+
+#ifndef PHX_SUITE_VARIANT
+#define PHX_SUITE_VARIANT 0
+#endif
+
+#define SUITE_THRESHOLDS 30, 100, 5000, 10
+
+struct Sensors {
+    Adafruit_LSM6DSO32 lsm;
+    Adafruit_BMP3XX bmp;
+    Adafruit_ADXL375 adxl;
+    Adafruit_BNO055 bno;
+    MockSerial gpsPort;
+    Adafruit_GPS gps = Adafruit_GPS(&gpsPort);
+};
+
+struct Sinks {
+    File csv = SD.open(nullptr);
+    File file = SD.open(nullptr);
+    SectorLogger binary;
+};
+
+int main(int argc, char **argv) {
+    const long ticks = argc > 1 ? atol(argv[1]) : 1000;
+    Sensors s;
+    Sinks k;
+    k.binary.begin(k.file);
+    s.lsm.sim.acc[2] = 9.81f;
+    s.adxl.sim.acc[2] = 9.81f;
+    s.bno.sim.acc[2] = 9.81f;
+    FlightData data = FlightData();
+
+    FLIGHT flight(SUITE_THRESHOLDS, "", s.gps, data);
+    for(long i = 0; i < ticks; i++) {
+        sim::advanceMicros(10000);
+        flight.incrementTime();
+        flight.read_LSM(s.lsm);
+        flight.read_BMP(s.bmp);
+        flight.read_ADXL(s.adxl);
+#if PHX_SUITE_VARIANT == 0
+        flight.read_BNO(s.bno);
+        flight.read_GPS(s.gps);
+#endif
+        flight.calculateState();
+#if PHX_SUITE_VARIANT == 0
+        flight.writeSD(false, k.csv);
+#endif
+        flight.writeSDBinary(false, k.binary);
+        k.binary.service();
+    }
+
+    printf("state %d after %ld ticks\n", flight.getState(), ticks);
+    return 0;
+}